@@ -19,6 +19,20 @@
 #include "MUZ-Common/FileUtils.h"
 #include "MUZ-Assembler/Assembler.h"
 #include <chrono>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <signal.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#endif
 
 using std::string;
 
@@ -31,28 +45,526 @@ void nextParam(int & arg, int argc, const char* argv[])
 	arg += 1;
 }
 
-int main(int argc, const char * argv[]) {
+/** Output settings from the command line, applied to each assembler. */
+struct Settings {
+	string outputdir;
+	string listing;
+	string memory;
+	string hex;
+	string binary;
+	string debug;
+	string log;
+	string cache;
+	int fill = -1;
+	bool sections = false;
+	bool twopass = false;
+};
 
-	MUZ::Assembler as;
+/** A configuration for --matrix: a name for its output directory and the #DEFINE symbols set before assembling. */
+struct Configuration {
+	string name;
+	std::vector<std::pair<string,string>> symbols;
+};
+
+/** Applies the output settings to an assembler, with the given output directory. */
+void configure(MUZ::Assembler& as, const Settings& settings, const string& outputdir)
+{
+	if (!outputdir.empty()) as.SetOutputDirectory(outputdir);
+	if (!settings.listing.empty()) as.SetListingFilename(settings.listing);
+	if (!settings.memory.empty()) as.SetMemoryFilename(settings.memory);
+	if (!settings.hex.empty()) as.SetIntelHexFilename(settings.hex);
+	if (!settings.binary.empty()) as.SetBinaryFilename(settings.binary);
+	if (settings.fill >= 0) as.SetBinaryFill((MUZ::DATATYPE)settings.fill);
+	if (settings.sections) as.EnableBinarySections(true);
+	if (!settings.debug.empty()) as.SetDebugInfoFilename(settings.debug);
+	if (!settings.log.empty()) as.SetLogFilename(settings.log);
+	if (!settings.cache.empty()) as.SetCacheDirectory(settings.cache);
+	if (settings.twopass) as.EnableFixups(false);
+}
+
+/** Reads the configurations file: one configuration per line, with its name followed by SYMBOL or SYMBOL=value
+ definitions separated by spaces. Empty lines and lines starting with ';' or '#' are ignored. */
+bool readConfigurations(const string& file, std::vector<Configuration>& configurations)
+{
+	std::ifstream in(file);
+	if (!in) return false;
+	string line;
+	while (std::getline(in, line)) {
+		std::istringstream words(line);
+		Configuration configuration;
+		if (!(words >> configuration.name)) continue;
+		if (configuration.name[0] == ';' || configuration.name[0] == '#') continue;
+		string definition;
+		while (words >> definition) {
+			size_t equal = definition.find('=');
+			if (equal == string::npos) {
+				configuration.symbols.emplace_back(definition, "");
+			} else {
+				configuration.symbols.emplace_back(definition.substr(0, equal), definition.substr(equal + 1));
+			}
+		}
+		configurations.push_back(configuration);
+	}
+	return true;
+}
+
+/** Assembles the input file once for each configuration, in parallel threads sharing the split source lines.
+ Each configuration writes its files in a sub-directory of the output directory named after the configuration. */
+void assembleMatrix(const string& inputFile, const Settings& settings, const std::vector<Configuration>& configurations, unsigned jobs)
+{
+	string root = settings.outputdir.empty() ? string(".") : settings.outputdir;
+	if (!ExistDir(root)) _mkdir(root.c_str());
+	MUZ::LexCache cache;
+	cache.SetDirectory(settings.cache);
+	cache.EnableMemory(true);
+
+	std::atomic<size_t> next(0);
+	auto worker = [&]() {
+		size_t index;
+		while ((index = next++) < configurations.size()) {
+			const Configuration& configuration = configurations[index];
+			MUZ::Assembler as;
+			MUZ::ErrorList msg;
+			configure(as, settings, root + NORMAL_DIR_SEPARATOR + configuration.name);
+			as.ShareCache(cache);
+			for (auto & symbol : configuration.symbols) {
+				as.CreateDefSymbol(symbol.first, symbol.second);
+			}
+			try {
+				as.AssembleFile(inputFile, msg);
+			} catch (std::exception &e) {
+				perror(e.what());
+			}
+		}
+	};
+	if (jobs == 0) jobs = std::thread::hardware_concurrency();
+	if (jobs == 0) jobs = 1;
+	if (jobs > configurations.size()) jobs = (unsigned)configurations.size();
+	std::vector<std::thread> threads;
+	for (unsigned i = 1 ; i < jobs ; i++) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto & thread : threads) {
+		thread.join();
+	}
+}
+
+/** A build request for --serve: the main file, its settings and the #DEFINE symbols set before assembling. */
+struct Request {
+	string inputFile;
+	Settings settings;
+	std::vector<std::pair<string,string>> symbols;
+	bool quit = false;
+};
+
+/** Reads a request from its text: one "keyword value" per line, up to an empty line. The keywords are file, outputdir,
+ listing, memory, hex, binary, fill, sections, debug, log, define (SYMBOL or SYMBOL=value), twopass and quit. The settings not
+ given in the request are the command line settings. */
+void readRequest(const string& text, Request& request)
+{
+	std::istringstream lines(text);
+	string line;
+	while (std::getline(lines, line)) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty()) break;
+		size_t space = line.find(' ');
+		string keyword = line.substr(0, space);
+		string value = (space == string::npos) ? string() : line.substr(space + 1);
+		if (keyword == "file") request.inputFile = value;
+		else if (keyword == "outputdir") request.settings.outputdir = value;
+		else if (keyword == "listing") request.settings.listing = value;
+		else if (keyword == "memory") request.settings.memory = value;
+		else if (keyword == "hex") request.settings.hex = value;
+		else if (keyword == "binary") request.settings.binary = value;
+		else if (keyword == "fill") request.settings.fill = (int)strtol(value.c_str(), nullptr, 0);
+		else if (keyword == "sections") request.settings.sections = true;
+		else if (keyword == "debug") request.settings.debug = value;
+		else if (keyword == "log") request.settings.log = value;
+		else if (keyword == "twopass") request.settings.twopass = true;
+		else if (keyword == "quit") request.quit = true;
+		else if (keyword == "define") {
+			size_t equal = value.find('=');
+			if (equal == string::npos) {
+				request.symbols.emplace_back(value, "");
+			} else {
+				request.symbols.emplace_back(value.substr(0, equal), value.substr(equal + 1));
+			}
+		}
+	}
+}
+
+/** Assembles a request with the resident assembler, and returns the reply: one line for each warning or error,
+ one line for each output file written, and a last line with the result, the numbers of errors and warnings and
+ the assembling time. */
+string assembleRequest(MUZ::Assembler& as, const Request& request)
+{
+	std::chrono::high_resolution_clock Clock;
+	auto startTime = Clock.now();
+	string reply;
+	if (!ExistFile(request.inputFile)) {
+		return "fatal missing file " + request.inputFile + "\ndone FATAL 1 0 0\n";
+	}
+
+	// every setting is given again because the assembler keeps them from the previous request
+	const Settings& settings = request.settings;
+	as.Reset();
+	as.SetOutputDirectory(settings.outputdir);
+	as.SetListingFilename(settings.listing);
+	as.SetMemoryFilename(settings.memory);
+	as.SetIntelHexFilename(settings.hex);
+	as.SetBinaryFilename(settings.binary);
+	as.SetBinaryFill((MUZ::DATATYPE)(settings.fill >= 0 ? settings.fill : 0xFF));
+	as.EnableBinarySections(settings.sections);
+	as.SetDebugInfoFilename(settings.debug);
+	as.SetLogFilename(settings.log);
+	as.EnableFixups(!settings.twopass);
+	for (auto & symbol : request.symbols) {
+		as.CreateDefSymbol(symbol.first, symbol.second);
+	}
 	MUZ::ErrorList msg;
+	MUZ::ErrorType result = MUZ::errorTypeFATAL;
+	try {
+		result = as.AssembleFile(request.inputFile, msg);
+	} catch (std::exception &e) {
+		perror(e.what());
+	}
+
+	// diagnostics, as file(line): code: 'token': message
+	int nbErrors = 0;
+	int nbWarnings = 0;
+	for (MUZ::ErrorMessage& m : msg) {
+		const char* kind;
+		char letter;
+		if (m.type == MUZ::errorTypeWARNING) {
+			kind = "warning"; letter = 'W'; nbWarnings++;
+		} else if (m.type == MUZ::errorTypeERROR) {
+			kind = "error"; letter = 'E'; nbErrors++;
+		} else if (m.type == MUZ::errorTypeFATAL) {
+			kind = "fatal"; letter = 'E'; nbErrors++;
+		} else {
+			continue;
+		}
+		char code[8];
+		snprintf(code, sizeof(code), "%c%04d", letter, (int)m.kind);
+		string token;
+		MUZ::CodeLine* codeline = as.GetCodeLine(m.file, m.line);
+		if (codeline && m.token < codeline->tokens.size()) {
+			token = "'" + codeline->tokens[m.token].asString() + "': ";
+		}
+		reply += string(kind) + " " + as.GetFileName(m.file) + "(" + std::to_string(m.line) + "): " + code + ": " + token + msg.GetMessage(m.kind) + "\n";
+	}
+
+	// output files
+	for (const string* name : { &settings.listing, &settings.memory, &settings.hex, &settings.debug, &settings.log }) {
+		string path = settings.outputdir + NORMAL_DIR_SEPARATOR + *name;
+		if (!name->empty() && ExistFile(path)) reply += "output " + path + "\n";
+	}
+	for (auto & name : as.GetBinaryFiles()) {
+		reply += "output " + settings.outputdir + NORMAL_DIR_SEPARATOR + name + "\n";
+	}
+	const char* status = (result == MUZ::errorTypeFATAL) ? "FATAL" : (nbErrors ? "ERROR" : "OK");
+	double elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(Clock.now() - startTime).count() / 1000000.0;
+	char done[96];
+	snprintf(done, sizeof(done), "done %s %d %d %lf\n", status, nbErrors, nbWarnings, elapsedTime);
+	return reply + done;
+}
+
+/** Seconds a client has to send its request or read the reply before the server closes the connection. */
+#define SERVETIMEOUT 5
+
+/** Serves build requests on a local socket until a request says quit. A client connects, writes a request and
+ reads the reply until the server closes the connection. The assembler and the split source lines stay in memory
+ between the requests, so an unchanged file is neither split again nor read from the cache directory. A request
+ without an output directory writes into the directory of the command line, or the current one. */
+bool serve(const string& socketPath, const Settings& settings)
+{
+#ifdef _WIN32
+	return false;
+#else
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (socketPath.size() >= sizeof(address.sun_path)) return false;
+	strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0) return false;
+	unlink(socketPath.c_str());
+	if (bind(server, (sockaddr*)&address, sizeof(address)) != 0 || listen(server, 8) != 0) {
+		close(server);
+		return false;
+	}
+	// a client leaving before the reply must not stop the server
+	signal(SIGPIPE, SIG_IGN);
+
+	// default settings of the requests
+	Settings defaults = settings;
+	if (defaults.outputdir.empty()) defaults.outputdir = ".";
+	MUZ::LexCache cache;
+	cache.SetDirectory(settings.cache);
+	cache.EnableMemory(true);
+	MUZ::Assembler as;
+	as.ShareCache(cache);
+	printf("Serving on %s\n", socketPath.c_str());
+	fflush(stdout);
+
+	bool quit = false;
+	while (!quit) {
+		int client = accept(server, nullptr, nullptr);
+		if (client < 0) continue;
+		// a client which neither ends its request nor reads the reply must not block the other ones
+		timeval timeout = { SERVETIMEOUT, 0 };
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+		setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+		// the request ends with an empty line, or when the client stops writing
+		string text;
+		char buffer[4096];
+		ssize_t read = 1;
+		while (text.find("\n\n") == string::npos && text.find("\r\n\r\n") == string::npos
+			   && (read = recv(client, buffer, sizeof(buffer), 0)) > 0) {
+			text.append(buffer, (size_t)read);
+		}
+		Request request;
+		request.settings = defaults;
+		readRequest(text, request);
+		string reply;
+		if (read < 0) {
+			reply = "fatal incomplete request\ndone FATAL 1 0 0\n";
+		} else {
+			quit = request.quit;
+			reply = request.inputFile.empty() ? string("done OK 0 0 0\n") : assembleRequest(as, request);
+		}
+		// forget the split lines of files which have not been used for a long time
+		cache.TrimMemory(256);
+		size_t sent = 0;
+		ssize_t written;
+		while (sent < reply.size() && (written = send(client, reply.data() + sent, reply.size() - sent, 0)) > 0) {
+			sent += (size_t)written;
+		}
+		close(client);
+	}
+	close(server);
+	unlink(socketPath.c_str());
+	return true;
+#endif
+}
+
+/** Waits for changes in the source files of an assembly. On Linux the directories of the files are watched with
+ inotify, because editors often save a file by renaming a new one over it. Elsewhere the modification times of the
+ files are polled. A change is reported once no other change has been seen for the debounce delay, so that
+ successive saves give a single assembly. */
+class FileWatcher {
+	std::map<string, long long> m_files;	// watched files with their modification time
+#ifdef __linux__
+	int m_inotify = -1;
+	std::map<int, string> m_directories;	// watched directories by watch descriptor
+
+	/** Reads the pending events, tells if one is about a watched file. Waits at most timeout milliseconds. */
+	bool ReadEvents(int timeout) {
+		pollfd pfd = { m_inotify, POLLIN, 0 };
+		if (poll(&pfd, 1, timeout) <= 0) return false;
+		char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+		ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+		bool changed = false;
+		for (char* p = buffer ; p < buffer + length ; ) {
+			inotify_event* event = (inotify_event*)p;
+			if (event->len && m_files.count(m_directories[event->wd] + "/" + event->name)) changed = true;
+			p += sizeof(inotify_event) + event->len;
+		}
+		return changed;
+	}
+#else
+	/** Tells if a watched file has changed since the last call, and records its new time. */
+	bool Poll() {
+		bool changed = false;
+		for (auto & file : m_files) {
+			long long time = FileTime(file.first);
+			if (time != file.second) {
+				file.second = time;
+				changed = true;
+			}
+		}
+		return changed;
+	}
+#endif
+
+public:
+	~FileWatcher() {
+#ifdef __linux__
+		if (m_inotify >= 0) close(m_inotify);
+#endif
+	}
+
+	/** Adds files to watch, the files already watched keep their state so that a change made while assembling
+	 is not missed. */
+	void Watch(const std::vector<string>& files) {
+#ifdef __linux__
+		if (m_inotify < 0) m_inotify = inotify_init();
+#endif
+		for (auto & file : files) {
+			if (m_files.count(file)) continue;
+			m_files[file] = FileTime(file);
+#ifdef __linux__
+			string directory = file.substr(0, file.rfind('/'));
+			int wd = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+			if (wd >= 0) m_directories[wd] = directory;
+#endif
+		}
+	}
+
+	/** Waits until a watched file changes and no other change happens during debounce milliseconds. */
+	void Wait(unsigned debounce) {
+#ifdef __linux__
+		while (!ReadEvents(-1)) {}
+		while (ReadEvents((int)debounce)) {}
+#else
+		while (!Poll()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(debounce));
+		}
+		do {
+			std::this_thread::sleep_for(std::chrono::milliseconds(debounce));
+		} while (Poll());
+#endif
+	}
+};
+
+/** Reads a whole file, tells if it could be read. */
+bool readFile(const string& file, string& content)
+{
+	std::ifstream in(file, std::ios::binary);
+	if (!in) return false;
+	std::ostringstream text;
+	text << in.rdbuf();
+	content = text.str();
+	return true;
+}
+
+/** Copies the output files written in the staging directory to the output directory when their content has
+ changed, so that the tools using the outputs only see the files which really changed. The binary files are the
+ ones written by the assembly. Returns the names of the copied files. */
+std::vector<string> publishOutputs(const string& staging, const string& outputdir, const Settings& settings, const std::vector<string>& binaries)
+{
+	std::vector<string> changed;
+	std::vector<const string*> names = { &settings.listing, &settings.memory, &settings.hex, &settings.debug, &settings.log };
+	for (auto & binary : binaries) names.push_back(&binary);
+	for (const string* name : names) {
+		string written, previous;
+		if (name->empty() || !readFile(staging + NORMAL_DIR_SEPARATOR + *name, written)) continue;
+		string path = outputdir + NORMAL_DIR_SEPARATOR + *name;
+		if (readFile(path, previous) && previous == written) continue;
+		std::ofstream out(path, std::ios::binary);
+		out << written;
+		changed.push_back(*name);
+	}
+	return changed;
+}
+
+/** Assembles the input file each time one of its source, HEX or binary files changes, until interrupted. The
+ assembler and the split lines of the unchanged files stay in memory between the assemblies. */
+void watch(const string& inputFile, const Settings& settings, unsigned debounce)
+{
+	string outputdir = settings.outputdir.empty() ? string(".") : settings.outputdir;
+	if (!ExistDir(outputdir)) _mkdir(outputdir.c_str());
+	string staging = outputdir + NORMAL_DIR_SEPARATOR + ".asmuz-watch";
+	MUZ::LexCache cache;
+	cache.SetDirectory(settings.cache);
+	cache.EnableMemory(true);
+	MUZ::Assembler as;
+	as.ShareCache(cache);
+	FileWatcher watcher;
+	std::chrono::high_resolution_clock Clock;
+	for (;;) {
+		auto startTime = Clock.now();
+		as.Reset();
+		configure(as, settings, staging);
+		MUZ::ErrorList msg;
+		try {
+			as.AssembleFile(inputFile, msg);
+		} catch (std::exception &e) {
+			perror(e.what());
+		}
+		cache.TrimMemory(256);
+		int nbErrors = 0;
+		int nbWarnings = 0;
+		for (MUZ::ErrorMessage& m : msg) {
+			if (m.type == MUZ::errorTypeWARNING) nbWarnings++;
+			if (m.type == MUZ::errorTypeERROR || m.type == MUZ::errorTypeFATAL) nbErrors++;
+		}
+		string changed;
+		for (auto & name : publishOutputs(staging, outputdir, settings, as.GetBinaryFiles())) {
+			changed += " " + name;
+		}
+		double elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(Clock.now() - startTime).count() / 1000.0;
+		printf("Assembling took %lf seconds, %d errors, %d warnings, updated:%s\n", elapsedTime, nbErrors, nbWarnings, changed.empty() ? " nothing" : changed.c_str());
+		fflush(stdout);
+
+		// the included files can change from one assembly to the next, macro expansions are not files
+		std::vector<string> files;
+		for (size_t i = 0 ; i < as.GetFilesCount() ; i++) {
+			if (ExistFile(as.GetFileName(i))) files.push_back(as.GetFileName(i));
+		}
+		if (files.empty()) files.push_back(inputFile);
+		watcher.Watch(files);
+		watcher.Wait(debounce);
+	}
+}
+
+int main(int argc, const char * argv[]) {
+
+	Settings settings;
 	string inputFile;
+	string matrixFile;
+	string socketPath;
+	bool watching = false;
+	unsigned debounce = 100;
+	unsigned jobs = 0;
 	int arg = 1;
 	while (arg < argc) {
 		if ((strcmp(argv[arg], "--outputdir")==0) || (strcmp(argv[arg], "-od")==0)) {
 			nextParam(arg, argc, argv);
-			as.SetOutputDirectory(argv[arg]);
+			settings.outputdir = argv[arg];
 		} else if ((strcmp(argv[arg], "--listing")==0) || (strcmp(argv[arg], "-l")==0)) {
 			nextParam(arg, argc, argv);
-			as.SetListingFilename(argv[arg]);
+			settings.listing = argv[arg];
 		} else if ((strcmp(argv[arg], "--memory")==0) || (strcmp(argv[arg], "-m")==0)) {
 			nextParam(arg, argc, argv);
-			as.SetMemoryFilename(argv[arg]);
+			settings.memory = argv[arg];
 		} else if ((strcmp(argv[arg], "--hex")==0) || (strcmp(argv[arg], "-h")==0)) {
 			nextParam(arg, argc, argv);
-			as.SetIntelHexFilename(argv[arg]);
+			settings.hex = argv[arg];
+		} else if ((strcmp(argv[arg], "--binary")==0) || (strcmp(argv[arg], "-b")==0)) {
+			nextParam(arg, argc, argv);
+			settings.binary = argv[arg];
+		} else if ((strcmp(argv[arg], "--fill")==0)) {
+			nextParam(arg, argc, argv);
+			settings.fill = (int)strtol(argv[arg], nullptr, 0);
+		} else if ((strcmp(argv[arg], "--sections")==0)) {
+			settings.sections = true;
+		} else if ((strcmp(argv[arg], "--debug")==0)) {
+			nextParam(arg, argc, argv);
+			settings.debug = argv[arg];
 		} else if ((strcmp(argv[arg], "--log")==0)) {
 			nextParam(arg, argc, argv);
-			as.SetLogFilename(argv[arg]);
+			settings.log = argv[arg];
+		} else if ((strcmp(argv[arg], "--cache")==0)) {
+			nextParam(arg, argc, argv);
+			settings.cache = argv[arg];
+		} else if ((strcmp(argv[arg], "--twopass")==0)) {
+			settings.twopass = true;
+		} else if ((strcmp(argv[arg], "--matrix")==0)) {
+			nextParam(arg, argc, argv);
+			matrixFile = argv[arg];
+		} else if ((strcmp(argv[arg], "--jobs")==0)) {
+			nextParam(arg, argc, argv);
+			jobs = (unsigned)atoi(argv[arg]);
+		} else if ((strcmp(argv[arg], "--serve")==0)) {
+			nextParam(arg, argc, argv);
+			socketPath = argv[arg];
+		} else if ((strcmp(argv[arg], "--watch")==0)) {
+			watching = true;
+		} else if ((strcmp(argv[arg], "--debounce")==0)) {
+			nextParam(arg, argc, argv);
+			debounce = (unsigned)atoi(argv[arg]);
 		} else {
 			if ((strcmp(argv[arg], "--inputfile")==0) || (strcmp(argv[arg], "-f")==0)) {
 				nextParam(arg, argc, argv);
@@ -62,6 +574,15 @@ int main(int argc, const char * argv[]) {
 		arg += 1;
 	}
 
+	// serve build requests
+	if (! socketPath.empty()) {
+		if (! serve(socketPath, settings)) {
+			printf("Error 4: cannot serve on %s\n", socketPath.c_str());
+			exit(4);
+		}
+		return 0;
+	}
+
 	// do assembling
 	std::chrono::high_resolution_clock Clock;
 	auto startTime = Clock.now();
@@ -69,12 +590,25 @@ int main(int argc, const char * argv[]) {
 		printf("Error 2: missing file %s\n", inputFile.c_str());
 		exit(2);
 	}
-	if (! inputFile.empty())
-	try {
+	if (watching) {
+		watch(inputFile, settings, debounce);
+	} else if (! matrixFile.empty()) {
+		std::vector<Configuration> configurations;
+		if (! readConfigurations(matrixFile, configurations)) {
+			printf("Error 3: missing file %s\n", matrixFile.c_str());
+			exit(3);
+		}
+		assembleMatrix(inputFile, settings, configurations, jobs);
+	} else if (! inputFile.empty()) {
+		MUZ::Assembler as;
+		MUZ::ErrorList msg;
+		configure(as, settings, settings.outputdir);
+		try {
 			as.AssembleFile(inputFile, msg);
 		} catch (std::exception &e) {
 			perror(e.what());
 		}
+	}
 
 	double elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(Clock.now() - startTime).count() / 1000.0;
 	printf("Assembling took %lf seconds\n", elapsedTime);
@@ -71,10 +71,9 @@ namespace MUZ {
 		return msg.Error(errorDefine, codeline);
 	}
 	/** Identifies a source string as self. */
-	bool DirectiveDEFINE::Identify( std::string source )
+	bool DirectiveDEFINE::Identify( const std::string& source )
 	{
-		std::string upper = std::to_upper(source);
-		if (upper=="DEFINE") return true;
+		if (Keywords::Match(source, "DEFINE")) return true;
 		return false;
 	}
 
@@ -108,10 +107,9 @@ namespace MUZ {
 		return as.ExistDefSymbol(symbol) ? errorTypeTRUE : errorTypeFALSE;
 	}
 	/** Identifies a source string as self. */
-	bool DirectiveIFDEF::Identify( std::string source )
+	bool DirectiveIFDEF::Identify( const std::string& source )
 	{
-		std::string upper = std::to_upper(source);
-		if (upper=="IFDEF") return true;
+		if (Keywords::Match(source, "IFDEF")) return true;
 		return false;
 	}
 
@@ -129,10 +127,9 @@ namespace MUZ {
 		return as.ExistDefSymbol(symbol) ? errorTypeFALSE : errorTypeTRUE;
 	}
 	/** Identifies a source string as self. */
-	bool DirectiveIFNDEF::Identify( std::string source )
+	bool DirectiveIFNDEF::Identify( const std::string& source )
 	{
-		std::string upper = std::to_upper(source);
-		if (upper=="IFNDEF") return true;
+		if (Keywords::Match(source, "IFNDEF")) return true;
 		return false;
 	}
 
@@ -151,28 +148,25 @@ namespace MUZ {
 		return b ? errorTypeTRUE : errorTypeFALSE;
 	}
 	/** Identifies a source string as self. */
-	bool DirectiveIF::Identify( std::string source )
+	bool DirectiveIF::Identify( const std::string& source )
 	{
-		std::string upper = std::to_upper(source);
-		if (upper=="IF") return true;
-		if (upper=="COND") return true;
+		if (Keywords::Match(source, "IF")) return true;
+		if (Keywords::Match(source, "COND")) return true;
 		return false;
 	}
 
 	/** Identifies a source string as self. */
-	bool DirectiveELSE::Identify( std::string source )
+	bool DirectiveELSE::Identify( const std::string& source )
 	{
-		std::string upper = std::to_upper(source);
-		if (upper=="ELSE") return true;
+		if (Keywords::Match(source, "ELSE")) return true;
 		return false;
 	}
 
 	/** Identifies a source string as self. */
-	bool DirectiveENDIF::Identify( std::string source )
+	bool DirectiveENDIF::Identify( const std::string& source )
 	{
-		std::string upper = std::to_upper(source);
-		if (upper=="ENDIF") return true;
-		if (upper=="ENDC") return true;
+		if (Keywords::Match(source, "ENDIF")) return true;
+		if (Keywords::Match(source, "ENDC")) return true;
 		return false;
 	}
 
@@ -361,13 +355,13 @@ namespace MUZ {
 	/** label[:]  [.]EQU <expression>
 	 	returns true if the label has been created with the value as a decimal number
 	 */
-	ErrorType DirectiveEQU::Parse(class Assembler& as, Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg)
+	ErrorType DirectiveEQU::Parse(class Assembler& , Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg)
 	{
 		if (!parser.ExistMoreToken(1))  return msg.Error(errorMissingToken, codeline);
 		std::vector<size_t> unsolved = parser.ResolveNextSymbols(false);
 		DWORD number = 0;
-		if (unsolved.size() > 0 && ! as.IsFirstPass()) {
-			msg.ForceWarning(warningUnsolvedExpression, codeline);
+		if (unsolved.size() > 0) {
+			msg.Warning(warningUnsolvedExpression, codeline, 2);
 		}
 		// compute address, unsolved symbols have been replaced by "0"
 		parser.JumpTokens(1); // skip after .EQU
@@ -388,11 +382,10 @@ namespace MUZ {
 	}
 
 	/** Identifies a source string as self. */
-	bool DirectiveEQU::Identify( std::string source )
+	bool DirectiveEQU::Identify( const std::string& source )
 	{
-		std::string upper = std::to_upper(source);
-		if (upper==".EQU") return errorTypeOK;
-		if (upper=="EQU") return errorTypeOK;
+		if (Keywords::Match(source, ".EQU")) return errorTypeOK;
+		if (Keywords::Match(source, "EQU")) return errorTypeOK;
 
 		return false;
 	}
@@ -400,13 +393,13 @@ namespace MUZ {
 	/** label[:]  [.]SET <expression>
 		returns true if the label has been updated with the value as a decimal number
 	 */
-	ErrorType DirectiveSET::Parse(class Assembler& as, Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg)
+	ErrorType DirectiveSET::Parse(class Assembler& , Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg)
 	{
 		if (!parser.ExistMoreToken(1))  return msg.Error(errorMissingToken, codeline);
 		std::vector<size_t> unsolved = parser.ResolveNextSymbols(false);
 		DWORD number = 0;
-		if (unsolved.size() > 0 && !as.IsFirstPass()) {
-			msg.ForceWarning(warningUnsolvedExpression, codeline);
+		if (unsolved.size() > 0) {
+			msg.Warning(warningUnsolvedExpression, codeline, 2);
 		}
 		// compute address, unsolved symbols have been replaced by "0"
 		parser.JumpTokens(1); // skip after .EQU
@@ -427,11 +420,10 @@ namespace MUZ {
 	}
 
 	/** Identifies a source string as self. */
-	bool DirectiveSET::Identify(std::string source)
+	bool DirectiveSET::Identify(const std::string& source)
 	{
-		std::string upper = std::to_upper(source);
-		if (upper == ".SET") return errorTypeOK;
-		if (upper == "SET") return errorTypeOK;
+		if (Keywords::Match(source, ".SET")) return errorTypeOK;
+		if (Keywords::Match(source, "SET")) return errorTypeOK;
 
 		return false;
 	}
@@ -443,7 +435,7 @@ namespace MUZ {
 			- character string
 			- HEXCHAR <num8>
 	 */
-	ErrorType DirectiveBYTE::Parse(class Assembler& as, Parser& parser, CodeLine& codeline, class Label* , ErrorList& msg)
+	ErrorType DirectiveBYTE::Parse(class Assembler& , Parser& parser, CodeLine& codeline, class Label* , ErrorList& msg)
 	{
 		if (!parser.ExistMoreToken(1)) return msg.Error(errorMissingToken, codeline);
 		parser.ResolveNextSymbols(false);
@@ -467,8 +459,8 @@ namespace MUZ {
 				catch (... /*const std::exception & e*/) {
 					return msg.Error(errorInvalidExpression, codeline);
 				}
-				if ((address > 255)  && ! as.IsFirstPass()) {
-					msg.ForceWarning(warningTooBig8, codeline);
+				if (address > 255) {
+					msg.Warning(warningTooBig8, codeline, 2);
 				}
 				if (address > 15) {
 					codeline.AddCode( byte_to_hexchar((address & 0xF0) >> 4));
@@ -481,15 +473,13 @@ namespace MUZ {
 				catch (... /*const std::exception & e*/) {
 					return msg.Error(errorInvalidExpression, codeline);
 				}
-				if ((address > 255)  && ! as.IsFirstPass()) {
-					msg.ForceWarning(warningTooBig8, codeline);
+				if (address > 255) {
+					msg.Warning(warningTooBig8, codeline, 2);
 				}
 				codeline.AddCode((DATATYPE)(address & DATAMASK));
 			} else if (token.type == tokenTypeLETTERS && token.unsolved) {
 				codeline.AddCode(0);
-				if ( ! as.IsFirstPass()) {
-					msg.ForceWarning(warningUnsolvedExpression, codeline);
-				}
+				msg.Warning(warningUnsolvedExpression, codeline, 2);
 			}
 			if (parser.ExistMoreToken(1)) {
 				ParseToken& tokencomma = parser.NextToken(0);// (0) = current token 
@@ -551,9 +541,7 @@ namespace MUZ {
 		parser.ResolveNextSymbols(false);
 		ParseToken& token = parser.NextToken();
 		DWORD size = token.asInteger();
-		for (DWORD i = 0 ; i < size ; i++) {
-			codeline.AddCode(0xFF);
-		}
+		codeline.Fill(size, 0xFF);
 		return errorTypeOK;
 	}
 
@@ -563,6 +551,131 @@ namespace MUZ {
 		as.Terminate();
 		return errorTypeOK;
 	}
+
+	/** .RELAX [ON|OFF]
+	 	Lets the assembler choose between JP and JR for the following jumps, until .RELAX OFF.
+	 */
+	ErrorType DirectiveRELAX::Parse(class Assembler& as, Parser& parser, CodeLine& codeline, class Label* , ErrorList& msg) {
+		bool enable = true;
+		if (parser.ExistMoreToken(1)) {
+			std::string value;
+			parser.JumpNextToken();
+			try { parser.EvaluateString(value); }
+			catch (... /*const std::exception & e*/) {
+				return msg.Error(errorInvalidExpression, codeline);
+			}
+			enable = (std::to_upper(value) == "OFF") ? false : true;
+		}
+		as.EnableRelax(enable);
+		return errorTypeOK;
+	}
+
+	/** .MACRO <name> [<parameter> [, <parameter> [...]]]
+	 	Records the following lines until .ENDM, they are assembled where the name is used as an instruction
+	 	followed by the arguments for the parameters.
+	 */
+	ErrorType DirectiveMACRO::Parse(class Assembler& as, Parser& , CodeLine& codeline, class Label* , ErrorList& msg) {
+		Assembler::Macro* macro = nullptr;
+		ErrorType result = errorTypeOK;
+		// only pass 1 records the lines, pass 2 skips them
+		if (as.IsFirstPass()) {
+			// the name then the parameters separated by commas
+			std::vector<SYMBOLID> names;
+			bool expectname = true;
+			for (codeline.curtoken += 1 ; codeline.curtoken < codeline.tokens.size() ; codeline.curtoken++) {
+				ParseToken& token = codeline.tokens[codeline.curtoken];
+				if (token.type == tokenTypeCOMMENT) break;
+				if ((token.type == tokenTypeCOMMA) && !expectname && (names.size() > 1)) {
+					expectname = true;
+					continue;
+				}
+				if (!expectname || (token.type != tokenTypeLETTERS) || (token.keyword >= 0) || (token.symbol == 0)) {
+					result = msg.Error(errorMacroName, codeline);
+					break;
+				}
+				names.push_back(token.symbol);
+				expectname = (names.size() == 1);
+			}
+			if ((result == errorTypeOK) && names.empty()) {
+				result = msg.Error(errorMissingToken, codeline);
+			} else if ((result == errorTypeOK) && expectname && (names.size() > 1)) {
+				result = msg.Error(errorMacroName, codeline);
+			}
+			if (result == errorTypeOK) {
+				macro = new Assembler::Macro;
+				macro->name = names[0];
+				macro->parameters.assign(names.begin() + 1, names.end());
+				as.DefineMacro(macro);
+			}
+		}
+		as.StartRecording(macro, false, codeline);
+		return result;
+	}
+
+	/** .ENDM
+	 	Ends the lines of a .MACRO.
+	 */
+	ErrorType DirectiveENDM::Parse(class Assembler& as, Parser& , CodeLine& codeline, class Label* , ErrorList& msg) {
+		if (!as.m_recording.active) return msg.Error(errorMacroEnd, codeline);
+		bool repeat = as.m_recording.repeat;
+		Assembler::Macro* macro = as.EndRecording();
+		if (repeat) {
+			delete macro;
+			return msg.Error(errorMacroEnd, codeline);
+		}
+		return errorTypeOK;
+	}
+
+	/** .REPT <count>
+	 	Records the following lines until .ENDR, then assembles them the given number of times. The count must be
+	 	known in pass 1.
+	 */
+	ErrorType DirectiveREPT::Parse(class Assembler& as, Parser& parser, CodeLine& codeline, class Label* , ErrorList& msg) {
+		Assembler::Macro* macro = nullptr;
+		ErrorType result = errorTypeOK;
+		// only pass 1 records the lines, pass 2 skips them
+		if (as.IsFirstPass()) {
+			DWORD count = 0;
+			if (!parser.ExistMoreToken(1)) {
+				result = msg.Error(errorMissingToken, codeline);
+			} else if (!parser.ResolveNextSymbols(false).empty()) {
+				result = msg.Error(errorReptCount, codeline);
+			} else {
+				parser.JumpTokens(1);
+				try {
+					if (!parser.EvaluateInteger(count)) result = msg.Error(errorInvalidExpression, codeline);
+				}
+				catch (... /*const std::exception & e*/) {
+					result = msg.Error(errorInvalidExpression, codeline);
+				}
+				if ((result == errorTypeOK) && (count > 0xFFFF)) result = msg.Error(errorReptCount, codeline);
+			}
+			if (result == errorTypeOK) {
+				macro = new Assembler::Macro;
+				macro->repeat = true;
+				macro->count = count;
+			}
+		}
+		as.StartRecording(macro, true, codeline);
+		return result;
+	}
+
+	/** .ENDR
+	 	Ends the lines of a .REPT and assembles them.
+	 */
+	ErrorType DirectiveENDR::Parse(class Assembler& as, Parser& , CodeLine& codeline, class Label* , ErrorList& msg) {
+		if (!as.m_recording.active) return msg.Error(errorMacroEnd, codeline);
+		bool repeat = as.m_recording.repeat;
+		Assembler::Macro* macro = as.EndRecording();
+		if (!repeat) return msg.Error(errorMacroEnd, codeline);
+		if (!as.IsFirstPass()) return as.ReplayExpansion(codeline, msg);
+		ErrorType result = errorTypeOK;
+		if (macro) {
+			result = as.ExpandMacro(*macro, codeline, codeline.tokens.size(), msg);
+			delete macro;
+		}
+		return result;
+	}
 	/** Small Computer Workshop 2019-09-07 and LCD alphanumeric sample compatibility */
 
 	/** #REQUIRES <symbol>
@@ -591,10 +704,9 @@ namespace MUZ {
 		return msg.Error(errorDefine, codeline);
 	}
 	/** Identifies a source string as self. */
-	bool DirectiveREQUIRES::Identify(std::string source)
+	bool DirectiveREQUIRES::Identify(const std::string& source)
 	{
-		std::string upper = std::to_upper(source);
-		if (upper == "REQUIRES") return true;
+		if (Keywords::Match(source, "REQUIRES")) return true;
 		return false;
 	}
 
@@ -613,10 +725,9 @@ namespace MUZ {
 		return as.ExistReqSymbol(symbol) ? errorTypeTRUE : errorTypeFALSE;
 	}
 	/** Identifies a source string as self. */
-	bool DirectiveIFREQUIRED::Identify(std::string source)
+	bool DirectiveIFREQUIRED::Identify(const std::string& source)
 	{
-		std::string upper = std::to_upper(source);
-		if (upper == "IFREQUIRED") return true;
+		if (Keywords::Match(source, "IFREQUIRED")) return true;
 		return false;
 	}
 
@@ -38,7 +38,7 @@ namespace MUZ {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
 		/** Returns true if the given string qualifies for an #DEFINE directive. */
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** Handles #UNDEF directive. */
 	class DirectiveUNDEFINE : public Directive {
@@ -49,33 +49,33 @@ namespace MUZ {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
 		/** Returns true if the given string qualifies for an #IF directive. */
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** Handles #IFDEF. */
 	class DirectiveIFDEF : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
 		/** Returns true if the given string qualifies for an #IFDEF directive. */
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** Handles #IFNDEF. */
 	class DirectiveIFNDEF : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
 		/** Returns true if the given string qualifies for an #IFNDEF directive. */
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** #ELSE - this is managed by Assembler when it handles the conditionnal modes. */
 	class DirectiveELSE : public Directive {
 	public:
 		/** Returns true if the given string qualifies for an #ELSE directive. */
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** #ENDIF - this is managed by Assembler when it handles the conditionnal modes. */
 	class DirectiveENDIF : public Directive {
 	public:
 		/** Returns true if the given string qualifies for an #ENDIF directive. */
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** #INCLUDE */
 	class DirectiveINCLUDE : public Directive {
@@ -105,14 +105,14 @@ namespace MUZ {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
 		/** Returns true if the given string qualifies for an #DEFINE directive. */
-		static bool Identify(std::string source);
+		static bool Identify(const std::string& source);
 	};
 	/** Handles #IFREQUIRED. */
 	class DirectiveIFREQUIRED : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
 		/** Returns true if the given string qualifies for an #REQUIRES directive. */
-		static bool Identify(std::string source);
+		static bool Identify(const std::string& source);
 	};
 
 
@@ -139,25 +139,28 @@ namespace MUZ {
 	class DirectiveEQU : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** Handles .SET directive. */
 	class DirectiveSET : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	public:
-		static bool Identify( std::string source );
+		static bool Identify( const std::string& source );
 	};
 	/** .DB */
 	class DirectiveBYTE : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+		virtual bool IsData() const { return true; }
 	};
 	/** .DW */
 	class DirectiveWORD : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+		virtual bool IsData() const { return true; }
 	};
 	/** .DS */
 	class DirectiveSPACE : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+		virtual bool IsData() const { return true; }
 	};
 
 	/** .HEXBYTES */
@@ -168,5 +171,25 @@ namespace MUZ {
 	class DirectiveEND : public Directive {
 		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
 	};
+	/** .RELAX */
+	class DirectiveRELAX : public Directive {
+		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+	};
+	/** .MACRO */
+	class DirectiveMACRO : public Directive {
+		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+	};
+	/** .ENDM */
+	class DirectiveENDM : public Directive {
+		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+	};
+	/** .REPT */
+	class DirectiveREPT : public Directive {
+		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+	};
+	/** .ENDR */
+	class DirectiveENDR : public Directive {
+		virtual ErrorType Parse(class Assembler& as, class Parser& parser, CodeLine& codeline, class Label* label, ErrorList& msg);
+	};
 }
 #endif /* All_Directives_h */
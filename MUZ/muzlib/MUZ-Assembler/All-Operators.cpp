@@ -13,9 +13,9 @@
 namespace MUZ {
 
 	/** helper for boolean conversion */
-	inline bool to_bool(ParseToken token) {
+	inline bool to_bool(ParseToken& token) {
 		if (token.type == tokenTypeDECNUMBER) {
-			return token.source != "0";
+			return token.asInteger() != 0;
 		}
 		// below works for BOOL as well as STRING
 		return !token.source.empty();
@@ -33,8 +33,7 @@ namespace MUZ {
 	}
 	/** helper to convert a number into a token */
 	inline void to_numtoken(unsigned int n, ParseToken& token) {
-		token.type = tokenTypeDECNUMBER;
-		token.source = std::to_string(n);
+		token.setNumber(n);
 	}
 
 	
@@ -130,7 +129,7 @@ namespace MUZ {
 			}
 			// one or both arguments as string?
 			if (arg1.type == tokenTypeSTRING || arg2.type == tokenTypeSTRING) {
-				to_stringtoken( arg1.source + arg2.source, result);
+				to_stringtoken( arg1.asString() + arg2.asString(), result);
 				return result;
 			}
 			// consider both are decimal numbers
@@ -274,13 +273,15 @@ namespace MUZ {
 			}
 			// string comparison?
 			if (arg1.type == tokenTypeSTRING || arg2.type == tokenTypeSTRING) {
-				size_t len1 = arg1.source.length();
-				size_t len2 = arg2.source.length();
+				const std::string s1 = arg1.asString();
+				const std::string s2 = arg2.asString();
+				size_t len1 = s1.length();
+				size_t len2 = s2.length();
 				size_t len = std::min<size_t>(len1, len2);
 				bool inferior = true;
 				for (size_t i = 0 ; inferior && (i < len) ; i++) {
-					const unsigned char c1 = (const unsigned char)arg1.source[i];
-					const unsigned char c2 = (const unsigned char)arg2.source[i];
+					const unsigned char c1 = (const unsigned char)s1[i];
+					const unsigned char c2 = (const unsigned char)s2[i];
 					if (c1 >= c2)
 						inferior = false;
 				}
@@ -323,14 +324,16 @@ namespace MUZ {
 			}
 			// string comparison?
 			if (arg1.type == tokenTypeSTRING || arg2.type == tokenTypeSTRING) {
-				size_t len1 = arg1.source.length();
-				size_t len2 = arg2.source.length();
+				const std::string s1 = arg1.asString();
+				const std::string s2 = arg2.asString();
+				size_t len1 = s1.length();
+				size_t len2 = s2.length();
 				size_t len = std::min<size_t>(len1, len2);
 				bool superior = true;
 				bool equal = true;
 				for (size_t i = 0 ; superior && (i < len) ; i++) {
-					const unsigned char c1 = (const unsigned char)arg1.source[i];
-					const unsigned char c2 = (const unsigned char)arg2.source[i];
+					const unsigned char c1 = (const unsigned char)s1[i];
+					const unsigned char c2 = (const unsigned char)s2[i];
 					if (c1 < c2)
 						superior = false;
 					if (equal && (c1 != c2))
@@ -375,13 +378,15 @@ namespace MUZ {
 			}
 			// string comparison?
 			if (arg1.type == tokenTypeSTRING || arg2.type == tokenTypeSTRING) {
-				size_t len1 = arg1.source.length();
-				size_t len2 = arg2.source.length();
+				const std::string s1 = arg1.asString();
+				const std::string s2 = arg2.asString();
+				size_t len1 = s1.length();
+				size_t len2 = s2.length();
 				size_t len = std::min<size_t>(len1, len2);
 				bool inferior = true;
 				for (size_t i = 0 ; inferior && (i < len) ; i++) {
-					const unsigned char c1 = (const unsigned char)arg1.source[i];
-					const unsigned char c2 = (const unsigned char)arg2.source[i];
+					const unsigned char c1 = (const unsigned char)s1[i];
+					const unsigned char c2 = (const unsigned char)s2[i];
 					if (c1 >= c2)
 						inferior = false;
 				}
@@ -423,13 +428,15 @@ namespace MUZ {
 			}
 			// string comparison?
 			if (arg1.type == tokenTypeSTRING || arg2.type == tokenTypeSTRING) {
-				size_t len1 = arg1.source.length();
-				size_t len2 = arg2.source.length();
+				const std::string s1 = arg1.asString();
+				const std::string s2 = arg2.asString();
+				size_t len1 = s1.length();
+				size_t len2 = s2.length();
 				size_t len = std::min<size_t>(len1, len2);
 				bool superior = true;
 				for (size_t i = 0 ; superior && (i < len) ; i++) {
-					const unsigned char c1 = (const unsigned char)arg1.source[i];
-					const unsigned char c2 = (const unsigned char)arg2.source[i];
+					const unsigned char c1 = (const unsigned char)s1[i];
+					const unsigned char c2 = (const unsigned char)s2[i];
 					if (c1 < c2)
 						superior = false;
 				}
@@ -469,15 +476,17 @@ namespace MUZ {
 			}
 			// string comparison?
 			if (arg1.type == tokenTypeSTRING || arg2.type == tokenTypeSTRING) {
-				size_t len1 = arg1.source.length();
-				size_t len2 = arg2.source.length();
+				const std::string s1 = arg1.asString();
+				const std::string s2 = arg2.asString();
+				size_t len1 = s1.length();
+				size_t len2 = s2.length();
 				if (len1 != len2) {
 					to_booltoken(false, result);
 				} else {
 					bool diff = false;
 					for (size_t i = 0 ; !diff && (i < len1) ; i++) {
-						const char c1 = arg1.source[i];
-						const char c2 = arg2.source[i];
+						const char c1 = s1[i];
+						const char c2 = s2[i];
 						if ((c1 == '\x1A') || (c2 == '\x1A'))
 							break;
 						if (c1 != c2)
@@ -521,13 +530,15 @@ namespace MUZ {
 			}
 			// string comparison?
 			if (arg1.type == tokenTypeSTRING || arg2.type == tokenTypeSTRING) {
-				size_t len1 = arg1.source.length();
-				size_t len2 = arg2.source.length();
+				const std::string s1 = arg1.asString();
+				const std::string s2 = arg2.asString();
+				size_t len1 = s1.length();
+				size_t len2 = s2.length();
 				size_t len = std::min<size_t>(len1, len2);
 				bool equal = true;
 				for (size_t i = 0 ; equal && (i < len) ; i++) {
-					const char c1 = arg1.source[i];
-					const char c2 = arg2.source[i];
+					const char c1 = s1[i];
+					const char c2 = s2[i];
 					if ((c1 == '\x1A') || (c2 == '\x1A'))
 						break;
 					if (c1 != c2)
@@ -10,7 +10,9 @@
 #include "MUZ-Common/FileUtils.h"
 #include "MUZ-Common/Section.h"
 #include "Parser.h"
+#include "LineSplitter.h"
 #include "All-Directives.h"
+#include "DebugInfo.h"
 #include "Z-180/Z180-Instructions.h"
 #include <list>
 #include <algorithm>
@@ -30,10 +32,16 @@ using std::string;
 namespace MUZ {
 
 	// Prototypes to avoid warnings
-	string buildCodes(vector<BYTE> code, size_t firstcode, size_t nbcodes);
-	Assembler::ListingLine buildOneListingLineStructure(DWORD address, vector<DATATYPE> code, size_t firstcode, size_t nbcodes, Label* label, std::string defsymbol, size_t file, size_t line, string source, int message);
+	string buildCodes(const CodeLine& codeline, size_t firstcode, size_t nbcodes);
+	Assembler::ListingLine buildOneListingLineStructure(DWORD address, const CodeLine& codeline, size_t firstcode, size_t nbcodes, Label* label, std::string defsymbol, size_t file, size_t line, string source, int message);
 	Assembler::ListingLine buildOneListingLineStructure(size_t file, size_t line, string source, ErrorList& msg);
-	Assembler::Listing buildListingLineStructures(CodeLine& codeline, ErrorList& msg, bool all );
+	void buildListingLineStructures(CodeLine& codeline, ErrorList& msg, bool all, Assembler::ListingSink& listing);
+	bool isSymbolChar(char c);
+	size_t skipQuoted(const string& source, size_t pos);
+	std::vector<string> splitArguments(const string& source, size_t pos);
+	string substituteParameters(const string& source, const std::vector<string>& names, const std::vector<string>& texts);
+	char* putHexByte(char* out, DWORD value, DWORD& sum);
+	char* putHexRecord(char* out, DWORD nbbytes, DWORD address, DWORD type, const DATATYPE* data);
 
 	//MARK: - Listing helper functions
 	
@@ -50,21 +58,22 @@ namespace MUZ {
 	// Source at pos 26                     : source text
 	
 	/** Returns the 12 characters part of byte codes. */
-	string buildCodes(vector<BYTE> code, size_t firstcode, size_t nbcodes)
+	string buildCodes(const CodeLine& codeline, size_t firstcode, size_t nbcodes)
 	{
 		// 0 codes: all spaces
-		if ((nbcodes == 0) || (code.size() == 0)) return spaces(12);
+		size_t codesize = codeline.Size();
+		if ((nbcodes == 0) || (codesize == 0)) return spaces(12);
 		// 1 to 4 codes
 		string result;
-		size_t lastindex = std::min<size_t>(firstcode + nbcodes - 1, code.size() - 1);
+		size_t lastindex = std::min<size_t>(firstcode + nbcodes - 1, codesize - 1);
 		// (0,4) -> codes 0 to 3
 		// (4,4) -> codes 4 to 7
 		// (0,2) -> codes 0 to 1 then "   "
 		// (4,3) -> codes 4 to 6 then ".. "
 		for (size_t index = (size_t)firstcode ; index <= firstcode + 3 ; index++) {
 			if (index <= lastindex) {
-				result += data_to_hex(code[index]) + " "; 	// normal code display
-			} else if (index < code.size()) {
+				result += data_to_hex(codeline.Byte(index)) + " "; 	// normal code display
+			} else if (index < codesize) {
 				result += "...";									// show code presence but not value
 			} else {
 				result += spaces(3);							// no more code available, all space
@@ -75,7 +84,7 @@ namespace MUZ {
 	
 	/** Builds one listing line from a code index.
 	 @param address the starting address to put first
-	 @param code the vector of code containing all code
+	 @param codeline the code line containing all code
 	 @param firstcode the index of the first code to display
 	 @param nbcodes the number of codes to display, from 0 to 4 maximum
 	 @param label a label containing a value to display instead of 'address', or nullptr to ignore
@@ -84,7 +93,7 @@ namespace MUZ {
 	 @param source the source code to display after address, code and line number
 	 @return the string containing the listing line
 	 */
-	Assembler::ListingLine buildOneListingLineStructure(DWORD address, vector<DATATYPE> code, size_t firstcode, size_t nbcodes, Label* label, std::string defsymbol, size_t file, size_t line, string source, int message)
+	Assembler::ListingLine buildOneListingLineStructure(DWORD address, const CodeLine& codeline, size_t firstcode, size_t nbcodes, Label* label, std::string defsymbol, size_t file, size_t line, string source, int message)
 	{
 		Assembler::ListingLine ll;
 
@@ -92,7 +101,8 @@ namespace MUZ {
 		ll.line = line;
 
 		// Is there any code?
-		if (code.empty()) {
+		bool nocode = (codeline.Size() == 0);
+		if (nocode) {
 			// no code: any #DEFINE symbol?
 			if (!defsymbol.empty()) {
 				ll.defsymbol = defsymbol;
@@ -143,7 +153,7 @@ namespace MUZ {
 		*/
 
 		// for no-code and for first line of code, include line number source and comment
-		if (code.empty() || (firstcode == 0)) {
+		if (nocode || (firstcode == 0)) {
 			ll.line = line;
 			ll.parts.line = -1;
 			ll.source = instr;
@@ -152,8 +162,8 @@ namespace MUZ {
 			ll.parts.comment = comment.empty() ? 0 : -1;
 		}
 		// for all lines of code, include byte codes
-		if (! code.empty()) {
-			ll.codebytes = buildCodes(code, firstcode, nbcodes);
+		if (! nocode) {
+			ll.codebytes = buildCodes(codeline, firstcode, nbcodes);
 			ll.parts.code = -1;
 		}
 
@@ -180,38 +190,172 @@ namespace MUZ {
 	/** Build one or more lines of listing for the codes given.
 	 @param codeline the assembled code line containing code to list.
 	 @param all true to list all bytes , false to limit to 2 lines of listing, with a "..." ellipsis for code not listed
-	 @return a vector of strings to display/list in order
+	 @param result the sink receiving the lines in order
 	 */
-	Assembler::Listing buildListingLineStructures(CodeLine& codeline, ErrorList& , bool all )
+	void buildListingLineStructures(CodeLine& codeline, ErrorList& , bool all, Assembler::ListingSink& result)
 	{
-		Assembler::Listing result;
-		if (!codeline.listing) return result;
+		if (!codeline.listing) return;
 
-		vector<DATATYPE>& code = codeline.code;
-		size_t codesize = code.size();
+		size_t codesize = codeline.Size();
 
 		// first line complete with 0 to 4 bytes of code
-		result.push_back(buildOneListingLineStructure(codeline.address, code, 0, std::min<size_t>(4, codesize), codeline.label, codeline.defsymbol, codeline.file, codeline.line, codeline.source, codeline.message));
+		result.Add(buildOneListingLineStructure(codeline.address, codeline, 0, std::min<size_t>(4, codesize), codeline.label, codeline.defsymbol, codeline.file, codeline.line, codeline.source, codeline.message));
 
 		// second line depend on the number of codes
 		if (codesize >= 5 && codesize <= 8) {
 			// second line with 1 to 4 bytes of code
-			result.push_back(buildOneListingLineStructure(codeline.address + 4, code, 4, codesize - 4, nullptr, "", 0, 0, "", -1));
-		} else if (codeline.code.size() >= 9) {
+			result.Add(buildOneListingLineStructure(codeline.address + 4, codeline, 4, codesize - 4, nullptr, "", 0, 0, "", -1));
+		} else if (codesize >= 9) {
 			// rest of listing
 			if (all) {
 				// each packet of 4 code bytes
-				for (DWORD start = 4 ; start < codeline.code.size() ; start += 4) {
-					result.push_back(buildOneListingLineStructure(codeline.address + start, code, start, 4, nullptr, "", 0, 0, "", -1));
+				for (DWORD start = 4 ; start < codesize ; start += 4) {
+					result.Add(buildOneListingLineStructure(codeline.address + start, codeline, start, 4, nullptr, "", 0, 0, "", -1));
 				}
 			} else {
 				// one line only with 1 to 3 bytes of code bytes 4 to 7, then "..." if there's more
-				result.push_back(buildOneListingLineStructure(codeline.address + 4, code, 4, 3, nullptr, "", 0, 0, "", -1));
+				result.Add(buildOneListingLineStructure(codeline.address + 4, codeline, 4, 3, nullptr, "", 0, 0, "", -1));
 			}
 		}
+	}
+
+	//MARK: - Macro helper functions
+	
+	/** Tells if a character can be part of a symbol name. */
+	bool isSymbolChar(char c)
+	{
+		return ((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z')) || ((c >= '0') && (c <= '9')) || (c == '_') || (c == '@');
+	}
+	
+	/** Returns the position following a quoted string or character, or the given position if it does not start a
+	 quote. A quote following a letter is part of a name like AF'. */
+	size_t skipQuoted(const string& source, size_t pos)
+	{
+		char quote = source[pos];
+		if ((quote != '"') && (quote != '\'')) return pos;
+		if ((quote == '\'') && (pos > 0) && isSymbolChar(source[pos - 1])) return pos;
+		size_t end = pos + 1;
+		while ((end < source.size()) && (source[end] != quote)) {
+			if (source[end] == '\\') end += 1;
+			end += 1;
+		}
+		return std::min<size_t>(end + 1, source.size());
+	}
+	
+	/** Splits the source text of the macro arguments at the commas which are not within parenthesis or quotes.
+	 @param source the source of the line invoking the macro
+	 @param pos the position following the macro name
+	 @return the trimmed text of each argument
+	 */
+	std::vector<string> splitArguments(const string& source, size_t pos)
+	{
+		std::vector<string> arguments;
+		string argument;
+		auto store = [&]() {
+			size_t start = argument.find_first_not_of(" \t");
+			argument.erase(0, (start == string::npos) ? argument.size() : start);
+			strtrimright(argument);
+			arguments.push_back(argument);
+			argument.clear();
+		};
+		int depth = 0;
+		while ((pos < source.size()) && (source[pos] != ';')) {
+			size_t next = skipQuoted(source, pos);
+			if (next > pos) {
+				argument.append(source, pos, next - pos);
+				pos = next;
+				continue;
+			}
+			char c = source[pos++];
+			if (c == '(') depth += 1;
+			if (c == ')') depth -= 1;
+			if ((c == ',') && (depth == 0)) {
+				store();
+			} else {
+				argument += c;
+			}
+		}
+		if (!arguments.empty() || (argument.find_first_not_of(" \t") != string::npos)) store();
+		return arguments;
+	}
+	
+	/** Replaces the parameter names by the argument texts in the source of a macro line, for the listing. The
+	 strings, characters and comment are kept as written.
+	 @param source the source of the recorded line
+	 @param names the parameter names
+	 @param texts the argument texts, in the parameters order
+	 @return the source of the expanded line
+	 */
+	string substituteParameters(const string& source, const std::vector<string>& names, const std::vector<string>& texts)
+	{
+		string result;
+		size_t pos = 0;
+		while ((pos < source.size()) && (source[pos] != ';')) {
+			size_t next = skipQuoted(source, pos);
+			if (next == pos) {
+				next = pos + 1;
+				if (isSymbolChar(source[pos])) {
+					while ((next < source.size()) && isSymbolChar(source[next])) next += 1;
+					auto found = std::find(names.begin(), names.end(), source.substr(pos, next - pos));
+					if (found != names.end()) {
+						result += texts[(size_t)(found - names.begin())];
+						pos = next;
+						continue;
+					}
+				}
+			}
+			result.append(source, pos, next - pos);
+			pos = next;
+		}
+		result.append(source, pos, string::npos);
 		return result;
 	}
 
+	/** Nibble to uppercase hexadecimal digit table for the Intel HEX output. */
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	/** Writes the low byte of a value as two hexadecimal digits and adds it to a checksum.
+	 @param out the output position
+	 @param value the value to write, only the low byte is written
+	 @param sum the checksum to update
+	 @return the output position after the two digits
+	 */
+	char* putHexByte(char* out, DWORD value, DWORD& sum)
+	{
+		value &= 0xFF;
+		out[0] = hexDigits[value >> 4];
+		out[1] = hexDigits[value & 0x0F];
+		sum += value;
+		return out + 2;
+	}
+
+	/** Writes a complete Intel HEX record with its checksum and ending new line.
+	 The output position must have room for at least HEXRECORDMAXSIZE characters.
+	 @param out the output position
+	 @param nbbytes the number of data bytes, 255 maximum
+	 @param address the 16-bit address field
+	 @param type the Intel record type
+	 @param data the data bytes, or nullptr for no data
+	 @return the output position after the record
+	 */
+	char* putHexRecord(char* out, DWORD nbbytes, DWORD address, DWORD type, const DATATYPE* data)
+	{
+		DWORD sum = 0;
+		*out++ = ':';
+		out = putHexByte(out, nbbytes, sum);
+		out = putHexByte(out, address >> 8, sum);
+		out = putHexByte(out, address, sum);
+		out = putHexByte(out, type, sum);
+		for (DWORD i = 0 ; data && (i < nbbytes) ; i++) {
+			out = putHexByte(out, data[i], sum);
+		}
+		// 2's complement of the sum
+		DWORD dummy = 0;
+		out = putHexByte(out, (~sum) + 1, dummy);
+		*out++ = '\n';
+		return out;
+	}
+
 	//MARK: - Assembler::SourceFile structure
 	
 	/** Gets the root up the whole parent SourceFile tree. Should return the structure for the main source file. */
@@ -289,21 +433,78 @@ namespace MUZ {
 		return errorTypeOK;
 	}
 	
+	/** Deletes the local labels of this SourceFile. */
+	Assembler::SourceFile::~SourceFile()
+	{
+		for (auto & scope : labels) {
+			scope.second.DeleteAll();
+		}
+	}
+	
+	/** Returns the full path of this SourceFile. */
+	std::string Assembler::SourceFile::Path() const
+	{
+		return fileprefix + filepath + NORMAL_DIR_SEPARATOR + filename;
+	}
+	
+	//MARK: - Assembler::Macro structure
+	
+	/** Deletes the macros replaced by this one. */
+	Assembler::Macro::~Macro()
+	{
+		delete previous;
+	}
+	
 	
 	//MARK: - Private Assembler functions
 
+	/** Marks a parser as used while a line is assembled, and frees it on any return. */
+	struct ParserLevel {
+		size_t& level;
+		ParserLevel(size_t& parserlevel) : level(parserlevel) {
+			level += 1;
+		}
+		~ParserLevel() {
+			level -= 1;
+		}
+	};
+	
 	/** Assemble a prepared code line. The code line must have its file and source set, and the assembler will
 	 fill the rest. Notice that running conditionnal directive conditions can make the line to be unassembled
 	 and ignored. In this case, the "assembled" flag is not set.
 	 */
 	ErrorType Assembler::AssembleCodeLine(CodeLine& codeline, ErrorList& msg)
 	{
-		// cut the source line into a vector of tokens
-		Parser parser(*this); // give reference of the assembbler to the parser
-		parser.Split(codeline,msg);
+		// get the parser for the current include level
+		if (m_parserlevel == m_parsers.size()) {
+			m_parsers.push_back(new Parser(*this)); // give reference of the assembbler to the parser
+		}
+		Parser& parser = *m_parsers[m_parserlevel];
+		ParserLevel level(m_parserlevel);
 		
-		// Handle conditionnal assembling for IF/ELSE/ENDIF directives
+		// in an inactive conditionnal block, only the lines which can change the mode are split or restored,
+		// unless the line has been assembled by pass 1 and its messages refer to its tokens
 		ParsingMode curmode = m_modes.top();
+		if (((curmode == parsingModeSKIPTOEND) || (curmode == parsingModeSKIPTOELSE)) && codeline.tokens.empty()) {
+			if (codeline.lexed) {
+				ResultFlag flag = (ResultFlag)codeline.lexedflag;
+				if ((flag != hasIF) && (flag != hasELSE) && (flag != hasENDIF)) return errorTypeFALSE;
+			} else if (!Parser::MaySplitConditional(codeline.source)) {
+				return errorTypeFALSE;
+			}
+		}
+		
+		// cut the source line into a vector of tokens, or get back the tokens split by pass 1
+		if (!parser.Restore(codeline)) {
+			parser.Split(codeline,msg);
+		}
+		
+		// the lines of a .MACRO or .REPT block are recorded instead of being assembled
+		if (m_recording.active && RecordLine(codeline)) {
+			return errorTypeFALSE;
+		}
+		
+		// Handle conditionnal assembling for IF/ELSE/ENDIF directives
 		if (parser.Test(hasIF)) {
 			if ((curmode == parsingModeSKIPTOEND) || (curmode == parsingModeSKIPTOELSE)) {
 				EnterMode(parsingModeSKIPTOEND);
@@ -321,12 +522,12 @@ namespace MUZ {
 			switch (curmode) {
 					
 				case parsingModeROOT:
-					if (! IsFirstPass()) msg.ForceWarning(errorElseNoIf, codeline);
+					msg.Warning(errorElseNoIf, codeline, 2);
 					return errorTypeFALSE;
 				case parsingModeSKIPTOEND:
 					return errorTypeFALSE; // ignore
 				case parsingModeDOTOEND:
-					if (! IsFirstPass()) msg.ForceWarning(errorElseNoIf, codeline);
+					msg.Warning(errorElseNoIf, codeline, 2);
 					return errorTypeFALSE;
 					
 				case parsingModeSKIPTOELSE:
@@ -344,7 +545,7 @@ namespace MUZ {
 		}
 		else if (parser.Test(hasENDIF)) {
 			if (curmode == parsingModeROOT) {
-				if (! IsFirstPass()) msg.ForceWarning(errorEndifNoIf, codeline);
+				msg.Warning(errorEndifNoIf, codeline, 2);
 				return errorTypeFALSE;
 			}
 			ExitMode(curmode);
@@ -359,8 +560,9 @@ namespace MUZ {
 		
 		// If we reach here, all conditions have been managed
 		
-		// Scan for a possible label
+		// Scan for a possible label, and keep the scope for local labels
 		Label* label = ScanLabel(codeline, msg);
+		codeline.scope = m_status.lastlabel;
 		
 		// If there is a label it is assigned the current address, on pass 1 only.
 		// Ignore equates, they are set by EQU directive
@@ -373,7 +575,7 @@ namespace MUZ {
 		for (codeline.curtoken = (label != nullptr) ? 1 : 0 ; codeline.curtoken < codeline.tokens.size() ; codeline.curtoken++) {
 			ParseToken& token = codeline.tokens[codeline.curtoken];
 			if (token.type == tokenTypeDIRECTIVE) {
-				Directive* directive = GetDirective(token.source);
+				Directive* directive = GetDirective(token.keyword);
 				if (!directive) {
 					return msg.Error(errorUnknownDirective, codeline);
 				}
@@ -395,8 +597,14 @@ namespace MUZ {
 				// Should be an instruction
 				// If no .PROC directive has been used, the assembler adopts the Z80 instruction set
 				if (m_instructions.empty()) SetInstructions("Z80");
-				Instruction* instruction = GetInstruction(token.source);
+				Instruction* instruction = GetInstruction(token.keyword);
 				if (instruction == nullptr) {
+					// a macro is expanded after the line
+					if (IsMacro(codeline, token)) {
+						ErrorType result = IsFirstPass() ? ExpandMacro(*m_macros.Get(token.symbol), codeline, codeline.curtoken + 1, msg) : ReplayExpansion(codeline, msg);
+						codeline.label = label;
+						return result;
+					}
 					return msg.Error(errorUknownInstruction, codeline);
 				}
 				// resolve any symbols, and prepare the token index for assembling
@@ -446,15 +654,14 @@ namespace MUZ {
 	 @param codeline the assembled code line containing code to list
 	 @param msg the error and warning list returned by assembler
 	 */
-	void Assembler::GenerateCodeLineListing(CodeLine& codeline, ErrorList& msg, Listing & listing)
+	void Assembler::GenerateCodeLineListing(CodeLine& codeline, ErrorList& msg, ListingSink & listing)
 	{
 		if (codeline.listing) {
 			// Full address/code details for assembled lines, simple line source for non assembled
 			if (codeline.assembled == errorTypeOK) {
-				Listing lines = buildListingLineStructures(codeline, msg, m_status.allcodelisting);
-				for (auto & line: lines) listing.push_back(line);
+				buildListingLineStructures(codeline, msg, m_status.allcodelisting, listing);
 			} else {
-				listing.push_back(buildOneListingLineStructure(codeline.file, codeline.line, codeline.source, msg));
+				listing.Add(buildOneListingLineStructure(codeline.file, codeline.line, codeline.source, msg));
 			}
 		}
 		// always add warning/errors
@@ -464,7 +671,7 @@ namespace MUZ {
 			line.parts.message = -1;
 			line.message = codeline.message;
 			line.token = codeline.curtoken;
-			listing.push_back(line);
+			listing.Add(line);
 		}
 	}
 
@@ -553,7 +760,18 @@ namespace MUZ {
 		fclose(memoryfile);
 	}
 
-	/** Generate Intel HEX output. */
+	/** Size of the Intel HEX output buffer, flushed to the file when it cannot receive another record. */
+	static const size_t HEXBUFFERSIZE = 65536;
+	/** Maximum size of one Intel HEX record: ':', count, address, type, 255 data bytes, checksum and new line. */
+	static const size_t HEXRECORDMAXSIZE = 1 + 2 + 4 + 2 + 255 * 2 + 2 + 1;
+
+	/** Generate Intel HEX output.
+	 Records are formatted in a fixed buffer written to the file in large blocks. Each address range of the merged
+	 section is matched once against the assembled sections ranges, then records of up to m_hexbytes bytes are
+	 written without crossing a section boundary, skipping the ones from non saved sections. Records never cross
+	 a 64 KB boundary, and a type 04 extended linear address record is written each time the upper 16 bits of the
+	 address change.
+	 */
 	void Assembler::GenerateIntelHex(DATATYPE* memory, Section& section, ErrorList& msg)
 	{
 		CodeLine codeline;
@@ -575,23 +793,56 @@ namespace MUZ {
 		// '00'   - Intel record type = 0
 		// '4CC101A0FF4DC101B0FF4EC10144FF4F' - up to nbbytes data
 		// '2A' - control byte
-		string line;
-		DWORD nbbytes;
-		Section* asmsection;
+		// addresses above $FFFF are preceded by an extended linear address record:
+		// :02000004HHHHcc - HHHH is the upper 16 bits of the following addresses
+		std::vector<char> buffer(HEXBUFFERSIZE);
+		char* out = buffer.data();
+		char* limit = buffer.data() + HEXBUFFERSIZE - 2 * HEXRECORDMAXSIZE;
+		DWORD step = m_hexbytes & 0xFF;
+		if (step == 0) step = 0x10;
+		DWORD upper = 0;
 		
 		// for each address range in the parameter section
 		for (auto &range: section.m_ranges) {
 			
-			// for each address in the range
-			for (DWORD dumpaddress = range.start ; dumpaddress <= range.end ; dumpaddress += 16) {
+			// get the assembled sections ranges overlapping this range once, in the FindSection() order
+			std::vector<std::pair<AddressRange, Section*>> spans;
+			for (auto& asmsection: m_sections) {
+				for (auto& asmrange: asmsection.second->m_ranges) {
+					if (asmrange.end < range.start || asmrange.start > range.end) continue;
+					spans.push_back(std::make_pair(asmrange, asmsection.second));
+				}
+			}
+			
+			// for each record in the range
+			DWORD nbbytes;
+			for (DWORD dumpaddress = range.start ; dumpaddress <= range.end ; dumpaddress += nbbytes) {
 				
-				// prepare up to <m_hexbytes>
-				nbbytes = m_hexbytes;
-				if (dumpaddress + m_hexbytes - 1 > range.end) {
+				// prepare up to <step> bytes, never across a 64 KB boundary
+				nbbytes = step;
+				if (nbbytes - 1 > range.end - dumpaddress) {
 					nbbytes = range.end - dumpaddress + 1;
 				}
-				// get the assembled section it comes from
-				asmsection = FindSection(dumpaddress, dumpaddress + nbbytes - 1);
+				DWORD boundary = 0x10000 - (dumpaddress & 0xFFFF);
+				if (nbbytes > boundary) {
+					nbbytes = boundary;
+				}
+				// get the assembled section it comes from, the first one containing the whole record as FindSection()
+				// does, else the first one containing its first address and the record stops at the end of this one
+				Section* asmsection = nullptr;
+				DWORD last = dumpaddress + nbbytes - 1;
+				for (auto& span: spans) {
+					if (span.first.start <= dumpaddress && last <= span.first.end) {
+						asmsection = span.second;
+						break;
+					}
+				}
+				for (size_t i = 0 ; !asmsection && i < spans.size() ; i++) {
+					if (spans[i].first.start <= dumpaddress && dumpaddress <= spans[i].first.end) {
+						asmsection = spans[i].second;
+						nbbytes = spans[i].first.end - dumpaddress + 1;
+					}
+				}
 				if (!asmsection) {
 					// This can NOT happen!
 					msg.Error(errorMUZNoSection, codeline);
@@ -600,27 +851,139 @@ namespace MUZ {
 					continue;
 				}
 				// code comes from a code or saved-data section
-				line = ":";
-				line = line + data_to_hex((DATATYPE)(DATAMASK & nbbytes)) + address_to_base(dumpaddress, 16, 4) + "00"; // nbbytes, address, record type
-				DWORD sum = nbbytes + (dumpaddress >> 8) + (dumpaddress & 0xFF); // start control sum with bytes after ':'
-				for (DWORD address = dumpaddress ; address < dumpaddress + nbbytes ; address += 1) {
-					line = line + data_to_hex(memory[address]);
-					sum = sum + memory[address];
+				if ((dumpaddress >> 16) != upper) {
+					upper = dumpaddress >> 16;
+					DATATYPE extended[2] = { (DATATYPE)(upper >> 8), (DATATYPE)(upper & 0xFF) };
+					out = putHexRecord(out, 2, 0, 4, extended);
+				}
+				out = putHexRecord(out, nbbytes, dumpaddress & 0xFFFF, 0, memory + dumpaddress);
+				if (out > limit) {
+					fwrite(buffer.data(), 1, (size_t)(out - buffer.data()), hexfile);
+					out = buffer.data();
 				}
-				// compute 2's complement and keep LSB
-				sum = ((~sum) + 1) & 0xFF;
-				line = line + data_to_hex((DATATYPE)(DATAMASK & sum));
-				// write this line
-				fprintf(hexfile, "%s\n", line.c_str());
 			} // next dumpaddress
 		} // next zone
 		// write end record
-		fprintf(hexfile, "%s\n", ":00000001FF");
+		out = putHexRecord(out, 0, 0, 1, nullptr);
+		fwrite(buffer.data(), 1, (size_t)(out - buffer.data()), hexfile);
 		fclose(hexfile);
 	}
 
-	/** Generate in-memory listing from current assembling. */
-	void Assembler::GenerateFileListing(size_t file, ErrorList& msg, Listing & listing)
+	/** Generate raw binary output.
+	 The written address ranges coming from saved sections are copied from the memory image with one write for each
+	 contiguous range. The gaps between them are filled with the m_binfill value, so each file is the image of the
+	 memory from its lowest to its highest saved address. When m_binsections is set, each saved section goes in its own
+	 file named after the binary filename and the section, e.g. "ROM-CODE@BANK1.bin" for "ROM.bin".
+	 */
+	void Assembler::GenerateBinary(DATATYPE* memory, Section& section, ErrorList& msg)
+	{
+		m_binfiles.clear();
+		if (m_binfilename.empty()) return;
+		
+		// file name parts for the sections files
+		string stem = m_binfilename;
+		string extension;
+		size_t dot = m_binfilename.rfind('.');
+		if (dot != string::npos && m_binfilename.find_first_of("/\\", dot) == string::npos) {
+			stem = m_binfilename.substr(0, dot);
+			extension = m_binfilename.substr(dot);
+		}
+		
+		// written parts of the saved sections
+		std::vector<AddressRange> image;
+		for (auto& asmsection: m_sections) {
+			if ( ! asmsection.second->save() ) continue;
+			std::vector<AddressRange> ranges;
+			for (auto& asmrange: asmsection.second->m_ranges) {
+				for (auto& range: section.m_ranges) {
+					AddressRange part;
+					part.start = std::max(asmrange.start, range.start);
+					part.end = std::min(asmrange.end, range.end);
+					if (part.start <= part.end) ranges.push_back(part);
+				}
+			}
+			if (ranges.empty()) continue;
+			if (m_binsections) {
+				WriteBinaryImage(stem + "-" + asmsection.first + extension, memory, ranges, msg);
+			} else {
+				image.insert(image.end(), ranges.begin(), ranges.end());
+			}
+		}
+		if ( ! m_binsections ) {
+			WriteBinaryImage(m_binfilename, memory, image, msg);
+		}
+	}
+	
+	/** Writes address ranges in a binary file, filling the gaps between them with m_binfill. The ranges are sorted
+	 and the overlapping or adjacent ones are merged before writing. */
+	void Assembler::WriteBinaryImage(std::string name, DATATYPE* memory, std::vector<AddressRange>& ranges, ErrorList& msg)
+	{
+		CodeLine codeline;
+		FILE* binfile = nullptr;
+		if ( ! m_outputdir.empty() ) {
+			string filename = m_outputdir + NORMAL_DIR_SEPARATOR + name;
+			binfile = fopen(filename.c_str(), "wb");
+		}
+		if (binfile == nullptr) {
+			msg.AboutFile(errorWritingListing, codeline, name);
+			return;
+		}
+		std::sort(ranges.begin(), ranges.end(), []( AddressRange const& a, AddressRange const& b) {
+			return a.start < b.start;
+		});
+		std::vector<DATATYPE> gap;
+		DWORD next = ranges.empty() ? 0 : ranges.front().start;
+		for (size_t i = 0 ; i < ranges.size() ; ) {
+			// merge the following ranges which overlap or touch this one
+			DWORD start = std::max(ranges[i].start, next);
+			DWORD end = ranges[i].end;
+			for (i += 1 ; i < ranges.size() && ranges[i].start <= end + 1 ; i++) {
+				end = std::max(end, ranges[i].end);
+			}
+			if (end < start) continue;
+			// fill the gap from the previous range
+			if (start > next) {
+				gap.assign(start - next, m_binfill);
+				fwrite(gap.data(), sizeof(DATATYPE), gap.size(), binfile);
+			}
+			fwrite(memory + start, sizeof(DATATYPE), end - start + 1, binfile);
+			next = end + 1;
+		}
+		fclose(binfile);
+		m_binfiles.push_back(name);
+	}
+
+	/** Generate the binary debug information file, see DebugInfo.h for its format. The files are given with
+	 their assembly numbers, the lines are the assembled lines with code, the symbols are the global labels and the
+	 .EQU symbols. */
+	void Assembler::GenerateDebugInfo(ErrorList& msg)
+	{
+		if (m_debugfilename.empty()) return;
+		DebugInfoWriter writer;
+		for (auto & sourcefile : m_files) {
+			DWORD flags = 0;
+			if (sourcefile->included) flags |= debugFileINCLUDED;
+			if (sourcefile->expansion) flags |= debugFileEXPANSION;
+			writer.AddFile(sourcefile->Path(), sourcefile->included ? sourcefile->parentfile : (size_t)-1, sourcefile->parentline, flags);
+			for (auto & codeline : sourcefile->lines) {
+				if ((codeline.assembled != errorTypeOK) || (codeline.Size() == 0) || (codeline.includefile > codeline.file)) continue;
+				writer.AddLine(codeline.address, codeline.Size(), codeline.file, codeline.line, codeline.statesmin, codeline.statesmax);
+			}
+		}
+		for (SYMBOLID id = 1 ; id < labels.end() ; id++) {
+			Label* label = labels.Get(id);
+			if (label && !label->empty()) {
+				writer.AddSymbol(m_symbolnames.Name(id), label->addresses[0], label->equate ? debugSymbolEQUATE : debugSymbolLABEL, label->File(), label->Line());
+			}
+		}
+		if (m_outputdir.empty() || !writer.Save(m_outputdir + NORMAL_DIR_SEPARATOR + m_debugfilename)) {
+			CodeLine codeline;
+			msg.AboutFile(errorWritingListing, codeline, m_debugfilename);
+		}
+	}
+
+	/** Generate the listing lines of a file and its included files from current assembling. */
+	void Assembler::GenerateFileListing(size_t file, ErrorList& msg, ListingSink & listing)
 	{
 		// get shortcut to the file to list
 		if (file < 0 || file >= m_files.size()) return;
@@ -632,7 +995,7 @@ namespace MUZ {
 		// add the file path to listing
 		fileline.parts.file = -1;
 		fileline.file = file;
-		listing.push_back(fileline);
+		listing.Add(fileline);
 
 		// List all lines and included files
 		for (auto & codeline : sourcefile->lines) {
@@ -644,9 +1007,56 @@ namespace MUZ {
 			if (codeline.includefile > codeline.file) {
 				GenerateFileListing(codeline.includefile, msg, listing);
 				// list current parent file to show that include if finished
-				listing.push_back(fileline);
+				listing.Add(fileline);
+			}
+		}
+	}
+
+	/** Returns the number of listing lines generated for a codeline by GenerateCodeLineListing(). */
+	size_t Assembler::CountCodeLineListing(const CodeLine& codeline)
+	{
+		size_t rows = 0;
+		if (codeline.listing) {
+			rows = 1;
+			if (codeline.assembled == errorTypeOK) {
+				size_t codesize = codeline.Size();
+				if (codesize >= 5 && codesize <= 8) {
+					rows += 1;
+				} else if (codesize >= 9) {
+					rows += m_status.allcodelisting ? (codesize - 1) / 4 : 1;
+				}
 			}
 		}
+		if (codeline.message >= 0) rows += 1;
+		return rows;
+	}
+	
+	/** Builds the listing rows index of a file if it is not built yet. Row 0 is the file path, the listing lines
+	 of each codeline follow in order. The included files are listed under their own file number. */
+	void Assembler::IndexListing(SourceFile* sourcefile, ErrorList& msg)
+	{
+		std::vector<size_t>& rows = sourcefile->listingrows;
+		if (!rows.empty()) return;
+		
+		// cross reference log messages to codelines
+		msg.Close(*this);
+		
+		rows.reserve(sourcefile->lines.size() + 2);
+		rows.push_back(0);
+		size_t total = 1;
+		for (auto & codeline : sourcefile->lines) {
+			rows.push_back(total);
+			total += CountCodeLineListing(codeline);
+		}
+		rows.push_back(total);
+	}
+	
+	/** Forgets the listing rows index of all the files, the listing of the lines has changed. */
+	void Assembler::ClearListingIndex()
+	{
+		for (auto & sourcefile : m_files) {
+			sourcefile->listingrows.clear();
+		}
 	}
 
 	/** Generates the sections list in an opened file. */
@@ -684,8 +1094,9 @@ namespace MUZ {
 			fprintf(file, "%s", s.c_str());
 			if (m_status.trace) printf("%s", s.c_str());
 			std::map<string,DefSymbol*> sortedSymbols;
-			for (auto symbol: m_defsymbols) {
-				sortedSymbols[symbol.first] = symbol.second;
+			for (SYMBOLID id = 1 ; id < m_defsymbols.end() ; id++) {
+				DefSymbol* symbol = m_defsymbols.Get(id);
+				if (symbol) sortedSymbols[m_symbolnames.Name(id)] = symbol;
 			}
 			for (auto defsymbol: sortedSymbols) {
 				string sleft;
@@ -708,8 +1119,9 @@ namespace MUZ {
 			fprintf(file, "%s", s.c_str());
 			if (m_status.trace) printf("%s", s.c_str());
 			std::map<string, DefSymbol*> sortedSymbols;
-			for (auto symbol: m_reqsymbols) {
-				sortedSymbols[symbol.first] = symbol.second;
+			for (SYMBOLID id = 1 ; id < m_reqsymbols.end() ; id++) {
+				DefSymbol* symbol = m_reqsymbols.Get(id);
+				if (symbol) sortedSymbols[m_symbolnames.Name(id)] = symbol;
 			}
 			for (auto reqsymbol: sortedSymbols) {
 				string sleft;
@@ -728,9 +1140,10 @@ namespace MUZ {
 	{
 		// build sorted map of equates
 		std::map<string,Label*> sortedEquates;		// map, ordered by name
-		for (auto label: labels) {
-			if ( label.second->equate) {
-				sortedEquates[label.first] = label.second;
+		for (SYMBOLID id = 1 ; id < labels.end() ; id++) {
+			Label* label = labels.Get(id);
+			if (label && label->equate) {
+				sortedEquates[m_symbolnames.Name(id)] = label;
 			}
 		}
 
@@ -751,16 +1164,68 @@ namespace MUZ {
 		}
 	}
 
+	/** Generates the list of the jumps changed by the .RELAX mode in an opened file, with the bytes and T-states saved. */
+	void Assembler::GenerateRelaxedJumpsList( FILE* file )
+	{
+		std::string summary = RelaxedJumpsSummary();
+		if (summary.empty()) return;
+		std::string s = "\nRelaxed jumps:\n------------------------------------------------------------------------------------\n";
+		fprintf(file, "%s", s.c_str());
+		if (m_status.trace) printf("%s", s.c_str());
+		for (size_t f = 0 ; f < m_files.size() ; f++) {
+			for (auto & codeline : m_files[f]->lines) {
+				if (codeline.jump.bytes == 0) continue;
+				string sleft = m_files[f]->filename + "(" + std::to_string(codeline.line) + ")";
+				sleft = sleft.substr(0,29);
+				sleft += spaces(30 - (int)sleft.length());
+				sleft += " :" + address_to_base(codeline.address, 16, 4);
+				sleft += (codeline.jump.form == jumpformSHORT) ? "  JR  " : "  JP  ";
+				string source = codeline.source;
+				strtrimright(source);
+				size_t start = source.find_first_not_of(" \t");
+				if (start == string::npos) start = 0;
+				s = string("\t") + sleft + source.substr(start, 40) + "\n";
+				fprintf(file, "%s", s.c_str());
+				if (m_status.trace) printf("%s", s.c_str());
+			}
+		}
+		s = string("\t") + summary + "\n";
+		fprintf(file, "%s", s.c_str());
+		if (m_status.trace) printf("%s", s.c_str());
+	}
+
+	/** Text of the bytes and T-states saved by the .RELAX mode, empty if no jump has been changed. The T-states are
+	 given for the conditions not met then met, a JR is shorter than a JP but slower when it jumps. */
+	std::string Assembler::RelaxedJumpsSummary()
+	{
+		int shortened = 0, lengthened = 0, bytes = 0, statesmin = 0, statesmax = 0;
+		for (auto & sourcefile : m_files) {
+			for (auto & codeline : sourcefile->lines) {
+				if (codeline.jump.bytes > 0) shortened += 1;
+				if (codeline.jump.bytes < 0) lengthened += 1;
+				bytes += codeline.jump.bytes;
+				statesmin += codeline.jump.statesmin;
+				statesmax += codeline.jump.statesmax;
+			}
+		}
+		if (shortened + lengthened == 0) return "";
+		char summary[160];
+		snprintf(summary, sizeof(summary), "%d jumps shortened, %d lengthened: %d bytes saved, %d/%d T-states saved",
+				 shortened, lengthened, bytes, statesmin, statesmax);
+		return summary;
+	}
+
 	/** Generates the labels list in an opened file. */
 	void Assembler::GenerateLabelsList( FILE* file )
 	{
 		// build sorted maps of labels
 		std::map<string,ADDRESSTYPE> nameSortedLabels;	//map ordered by name
 		std::map<ADDRESSTYPE, string> addressSortedLabels;	// map ordered by address
-		for (auto label: labels) {
-			if ( ! label.second->equate) {
-				nameSortedLabels[label.first] = (ADDRESSTYPE)label.second->addresses[0];
-				addressSortedLabels[(ADDRESSTYPE)label.second->addresses[0]] = label.first;
+		for (SYMBOLID id = 1 ; id < labels.end() ; id++) {
+			Label* label = labels.Get(id);
+			if (label && ! label->equate) {
+				nameSortedLabels[m_symbolnames.Name(id)] = (ADDRESSTYPE)label->addresses[0];
+				addressSortedLabels[(ADDRESSTYPE)label->addresses[0]] = m_symbolnames.Name(id);
 			}
 		}
 		// list global labels sorted by value then name
@@ -806,6 +1271,7 @@ namespace MUZ {
 		GenerateReqSymbolsList( file );
 		GenerateEquatesList( file );
 		GenerateLabelsList( file );
+		GenerateRelaxedJumpsList( file );
 	}
 
 
@@ -818,14 +1284,12 @@ namespace MUZ {
 			// #include lines will recursively call this function
 			if (codeline.includefile > codeline.file) {
 				FillFromFile(codeline.includefile, memory, section, msg);
-			} else if (codeline.code.size() > 0) {
-				// copy this line code in memory image
+			} else if (codeline.Size() > 0) {
+				// copy this line code and reserved space in memory image
 				DWORD address = codeline.address;
-				for (auto c: codeline.code) {
-					memory[address] = c;
-					section.SetAddress(address);
-					address += 1;
-				}
+				std::copy(codeline.code.begin(), codeline.code.end(), memory + address);
+				std::fill_n(memory + address + codeline.code.size(), codeline.fillsize, codeline.fillvalue);
+				section.SetRange(address, address + codeline.Size() - 1);
 			}
 		}
 
@@ -878,7 +1342,7 @@ namespace MUZ {
 				if (m.type == MUZ::errorTypeWARNING) {
 					CodeLine* codeline = GetCodeLine(m.file, m.line);
 					if (m.token >= 0 && m.token < codeline->tokens.size()) {
-						fprintf(logfile, "\t%5d: W%04d: '%s': %s\n", (int)m.line, m.kind, codeline->tokens[m.token].source.c_str(), msg.GetMessage(m.kind).c_str());
+						fprintf(logfile, "\t%5d: W%04d: '%s': %s\n", (int)m.line, m.kind, codeline->tokens[m.token].asString().c_str(), msg.GetMessage(m.kind).c_str());
 					} else {
 						fprintf(logfile, "\t%5d: W%04d: %s\n", (int)m.line, m.kind, msg.GetMessage(m.kind).c_str());
 					}
@@ -900,13 +1364,20 @@ namespace MUZ {
 				if (m.type == MUZ::errorTypeFATAL) prefix = "(FATAL) ";
 				CodeLine* codeline = GetCodeLine(m.file, m.line);
 				if (m.token >= 0 && m.token < codeline->tokens.size()) {
-					fprintf(logfile, "\t%5d: E%04d: '%s': %s\n", (int)m.line, m.kind, codeline->tokens[m.token].source.c_str(), (prefix + msg.GetMessage(m.kind)).c_str());
+					fprintf(logfile, "\t%5d: E%04d: '%s': %s\n", (int)m.line, m.kind, codeline->tokens[m.token].asString().c_str(), (prefix + msg.GetMessage(m.kind)).c_str());
 				} else {
 					fprintf(logfile, "\t%5d: E%04d: %s\n", (int)m.line, m.kind, (prefix + msg.GetMessage(m.kind)).c_str());
 				}
 				if (m_status.trace) printf("%s(%d): %s\n", GetFileName(m.file).c_str(), (int)m.line, (prefix + msg.GetMessage(m.kind)).c_str());
 			}
 		}
+		
+		// jumps changed by .RELAX
+		std::string relaxed = RelaxedJumpsSummary();
+		if (!relaxed.empty()) {
+			fprintf(logfile, "Relaxed jumps: %s\n", relaxed.c_str());
+			if (m_status.trace) printf("Relaxed jumps: %s\n", relaxed.c_str());
+		}
 		fclose(logfile);
 	}
 
@@ -943,9 +1414,13 @@ namespace MUZ {
 		if (nbtokens == 1) {
 			if (tokenType == tokenTypeLETTERS) {
 				// <directive> ? (ex: .CODE)
-				if (GetDirective(labelName)) return nullptr;
+				if (GetDirective(codeline.tokens[0].keyword)) return nullptr;
 				// <instruction> ? (ex: RET)
-				if (GetInstruction(labelName)) return nullptr;
+				if (GetInstruction(codeline.tokens[0].keyword)) return nullptr;
+				// <macro> ?
+				if (IsMacro(codeline, codeline.tokens[0])) return nullptr;
+				// before the instruction set is chosen, pass 1 takes an instruction alone for a label
+				if (IsFirstPass() && m_instructions.empty() && (codeline.tokens[0].keyword >= 0)) m_passtwo = true;
 				// set as last global label name if not local and create label
 				SetLastLabelName(labelName) ;
 				return CreateLabel(labelName, codeline, msg);
@@ -968,6 +1443,8 @@ namespace MUZ {
 				}
 				return CreateLabel(labelName, codeline, msg);
 			}
+			// <macro> <arguments> ?
+			if (IsMacro(codeline, codeline.tokens[0])) return nullptr;
 			// <letters> <directive> ?
 			if (GetDirective(codeline.tokens[1].source)) {
 				// store as last global label unless it is an .EQU or local label
@@ -982,22 +1459,30 @@ namespace MUZ {
 				SetLastLabelName(labelName) ;
 				return CreateLabel(labelName, codeline, msg);
 			}
+			// <letters> <macro> ?
+			if (!GetInstruction(codeline.tokens[0].keyword) && IsMacro(codeline, codeline.tokens[1])) {
+				SetLastLabelName(labelName) ;
+				return CreateLabel(labelName, codeline, msg);
+			}
 		}
 		return nullptr;
 	}
 
-	/** Create a label at current address. If the label name starts with a '@', a local label is created for current file and is prefixed with the last
-	 global label name, else the label is global. */
+	/** Create a label at current address. If the label name starts with a '@', a local label is created for current file in the scope of the last
+	 global label, else the label is global. */
 	Label* Assembler::CreateLabel(std::string name, CodeLine& codeline, ErrorList& msg)
 	{
 		if (name.empty()) return nullptr;
-		Label* label = GetLabel(name);
+		SYMBOLID id = InternSymbol(name);
+		Label* label = GetLabel(id);
 		// Existing label?
 		if (label) {
 			// Different line?
 			if (! label->isAt(codeline.file, codeline.line)) {
 				// Signal a warning, only for pass 2
 				msg.Warning(errorLabelExists, codeline, 2);
+				// the pass 2 gives the warning for the previous lines with this label
+				if (IsFirstPass()) m_passtwo = true;
 			}
 			// Set new file and line, only on pass 1
 			if (codeline.as->IsFirstPass()) {
@@ -1011,12 +1496,11 @@ namespace MUZ {
 		if (!label) throw OutOfMemoryException();
 		if (name[0] == '@') {
 			// Local label in current file
-			string fullname = GetLastLabelName() + name;
-			m_files[m_status.curfile]->labels[fullname] = label;
+			m_files[m_status.curfile]->labels[m_status.lastlabel].Set(id, label);
 			label->multiple = true;
 		} else {
 			// Global label
-			labels[name] = label;
+			labels.Set(id, label);
 			label->multiple = false;
 		}
 		label->SetFileLine(codeline.file, codeline.line);
@@ -1027,13 +1511,13 @@ namespace MUZ {
 	void Assembler::SetLastLabelName(std::string name)
 	{
 		if (name.length() > 0 && name[0] != '@')
-			m_status.lastlabel = name;
+			m_status.lastlabel = InternSymbol(name);
 	}
 	
 	/** Returns the last global label name. */
 	std::string Assembler::GetLastLabelName(void)
 	{
-		return m_status.lastlabel;
+		return m_symbolnames.Name(m_status.lastlabel);
 	}
 	
 	//MARK: - Private Conditionnal Parsing modes
@@ -1128,12 +1612,20 @@ namespace MUZ {
 			delete section.second;
 		}
 		m_status.cursection = nullptr;
+		m_status.relax = false;
+		m_passtwo = !m_status.fixups;
+		m_testedsymbols.clear();
+		ClearRecording();
+		m_expansiondepth = 0;
 		
 		size_t filenum = m_files.size();
-		BYTE* buffer = nullptr;
-		int linesize = 0;
 		Label* lastLabel = nullptr;
-		FILE* f = nullptr;
+		std::vector<CodeLine> storedlines;
+		bool stored = false;
+		bool cached = false;
+		bool splitting = false;
+		LineSplitter splitter;
+		size_t nblines = 0;
 		// Prepare the path and name for file
 		SourceFile* sourcefile = new SourceFile;
 		if (sourcefile == nullptr) throw MUZ::OutOfMemoryException();
@@ -1141,22 +1633,24 @@ namespace MUZ {
 			goto FatalNonOpening;
 		}
 		
-		// try to open the source file
+		// try to open the source file, or take its lines from the previous assembly
 		file = sourcefile->fileprefix + sourcefile->filepath + NORMAL_DIR_SEPARATOR + sourcefile->filename;
-		f = fopen(file.c_str(), "r");
-		if (!f) {
+		stored = TakeStoredLines(filenum, file, storedlines);
+		if (!stored && !sourcefile->text.Open(file)) {
 			goto FatalNonOpening;
 		}
+		cached = !stored && m_lexcache->Load(sourcefile->text, *this, storedlines);
+		nblines = stored ? storedlines.size() : sourcefile->text.LineCount();
+		splitting = !stored && !cached && LineSplitter::Worthwhile(nblines);
+		if (splitting) splitter.Start(sourcefile->text, *this);
 		
 		// Store this file definition
 		m_files.push_back(sourcefile);
 		m_status.curfile = filenum;
+		sourcefile->lines.reserve(nblines);
 		
 		// now explore the file line by line (until .END directive at most)
-		while (fgetline(&buffer, &linesize, f) && (! m_status.finished)) {
-			
-			// debug
-			if (m_status.trace) printf("%04X: [%4d] %s\n", GetAddress(),(int)sourcefile->lines.size()  + 1, buffer);
+		for (size_t line = 0 ; line < nblines && (! m_status.finished) ; line++) {
 			
 			// prepare the codeline to assemble
 			CodeLine cl;
@@ -1167,13 +1661,27 @@ namespace MUZ {
 			cl.file = filenum;
 			//cl.offset = offset;
 			//cl.size = linesize;
-			cl.source = string((char*)buffer);
+			if (splitting) {
+				splitter.Take(cl, *this);
+			} else {
+				if (stored || cached) {
+					cl.TakeSource(storedlines[line]);
+				}
+				if (!stored) {
+					cl.source.assign(sourcefile->text.LineStart(line), sourcefile->text.LineLength(line));
+				}
+			}
 			cl.line = sourcefile->lines.size()  + 1;
+			
+			// debug
+			if (m_status.trace) printf("%04X: [%4d] %s\n", GetAddress(), (int)cl.line, cl.source.c_str());
+			
 			cl.label = lastLabel;	// send previous label so a possible .EQU directive will change its value
 			cl.listing = m_status.listing; // enable or disable listing
 			// Assemble this line, will include another file if #INCLUDE is met
 			cl.as = this;
 			cl.assembled = AssembleCodeLine(cl, msg);
+			CheckFixup(cl, lastLabel);
 			if (cl.assembled == errorTypeOK) {
 				cl.address = GetAddress();// useless?
 				cl.section = GetSection();
@@ -1183,18 +1691,31 @@ namespace MUZ {
 			sourcefile->lines.push_back(cl);
 			// Exit if fatal error
 			if (cl.assembled == errorTypeFATAL) {
-				fclose(f);
-				free(buffer);
 				return errorTypeFATAL;
 			}
-			// update current address and file position
-			//offset = ftell(f);
-			AdvanceAddress((ADDRESSTYPE)cl.code.size());
+			// update current address
+			AdvanceAddress((ADDRESSTYPE)cl.Size());
+		}
+		// keep the lines after .END
+		for (size_t line = sourcefile->lines.size() ; line < nblines ; line++) {
+			sourcefile->unread.emplace_back();
+			if (stored || cached) {
+				sourcefile->unread.back().TakeSource(storedlines[line]);
+			}
+			if (!stored) {
+				sourcefile->unread.back().source.assign(sourcefile->text.LineStart(line), sourcefile->text.LineLength(line));
+			}
+		}
+		// keep the split tokens for the next assemblies
+		if (!stored && !cached) {
+			m_lexcache->Save(sourcefile->text, sourcefile->lines, sourcefile->unread);
+		}
+		// a block left open has taken all the following lines
+		if (m_recording.active) {
+			CodeLine* opening = GetCodeLine(m_recording.file, m_recording.line);
+			if (opening) msg.Error(errorMacroNotClosed, *opening);
+			ClearRecording();
 		}
-		
-		// close main source and release IO buffer
-		fclose(f);
-		free(buffer);
 
 		return errorTypeOK;
 
@@ -1206,6 +1727,21 @@ namespace MUZ {
 
 	ErrorType Assembler::AssembleMainFilePassTwo(string file, ErrorList& msg)
 	{
+		// assemble only the fixup lines if pass 1 has not asked for the whole pass 2
+		if (!m_passtwo) {
+			ADDRESSTYPE address = GetAddress();
+			Section* section = m_status.cursection;
+			size_t curfile = m_status.curfile;
+			SYMBOLID lastlabel = m_status.lastlabel;
+			bool relax = m_status.relax;
+			bool fixed = FixupLines(msg);
+			m_status.cursection = section;
+			if (section) section->SetOrg(address);
+			m_status.curfile = curfile;
+			m_status.lastlabel = lastlabel;
+			m_status.relax = relax;
+			if (fixed) return errorTypeOK;
+		}
 		
 		// reset sections
 		for (auto & section: m_sections) {
@@ -1213,6 +1749,8 @@ namespace MUZ {
 		}
 		m_status.cursection = nullptr;
 		m_status.finished = false;
+		m_status.relax = false;
+		ClearRecording();
 
 		// Execute pass 2
 		CodeLine codeline;
@@ -1236,31 +1774,33 @@ namespace MUZ {
 			return msg.Fatal(errorOpeningSource, codeline, file);
 		}
 		
-		// try to open the source file
+		// try to open the source file, or take its lines from the previous assembly
+		size_t filenum = m_files.size();
 		file = sourcefile->fileprefix + sourcefile->filepath + NORMAL_DIR_SEPARATOR + sourcefile->filename;
-		FILE* f = fopen(file.c_str(), "r");
-		if (!f) {
+		std::vector<CodeLine> storedlines;
+		bool stored = TakeStoredLines(filenum, file, storedlines);
+		if (!stored && !sourcefile->text.Open(file)) {
 			delete sourcefile;
 			return msg.Fatal(errorOpeningSource, codeline, file);
 		}
+		bool cached = !stored && m_lexcache->Load(sourcefile->text, *this, storedlines);
+		size_t nblines = stored ? storedlines.size() : sourcefile->text.LineCount();
+		bool splitting = !stored && !cached && LineSplitter::Worthwhile(nblines);
+		LineSplitter splitter;
+		if (splitting) splitter.Start(sourcefile->text, *this);
 		
 		// Store this file definition
-		size_t filenum = m_files.size();
 		m_files.push_back(sourcefile);
 		m_status.curfile = filenum;
 		
 		sourcefile->parentfile = codeline.file;
 		sourcefile->parentline = codeline.line;
 		sourcefile->included = (sourcefile->parentfile >= 0);
+		sourcefile->lines.reserve(nblines);
 		
 		// now explore the file line by line
-		BYTE* buffer = nullptr;
-		int linesize = 0;
-			Label* lastLabel = nullptr;
-		while (fgetline(&buffer, &linesize, f) && (! m_status.finished)) {
-			
-			// debug
-			if (m_status.trace) printf("%04X: [%4d] %s\n", GetAddress(),(int)sourcefile->lines.size()  + 1, buffer);
+		Label* lastLabel = nullptr;
+		for (size_t line = 0 ; line < nblines && (! m_status.finished) ; line++) {
 			
 			// prepare the codeline to assemble
 			CodeLine cl;
@@ -1268,12 +1808,26 @@ namespace MUZ {
 			cl.section = GetSection();
 			cl.assembled = errorTypeFALSE;
 			cl.file = filenum;
-			cl.source = string((char*)buffer);
+			if (splitting) {
+				splitter.Take(cl, *this);
+			} else {
+				if (stored || cached) {
+					cl.TakeSource(storedlines[line]);
+				}
+				if (!stored) {
+					cl.source.assign(sourcefile->text.LineStart(line), sourcefile->text.LineLength(line));
+				}
+			}
 			cl.line = sourcefile->lines.size() + 1;
+			
+			// debug
+			if (m_status.trace) printf("%04X: [%4d] %s\n", GetAddress(), (int)cl.line, cl.source.c_str());
+			
 			cl.label = lastLabel;	// send previous label so a possible .EQU directive will change its value
 			// Assemble this line, will include another file if #INCLUDE is met
 			cl.as = this;
 			cl.assembled = AssembleCodeLine(cl, msg);
+			CheckFixup(cl, lastLabel);
 			if (cl.assembled == errorTypeOK) {
 				cl.address = GetAddress();// act up possible ORG
 				cl.section = GetSection();
@@ -1283,17 +1837,25 @@ namespace MUZ {
 			sourcefile->lines.push_back(cl);
 			// Exit if fatal error
 			if (cl.assembled == errorTypeFATAL) {
-				fclose(f);
-				free(buffer);
 				return errorTypeFATAL;
 			}
 			// update current address
-			AdvanceAddress((ADDRESSTYPE)cl.code.size());
+			AdvanceAddress((ADDRESSTYPE)cl.Size());
+		}
+		// keep the lines after .END
+		for (size_t line = sourcefile->lines.size() ; line < nblines ; line++) {
+			sourcefile->unread.emplace_back();
+			if (stored || cached) {
+				sourcefile->unread.back().TakeSource(storedlines[line]);
+			}
+			if (!stored) {
+				sourcefile->unread.back().source.assign(sourcefile->text.LineStart(line), sourcefile->text.LineLength(line));
+			}
+		}
+		// keep the split tokens for the next assemblies
+		if (!stored && !cached) {
+			m_lexcache->Save(sourcefile->text, sourcefile->lines, sourcefile->unread);
 		}
-		
-		// close main source and release IO buffer
-		fclose(f);
-		free(buffer);
 		return errorTypeOK;
 	}
 	
@@ -1310,18 +1872,91 @@ namespace MUZ {
 		// now reassemble line by line
 		for (CodeLine& cl : sourcefile->lines) {
 			
-			cl.code.clear();
+			// data lines from HEX and binary files keep their code
+			if (cl.rawdata) {
+				cl.address = GetAddress();
+				cl.section = GetSection();
+				AdvanceAddress((ADDRESSTYPE)cl.Size());
+				continue;
+			}
+			cl.ResetCode();
 			cl.as = this;
 			cl.assembled = AssembleCodeLine(cl, msg);
 			if (cl.assembled == errorTypeOK) {
 				cl.address = GetAddress();
 				cl.section = GetSection();
 			}
-			AdvanceAddress((ADDRESSTYPE)cl.code.size()) ;
+			AdvanceAddress((ADDRESSTYPE)cl.Size()) ;
 		}
 		return errorTypeOK;
 	}
 	
+	/** Stores a line of data from an HEX or binary included file. The code is set from the data and the line is
+	 flagged as raw data so it is not parsed, its source is a .DB directive listing the bytes for the listing.
+	 @param sourcefile the source file for the included file
+	 @param filenum the reference of this file in the source files array
+	 @param data the bytes for this line
+	 @param nbbytes the number of bytes
+	 */
+	void Assembler::AddDataLine(SourceFile* sourcefile, size_t filenum, const DATATYPE* data, size_t nbbytes)
+	{
+		CodeLine cl;
+		cl.address = GetAddress();
+		cl.section = GetSection();
+		cl.assembled = errorTypeOK;
+		cl.rawdata = true;
+		cl.file = filenum;
+		cl.line = sourcefile->lines.size()  + 1;
+		cl.label = nullptr;
+		cl.as = this;
+		cl.code.assign(data, data + nbbytes);
+		cl.source.reserve(5 + nbbytes * 4);
+		cl.source = "\t.DB ";
+		for (size_t b = 0 ; b < nbbytes ; b++) {
+			cl.source += "$" + data_to_hex(data[b]) + ",";
+		}
+		// Store line and advance address to next position for code
+		sourcefile->lines.push_back(std::move(cl));
+		AdvanceAddress((ADDRESSTYPE)nbbytes);
+	}
+	
+	/** Takes the lines of a file from the previous assembly, when UpdateLines() assembles the files again. The
+	 file stored at the same index is taken if it has the same path, else the first stored file with this path.
+	 @param filenum the index of the file in this assembly
+	 @param path the full path of the file
+	 @param lines receives the stored lines, which keep their lexed tokens
+	 @return true if the file has been found in the stored files
+	 */
+	bool Assembler::TakeStoredLines(size_t filenum, const std::string& path, std::vector<CodeLine>& lines)
+	{
+		// a stored source file with this path, HEX and binary files are read again
+		auto matches = [&](size_t i) {
+			SourceFile* sourcefile = m_storedfiles[i];
+			if (!sourcefile || (sourcefile->Path() != path)) return false;
+			return sourcefile->lines.empty() || !sourcefile->lines[0].rawdata;
+		};
+		size_t found = m_storedfiles.size();
+		if ((filenum < m_storedfiles.size()) && matches(filenum)) {
+			found = filenum;
+		} else {
+			for (size_t i = 0 ; i < m_storedfiles.size() ; i++) {
+				if (matches(i)) {
+					found = i;
+					break;
+				}
+			}
+		}
+		if (found == m_storedfiles.size()) return false;
+		SourceFile* sourcefile = m_storedfiles[found];
+		lines = std::move(sourcefile->lines);
+		for (auto & cl : sourcefile->unread) {
+			lines.push_back(std::move(cl));
+		}
+		delete sourcefile;
+		m_storedfiles[found] = nullptr;
+		return true;
+	}
+	
 	/** Assembled an HEX included file.
 	 @param file the file path for the HEX file to include
 	 @param msg the list of message and warnings returned by the assembler
@@ -1346,8 +1981,7 @@ namespace MUZ {
 			
 			// try to open the source file
 			file = sourcefile->fileprefix + sourcefile->filepath + NORMAL_DIR_SEPARATOR + sourcefile->filename;
-			FILE* f = fopen(file.c_str(), "r");
-			if (!f) {
+			if (!sourcefile->text.Open(file)) {
 				delete sourcefile;
 				return msg.Fatal(errorOpeningSource, codeline, file);
 			}
@@ -1359,55 +1993,26 @@ namespace MUZ {
 			sourcefile->parentfile = codeline.file;
 			sourcefile->parentline = codeline.line;
 			sourcefile->included = (sourcefile->parentfile >= 0);
+			sourcefile->lines.reserve(sourcefile->text.LineCount());
 			
-			// now explore the file line by line
-			BYTE* buffer = nullptr;
-			int linesize = 0;
-			//long offset = ftell(f);
-			Label* lastLabel = nullptr;
-			BYTE* binbuffer = (BYTE*)calloc(1024,1);// should be suffficient, lines can only store 256 bytes definitions
-			while (fgetline(&buffer, &linesize, f)) {
+			// now explore the file record by record, each data record gives one line of data
+			DATATYPE binbuffer[256];// records can only store 255 bytes
+			string record;
+			for (size_t line = 0 ; line < sourcefile->text.LineCount() ; line++) {
 				
 				// debug
-				if (m_status.trace) printf("%04X: [%4d] %s\n", GetAddress(),(int)sourcefile->lines.size()  + 1, buffer);
-				// translate the hex line into .DB source line
-				MUZ::ADDRESSSIZETYPE nbbytes = hexNbBytes(buffer);
+				if (m_status.trace) printf("%04X: [%4d] %.*s\n", GetAddress(),(int)sourcefile->lines.size()  + 1, (int)sourcefile->text.LineLength(line), sourcefile->text.LineStart(line));
+				// decode the data record
+				record.assign(sourcefile->text.LineStart(line), sourcefile->text.LineLength(line));
+				MUZ::ADDRESSSIZETYPE nbbytes = hexNbBytes((const BYTE*)record.c_str());
 				if (nbbytes) {
-					hexStore(buffer, binbuffer);
-					string source="\t.DB ";
-					int b = 0;
-					for ( ; b < (int)nbbytes ; b++) {
-						source += "$" + data_to_hex(binbuffer[b]) + ",";
-					}
-
-					// prepare the codeline to assemble
-					CodeLine cl;
-					cl.address = GetAddress();
-					cl.section = GetSection();
-					cl.assembled = errorTypeFALSE;
-					cl.file = filenum;
-					cl.source = source;
-					cl.line = sourcefile->lines.size()  + 1;
-					cl.label = lastLabel;	// send previous label so a possible .EQU directive will change its value
-					// Assemble this line, will include another file if #INCLUDE is met
-					cl.as = this;
-					cl.assembled = AssembleCodeLine(cl, msg);
-					if (cl.assembled) {
-						cl.address = GetAddress();// useless?
-						cl.section = GetSection();
-						lastLabel = cl.label;
-					}
-					// Store assembly result
-					sourcefile->lines.push_back(cl);
-					// update current address and file position
-					AdvanceAddress((ADDRESSTYPE)cl.code.size());
+					hexStore((const BYTE*)record.c_str(), binbuffer);
+					AddDataLine(sourcefile, filenum, binbuffer, nbbytes);
 				}
 			}
 			
-			// close main source and release IO buffer
-			fclose(f);
-			free(buffer);
-			free(binbuffer);
+			// the records are not needed anymore
+			sourcefile->text.Close();
 		} else {
 			return AssembleIncludedFilePassTwo(file, codeline, msg);
 		}
@@ -1435,12 +2040,21 @@ namespace MUZ {
 			
 			// try to open the source file
 			file = sourcefile->fileprefix + sourcefile->filepath + NORMAL_DIR_SEPARATOR + sourcefile->filename;
-			FILE* f = fopen(file.c_str(), "r");
+			FILE* f = fopen(file.c_str(), "rb");
 			if (!f) {
 				delete sourcefile;
 				return msg.Fatal(errorOpeningSource, codeline, file);
 			}
 			
+			// read the whole file at once
+			std::vector<BYTE> data;
+			BYTE block[4096];
+			size_t nbread;
+			while ((nbread = fread(block, 1, sizeof(block), f)) > 0) {
+				data.insert(data.end(), block, block + nbread);
+			}
+			fclose(f);
+			
 			// Store this file definition
 			size_t filenum = m_files.size();
 			m_files.push_back(sourcefile);
@@ -1449,92 +2063,517 @@ namespace MUZ {
 			sourcefile->parentline = codeline.line;
 			sourcefile->included = (sourcefile->parentfile >= 0);
 			
-			// now explore the file up to 16 bytes at a time
-			BYTE* binbuffer = (BYTE*)calloc(16,1);
-			int nbbytes = (int)fread(binbuffer, 1, 16, f);
-			while (nbbytes > 0)   {
-				
-				// translate the bytes into .DB source line
-				string source="\t.DB ";
-				int b = 0;
-				for ( ; b < nbbytes ; b++) {
-					source += "$" + data_to_hex(binbuffer[b]) + ",";
-				}
-				
-				// prepare the codeline to assemble
-				CodeLine cl;
-				cl.address = GetAddress();
-				cl.section = GetSection();
-				cl.assembled = errorTypeFALSE;
-				cl.file = filenum;
-				//cl.offset = ftell(f);;
-				//cl.size = nbbytes;
-				cl.source = source;
-				cl.line = sourcefile->lines.size()  + 1;
-				cl.label = nullptr;
-				// Assemble this line, will include another file if #INCLUDE is met
-				cl.as = this;
-				cl.assembled = AssembleCodeLine(cl, msg);
-				if (cl.assembled) {
-					cl.address = GetAddress();// useless?
-					cl.section = GetSection();
-				}
-				// Store assembly result
-				sourcefile->lines.push_back(cl);
-				// mark section and advance address to next position for code
-				AdvanceAddress((ADDRESSTYPE)cl.code.size());
-				// advance in binary file
-				nbbytes = (int)fread(binbuffer, 1, 16, f);
+			// store the data 16 bytes per line
+			sourcefile->lines.reserve((data.size() + 15) / 16);
+			DATATYPE binbuffer[16];
+			for (size_t offset = 0 ; offset < data.size() ; offset += 16) {
+				size_t nbbytes = std::min<size_t>(16, data.size() - offset);
+				std::copy(data.begin() + offset, data.begin() + offset + nbbytes, binbuffer);
+				AddDataLine(sourcefile, filenum, binbuffer, nbbytes);
 			}
-			
-			// close main source and release IO buffer
-			fclose(f);
-			free(binbuffer);
 		} else {
 			return AssembleIncludedFilePassTwo(file, codeline, msg);
 		}
 		return errorTypeOK;
 	}
 	
-	//MARK: - PUBLIC API
+	//MARK: - Private incremental assembling
 	
-	//MARK: - Constructor and destructor
+	/** Tells if an assembled line can be assembled again alone: it has been assembled, it has no label and its only
+	 directives store data, so it does not change any symbol, address or conditionnal mode.
+	 */
+	bool Assembler::IsLocalLine(const CodeLine& codeline)
+	{
+		if (!codeline.lexed || (codeline.assembled == errorTypeFALSE) || (codeline.assembled == errorTypeFATAL)) return false;
+		if (codeline.label != nullptr || codeline.section == nullptr) return false;
+		if (codeline.includefile > codeline.file) return false;
+		for (auto & token : codeline.lexedtokens) {
+			Directive* directive = GetDirective(token.keyword);
+			if (directive && !directive->IsData()) return false;
+			if ((token.type == tokenTypeDIRECTIVE) && !directive) return false;
+		}
+		return true;
+	}
 	
-	Assembler::Assembler()
+	/** Assembles an edited line alone, with its pass 1 for the messages then its pass 2 for the code.
+	 @param codeline the line with its new source, at the address and in the section of its previous source
+	 @param msg the list of messages and warnings
+	 @return true if the line is assembled, false if the line is not local or changed size and the files must be assembled again
+	 */
+	bool Assembler::ReassembleLine(CodeLine& codeline, ErrorList& msg)
 	{
-		Reset();
-
-		// enter known processors here
-		knownProcessors.push_back("Z80");
-		knownProcessors.push_back("Z180");
-
-		// Preprocessor directives
-		m_directives["DEFINE"] = new DirectiveDEFINE();
-		m_directives["UNDEF"] = new DirectiveUNDEFINE();
-		m_directives["IF"] = new DirectiveIF();
-		m_directives["COND"] = new DirectiveIF();
-		m_directives["IFDEF"] = new DirectiveIFDEF();
-		m_directives["ELSE"] = new DirectiveELSE();
-		m_directives["IFNDEF"] = new DirectiveIFNDEF();
-		m_directives["ENDIF"] = new DirectiveENDIF();
-		m_directives["ENDC"] = new DirectiveENDIF();
-		m_directives["INCLUDE"] = new DirectiveINCLUDE();
-		m_directives["INSERTHEX"] = new DirectiveINSERTHEX();
-		m_directives["INSERTBIN"] = new DirectiveINSERTBIN();
-		m_directives["NOLIST"] = new DirectiveLISTOFF();
-		m_directives["LIST"] = new DirectiveLIST();
-		m_directives["REQUIRES"] = new DirectiveREQUIRES();
-		m_directives["IFREQUIRED"] = new DirectiveIFREQUIRED();
-
-		// Assembler directives
-		m_directives["PROC"] = new DirectivePROC();
-		m_directives["ORG"] = new DirectiveORG();
-		m_directives["DATA"] = new DirectiveDATA();
-		m_directives["CODE"] = new DirectiveCODE();
-		m_directives["END"] = new DirectiveEND();
-		m_directives["EQU"] = new DirectiveEQU();
-		m_directives["SET"] = new DirectiveSET();
-		m_directives["BYTE"] = new DirectiveBYTE();
+		DWORD size = codeline.Size();
+		RestoreContext(codeline);
+		
+		// forget the previous source
+		codeline.lexed = false;
+		codeline.expressions.clear();
+		codeline.message = -1;
+		codeline.as = this;
+		codeline.jump = RelaxedJump();
+		m_relaxchanged = false;
+		
+		// both passes on the line
+		bool local = true;
+		for (int pass = 1 ; local && (pass <= 2) ; pass++) {
+			SetFirstPass(pass == 1);
+			codeline.ResetCode();
+			codeline.assembled = AssembleCodeLine(codeline, msg);
+			local = IsLocalLine(codeline);
+		}
+		SetFirstPass(false);
+		return local && (codeline.Size() == size) && !m_relaxchanged;
+	}
+	
+	/** Restores the section, address, file and label scope of a line assembled again alone. */
+	void Assembler::RestoreContext(CodeLine& codeline)
+	{
+		m_status.cursection = codeline.section;
+		m_status.cursection->SetOrg(codeline.address);
+		m_status.curfile = codeline.file;
+		m_status.lastlabel = codeline.scope;
+	}
+	
+	/** Assembles all the files again from the lines of the current assembly. The tables are cleared, but the symbol
+	 names are kept because the lexed tokens refer to them.
+	 */
+	ErrorType Assembler::ReassembleFiles(ErrorList& msg)
+	{
+		std::string file = m_files[0]->Path();
+		m_storedfiles.swap(m_files);
+		ClearSymbols();
+		msg.clear();
+		m_relaxchanged = false;
+		
+		SetFirstPass(true);
+		ErrorType result = errorTypeFALSE;
+		try {
+			result = AssembleMainFilePassOne(file, msg);
+			if (result == errorTypeOK) {
+				SetFirstPass(false);
+				result = AssembleMainFilePassTwo(file, msg);
+			}
+		} catch (std::exception& e) {
+			perror(e.what());
+		};
+		
+		// release the files which have not been included this time
+		for (auto & f : m_storedfiles) {
+			delete f;
+		}
+		m_storedfiles.clear();
+		return result;
+	}
+	
+	/** Assembles all the files again while the pass 2 chooses another form for some relaxed jumps. Each assembly
+	 uses the forms chosen by the previous one, so the layout shrinks until every short jump reaches its target.
+	 A jump only changes its form twice at most, as the long form is kept for good once the short form has been out
+	 of range, so the layout always reaches a fixed point.
+	 @param result the result of the previous assembly
+	 @param msg the list of messages and warnings, replaced by the messages of the last assembly
+	 @return the result of the last assembly
+	 */
+	ErrorType Assembler::RelaxLayout(ErrorType result, ErrorList& msg)
+	{
+		while ((result == errorTypeOK) && m_relaxchanged) {
+			if (m_status.trace) printf("Relaxing jumps: %s\n", m_files[0]->Path().c_str());
+			result = ReassembleFiles(msg);
+		}
+		return result;
+	}
+	
+	//MARK: - Private fixups
+	
+	/** Tells if a line assembled by pass 1 can be assembled again alone once all the labels are known: it has been
+	 assembled in a section and its only directives store data, so it does not change any symbol, address or
+	 conditionnal mode. Unlike the edited lines, it can define a label because pass 1 has already set its address.
+	 */
+	bool Assembler::IsFixupLine(const CodeLine& codeline)
+	{
+		if ((codeline.assembled != errorTypeOK) || codeline.rawdata || (codeline.section == nullptr)) return false;
+		if (codeline.includefile > codeline.file) return false;
+		for (auto & token : codeline.lexed ? codeline.lexedtokens : codeline.tokens) {
+			Directive* directive = GetDirective(token.keyword);
+			if (directive && !directive->IsData()) return false;
+			if ((token.type == tokenTypeDIRECTIVE) && !directive) return false;
+		}
+		return true;
+	}
+	
+	/** Flags a line assembled by pass 1 as a fixup if it uses unsolved symbols, and asks for the whole pass 2
+	 if the line cannot be assembled again alone, if it is in error or if it has given a new value to its label or to
+	 the label of the previous line. The line is already flagged if it gives messages in pass 2.
+	 */
+	void Assembler::CheckFixup(CodeLine& codeline, Label* previous)
+	{
+		for (auto & token : codeline.tokens) {
+			if (token.unsolved) {
+				codeline.fixup = true;
+				break;
+			}
+		}
+		if (codeline.fixup && !IsFixupLine(codeline)) m_passtwo = true;
+		// a line in error may be read differently by pass 2
+		if (codeline.assembled == errorTypeERROR) m_passtwo = true;
+		// the pass 2 would see the successive values of a label set again by .EQU, .SET or .ORG
+		if (codeline.label && codeline.label->redefined) m_passtwo = true;
+		if (previous && previous->redefined) m_passtwo = true;
+	}
+	
+	/** Assembles the fixup lines again in pass 2 mode, in the context they had in pass 1. This replaces the
+	 pass 2 when every fixup keeps its size: the other lines would be assembled the same way, as their symbols
+	 were all known in pass 1.
+	 @param msg the list of messages and warnings, the fixup messages are removed if the whole pass 2 must be run
+	 @return true if the fixups have been assembled, false if the whole pass 2 must be run instead
+	 */
+	bool Assembler::FixupLines(ErrorList& msg)
+	{
+		size_t nbmessages = msg.size();
+		size_t nbfixups = 0;
+		m_modes = ParsingModeStack();// fixup lines are never in conditionnal directives
+		for (SourceFile* sourcefile : m_files) {
+			for (CodeLine& cl : sourcefile->lines) {
+				if (!cl.fixup) continue;
+				DWORD size = cl.Size();
+				RestoreContext(cl);
+				// a relaxed jump has its form set by pass 1
+				m_status.relax = (cl.jump.form != jumpformWRITTEN);
+				cl.ResetCode();
+				cl.as = this;
+				cl.assembled = AssembleCodeLine(cl, msg);
+				if ((cl.assembled != errorTypeOK) || (cl.Size() != size)) {
+					msg.erase(msg.begin() + (long)nbmessages, msg.end());
+					return false;
+				}
+				nbfixups += 1;
+			}
+		}
+		if (m_status.trace) printf("Fixups: %d lines\n", (int)nbfixups);
+		return true;
+	}
+	
+	/** Records a #DEFINE or #REQUIRES symbol tested by pass 1. */
+	void Assembler::TestSymbol(SYMBOLID id)
+	{
+		if (!IsFirstPass() || (id == 0)) return;
+		if (id >= m_testedsymbols.size()) m_testedsymbols.resize(id + 1, false);
+		m_testedsymbols[id] = true;
+	}
+	
+	/** Asks for the whole pass 2 if a #DEFINE or #REQUIRES symbol changes after it has been tested by pass 1,
+	 because the fixup lines would see its last value instead of the value it had when they were assembled.
+	 */
+	void Assembler::ChangeSymbol(SYMBOLID id)
+	{
+		if (!IsFirstPass()) return;
+		if ((id < m_testedsymbols.size()) && m_testedsymbols[id]) m_passtwo = true;
+	}
+	
+	/** Deletes all the labels, symbols and sections, and resets the assembly status. */
+	void Assembler::ClearSymbols()
+	{
+		for (SYMBOLID id = 1 ; id < m_defsymbols.end() ; id++) {
+			delete m_defsymbols.Get(id);
+		}
+		for (SYMBOLID id = 1 ; id < m_reqsymbols.end() ; id++) {
+			delete m_reqsymbols.Get(id);
+		}
+		for (SYMBOLID id = 1 ; id < labels.end() ; id++) {
+			delete labels.Get(id);
+		}
+		for (SYMBOLID id = 1 ; id < m_macros.end() ; id++) {
+			delete m_macros.Get(id);
+		}
+		m_defsymbols.Clear();
+		m_reqsymbols.Clear();
+		labels.Clear();
+		m_macros.Clear();
+		ClearRecording();
+		for (auto &section : m_sections) delete section.second;
+		m_sections.clear();
+		m_status.cursection = nullptr;
+		m_status.curfile = 0;
+		m_status.lastlabel = 0;
+		m_status.finished = false;
+		m_modes = ParsingModeStack();// resets
+	}
+	
+	//MARK: - Private macros and repeated blocks
+	
+	/** Maximum number of imbricated expansions, which stops a macro expanding itself. */
+	static const size_t MAXEXPANSIONDEPTH = 64;
+	
+	/** Stores a new macro. A macro with the same name is kept by the new one because its expansion may be running. */
+	void Assembler::DefineMacro(Macro* macro)
+	{
+		macro->previous = m_macros.Get(macro->name);
+		m_macros.Set(macro->name, macro);
+	}
+	
+	/** Starts recording the lines following a .MACRO or .REPT directive. Pass 1 records them in the given block,
+	 pass 2 and the directives in error give no block so the lines are only skipped.
+	 @param macro the block receiving the lines, or nullptr
+	 @param repeat true for a .REPT block
+	 @param codeline the line of the opening directive
+	 */
+	void Assembler::StartRecording(Macro* macro, bool repeat, const CodeLine& codeline)
+	{
+		ClearRecording();
+		m_recording.active = true;
+		m_recording.repeat = repeat;
+		m_recording.file = codeline.file;
+		m_recording.line = codeline.line;
+		m_recording.macro = macro;
+	}
+	
+	/** Records a line of a .MACRO or .REPT block with its split tokens. The blocks opened within the block are
+	 recorded along with their closing directive, so they are defined or repeated by each expansion.
+	 @param codeline the line, with the tokens restored or split
+	 @return false if the line closes the block, it must then be assembled
+	 */
+	bool Assembler::RecordLine(CodeLine& codeline)
+	{
+		// the first directive of the line can open or close a block
+		int keyword = -1;
+		for (auto & token : codeline.tokens) {
+			if (token.type == tokenTypeDIRECTIVE) {
+				keyword = token.keyword;
+				break;
+			}
+		}
+		if ((keyword == Keywords::Index("MACRO")) || (keyword == Keywords::Index("REPT"))) {
+			m_recording.level += 1;
+		} else if ((keyword == Keywords::Index("ENDM")) || (keyword == Keywords::Index("ENDR"))) {
+			if (m_recording.level == 0) return false;
+			m_recording.level -= 1;
+		}
+		if (m_recording.macro) {
+			CodeLine body;
+			body.source = codeline.source;
+			body.lexedtokens = codeline.tokens;
+			body.lexedtokens.update();
+			body.lexeddirective = codeline.lexeddirective;
+			body.lexedflag = codeline.lexedflag;
+			body.lexed = true;
+			m_recording.macro->body.push_back(std::move(body));
+		}
+		return true;
+	}
+	
+	/** Ends the recording. A recorded .REPT block is then owned by the caller. */
+	Assembler::Macro* Assembler::EndRecording()
+	{
+		Macro* macro = m_recording.macro;
+		m_recording = Recording();
+		return macro;
+	}
+	
+	/** Forgets the block being recorded. */
+	void Assembler::ClearRecording()
+	{
+		if (m_recording.repeat) delete m_recording.macro;
+		m_recording = Recording();
+	}
+	
+	/** Tells if a token is the name of a macro expanded by its line. Pass 2 only expands again the lines expanded by
+	 pass 1, so a macro invoked before its definition is never expanded.
+	 */
+	bool Assembler::IsMacro(const CodeLine& codeline, const ParseToken& token)
+	{
+		if ((token.type != tokenTypeLETTERS) || (m_macros.Get(token.symbol) == nullptr)) return false;
+		return IsFirstPass() || (codeline.includefile > codeline.file);
+	}
+	
+	/** Assembles the lines of a macro or of a .REPT block after the line expanding them. The lines are stored in a
+	 source file included by the line, named after the line, so the listing, the messages, the fixups and pass 2
+	 handle them like the lines of an #INCLUDEd file. Each line copies the tokens of the recorded line with the
+	 parameters replaced by the tokens of the arguments, and it is not split again. The local '@' labels of an
+	 expansion belong to its own file.
+	 @param macro the macro or .REPT block
+	 @param codeline the line invoking the macro, or the .ENDR line
+	 @param argtoken the index of the first argument token in the line
+	 @param msg the list of messages and warnings
+	 @return errorTypeFATAL if an expanded line breaks the assembly
+	 */
+	ErrorType Assembler::ExpandMacro(Macro& macro, CodeLine& codeline, size_t argtoken, ErrorList& msg)
+	{
+		if (m_expansiondepth >= MAXEXPANSIONDEPTH) return msg.Error(errorMacroDepth, codeline);
+		
+		// arguments are separated by the commas out of parenthesis, missing arguments are empty
+		std::vector<std::vector<ParseToken>> arguments;
+		std::vector<string> texts;
+		if (!macro.parameters.empty()) {
+			int depth = 0;
+			for (size_t index = argtoken ; index < codeline.tokens.size() ; index++) {
+				ParseToken& token = codeline.tokens[index];
+				if (token.type == tokenTypeCOMMENT) break;
+				if (arguments.empty()) arguments.emplace_back();
+				if (token.type == tokenTypePAROPEN) depth += 1;
+				if (token.type == tokenTypePARCLOSE) depth -= 1;
+				if ((token.type == tokenTypeCOMMA) && (depth == 0)) {
+					arguments.emplace_back();
+				} else {
+					arguments.back().push_back(token);
+				}
+			}
+			// the listing shows the arguments as written
+			size_t pos = 0;
+			for (size_t index = 0 ; index < argtoken ; index++) {
+				const string& name = codeline.tokens[index].source;
+				size_t found = codeline.source.find(name, pos);
+				while ((found != string::npos) && isSymbolChar(name[0]) && (((found > 0) && isSymbolChar(codeline.source[found - 1])) || isSymbolChar(codeline.source[found + name.size()]))) {
+					found = codeline.source.find(name, found + 1);
+				}
+				if (found != string::npos) pos = found + name.size();
+			}
+			texts = splitArguments(codeline.source, pos);
+		}
+		if (arguments.size() > macro.parameters.size()) {
+			codeline.curtoken = argtoken;
+			return msg.Error(errorMacroArguments, codeline);
+		}
+		arguments.resize(macro.parameters.size());
+		texts.resize(macro.parameters.size());
+		std::vector<string> names;
+		for (SYMBOLID parameter : macro.parameters) {
+			names.push_back(m_symbolnames.Name(parameter));
+		}
+		
+		// the expansion is included by the line
+		SourceFile* parent = m_files[codeline.file];
+		SourceFile* sourcefile = new SourceFile;
+		if (sourcefile == nullptr) throw MUZ::OutOfMemoryException();
+		sourcefile->included = true;
+		sourcefile->expansion = true;
+		sourcefile->parent = parent;
+		sourcefile->parentfile = codeline.file;
+		sourcefile->parentline = codeline.line;
+		sourcefile->fileprefix = parent->fileprefix;
+		sourcefile->filepath = parent->filepath;
+		sourcefile->filename = parent->filename + "(" + std::to_string(codeline.line) + ") " + (macro.repeat ? "REPT" : m_symbolnames.Name(macro.name));
+		size_t filenum = m_files.size();
+		// the relaxed jumps keep the form chosen by the previous assembly
+		std::vector<CodeLine> storedlines;
+		TakeStoredLines(filenum, sourcefile->Path(), storedlines);
+		codeline.includefile = filenum;
+		m_files.push_back(sourcefile);
+		sourcefile->lines.reserve(macro.body.size() * macro.count);
+		size_t curfile = m_status.curfile;
+		m_status.curfile = filenum;
+		m_expansiondepth += 1;
+		
+		Label* lastLabel = nullptr;
+		ErrorType result = errorTypeOK;
+		for (DWORD repeat = 0 ; (repeat < macro.count) && (result != errorTypeFATAL) && !m_status.finished ; repeat++) {
+			for (size_t index = 0 ; (index < macro.body.size()) && (result != errorTypeFATAL) && !m_status.finished ; index++) {
+				CodeLine& body = macro.body[index];
+				
+				// prepare the codeline from the recorded line
+				CodeLine cl;
+				cl.address = GetAddress();
+				cl.section = GetSection();
+				cl.assembled = errorTypeFALSE;
+				cl.file = filenum;
+				cl.line = sourcefile->lines.size() + 1;
+				if (names.empty()) {
+					cl.source = body.source;
+					cl.lexedtokens = body.lexedtokens;
+				} else {
+					cl.source = substituteParameters(body.source, names, texts);
+					for (auto & token : body.lexedtokens) {
+						auto found = std::find(macro.parameters.begin(), macro.parameters.end(), token.symbol);
+						if ((token.type != tokenTypeLETTERS) || (found == macro.parameters.end())) {
+							cl.lexedtokens.push_back(token);
+							continue;
+						}
+						for (auto & argument : arguments[(size_t)(found - macro.parameters.begin())]) {
+							cl.lexedtokens.push_back(argument);
+						}
+					}
+				}
+				cl.lexedtokens.update();
+				cl.lexeddirective = body.lexeddirective;
+				cl.lexedflag = body.lexedflag;
+				cl.lexed = true;
+				size_t stored = cl.line - 1;
+				if ((stored < storedlines.size()) && (storedlines[stored].source == cl.source)) {
+					cl.jump = storedlines[stored].jump;
+				}
+				
+				// debug
+				if (m_status.trace) printf("%04X: [%4d] %s\n", GetAddress(), (int)cl.line, cl.source.c_str());
+				
+				cl.label = lastLabel;	// send previous label so a possible .EQU directive will change its value
+				cl.listing = m_status.listing;
+				cl.as = this;
+				cl.assembled = AssembleCodeLine(cl, msg);
+				CheckFixup(cl, lastLabel);
+				if (cl.assembled == errorTypeOK) {
+					cl.address = GetAddress();
+					cl.section = GetSection();
+					lastLabel = cl.label;
+				}
+				if (cl.assembled == errorTypeFATAL) result = errorTypeFATAL;
+				// update current address
+				AdvanceAddress((ADDRESSTYPE)cl.Size());
+				sourcefile->lines.push_back(std::move(cl));
+			}
+		}
+		
+		m_expansiondepth -= 1;
+		m_status.curfile = curfile;
+		return result;
+	}
+	
+	/** Assembles again in pass 2 the lines expanded after a line by pass 1. */
+	ErrorType Assembler::ReplayExpansion(CodeLine& codeline, ErrorList& msg)
+	{
+		if ((codeline.includefile <= codeline.file) || (codeline.includefile >= m_files.size())) return errorTypeOK;
+		size_t curfile = m_status.curfile;
+		ErrorType result = AssembleIncludedFilePassTwo(m_files[codeline.includefile]->Path(), codeline, msg);
+		m_status.curfile = curfile;
+		return result;
+	}
+	
+	//MARK: - PUBLIC API
+	
+	//MARK: - Constructor and destructor
+	
+	Assembler::Assembler()
+	{
+		Reset();
+
+		// enter known processors here
+		knownProcessors.push_back("Z80");
+		knownProcessors.push_back("Z180");
+
+		// Preprocessor directives
+		m_directives["DEFINE"] = new DirectiveDEFINE();
+		m_directives["UNDEF"] = new DirectiveUNDEFINE();
+		m_directives["IF"] = new DirectiveIF();
+		m_directives["COND"] = new DirectiveIF();
+		m_directives["IFDEF"] = new DirectiveIFDEF();
+		m_directives["ELSE"] = new DirectiveELSE();
+		m_directives["IFNDEF"] = new DirectiveIFNDEF();
+		m_directives["ENDIF"] = new DirectiveENDIF();
+		m_directives["ENDC"] = new DirectiveENDIF();
+		m_directives["INCLUDE"] = new DirectiveINCLUDE();
+		m_directives["INSERTHEX"] = new DirectiveINSERTHEX();
+		m_directives["INSERTBIN"] = new DirectiveINSERTBIN();
+		m_directives["NOLIST"] = new DirectiveLISTOFF();
+		m_directives["LIST"] = new DirectiveLIST();
+		m_directives["REQUIRES"] = new DirectiveREQUIRES();
+		m_directives["IFREQUIRED"] = new DirectiveIFREQUIRED();
+
+		// Assembler directives
+		m_directives["PROC"] = new DirectivePROC();
+		m_directives["ORG"] = new DirectiveORG();
+		m_directives["DATA"] = new DirectiveDATA();
+		m_directives["CODE"] = new DirectiveCODE();
+		m_directives["END"] = new DirectiveEND();
+		m_directives["EQU"] = new DirectiveEQU();
+		m_directives["SET"] = new DirectiveSET();
+		m_directives["BYTE"] = new DirectiveBYTE();
 		m_directives["DB"] = new DirectiveBYTE();
 		m_directives["DEFB"] = new DirectiveBYTE();
 		m_directives["WORD"] = new DirectiveWORD();
@@ -1544,6 +2583,14 @@ namespace MUZ {
 		m_directives["DS"] = new DirectiveSPACE();
 		m_directives["DEFS"] = new DirectiveSPACE();
 		m_directives["HEXBYTES"] = new DirectiveHEXBYTES();
+		m_directives["RELAX"] = new DirectiveRELAX();
+		m_directives["MACRO"] = new DirectiveMACRO();
+		m_directives["ENDM"] = new DirectiveENDM();
+		m_directives["REPT"] = new DirectiveREPT();
+		m_directives["ENDR"] = new DirectiveENDR();
+
+		IndexDirectives();
+		IndexInstructions();
 	}
 	
 	Assembler::~Assembler()
@@ -1554,18 +2601,25 @@ namespace MUZ {
 		for (auto &d : m_directives) {
 			delete d.second;
 		}
-		for (auto &d : m_defsymbols) {
-			delete d.second;
+		for (SYMBOLID id = 1 ; id < m_defsymbols.end() ; id++) {
+			delete m_defsymbols.Get(id);
 		}
-		for (auto &d : m_reqsymbols) {
-			delete d.second;
+		for (SYMBOLID id = 1 ; id < m_reqsymbols.end() ; id++) {
+			delete m_reqsymbols.Get(id);
 		}
-		for (auto &d : labels) {
-			delete d.second;
+		for (SYMBOLID id = 1 ; id < labels.end() ; id++) {
+			delete labels.Get(id);
+		}
+		for (SYMBOLID id = 1 ; id < m_macros.end() ; id++) {
+			delete m_macros.Get(id);
 		}
+		ClearRecording();
 		for (auto &f : m_files) {
 			delete f;
 		}
+		for (auto &p : m_parsers) {
+			delete p;
+		}
 		for (auto &s : m_sections) {
 			delete s.second;
 		}
@@ -1575,159 +2629,187 @@ namespace MUZ {
 	void Assembler::SetInstructions(std::string name)
 	{
 		if (name=="Z80") {
+			for (auto &i : m_instructions) delete i.second;
 			m_instructions.clear();
-			m_instructions["LD"] = new Z80::InstructionLD();
-			m_instructions["PUSH"] = new Z80::InstructionPUSH();
-			m_instructions["POP"] = new Z80::InstructionPOP();
-			m_instructions["EXX"] = new Z80::InstructionEXX();
-			m_instructions["EX"] = new Z80::InstructionEX();
-			m_instructions["LDI"] = new Z80::InstructionLDI();
-			m_instructions["LDIR"] = new Z80::InstructionLDIR();
-			m_instructions["LDD"] = new Z80::InstructionLDD();
-			m_instructions["LDDR"] = new Z80::InstructionLDDR();
-			m_instructions["CPI"] = new Z80::InstructionCPI();
-			m_instructions["CPIR"] = new Z80::InstructionCPIR();
-			m_instructions["CPD"] = new Z80::InstructionCPD();
-			m_instructions["CPDR"] = new Z80::InstructionCPDR();
-			m_instructions["ADD"] = new Z80::InstructionADD();
-			m_instructions["ADC"] = new Z80::InstructionADC();
-			m_instructions["SUB"] = new Z80::InstructionSUB();
-			m_instructions["SBC"] = new Z80::InstructionSBC();
-			m_instructions["AND"] = new Z80::InstructionAND();
-			m_instructions["OR"] = new Z80::InstructionOR();
-			m_instructions["XOR"] = new Z80::InstructionXOR();
-			m_instructions["CP"] = new Z80::InstructionCP();
-			m_instructions["INC"] = new Z80::InstructionINC();
-			m_instructions["DEC"] = new Z80::InstructionDEC();
-			m_instructions["DAA"] = new Z80::InstructionDAA();
-			m_instructions["CPL"] = new Z80::InstructionCPL();
-			m_instructions["NEG"] = new Z80::InstructionNEG();
-			m_instructions["CCF"] = new Z80::InstructionCCF();
-			m_instructions["SCF"] = new Z80::InstructionSCF();
-			m_instructions["NOP"] = new Z80::InstructionNOP();
-			m_instructions["HALT"] = new Z80::InstructionHALT();
-			m_instructions["DI"] = new Z80::InstructionDI();
-			m_instructions["EI"] = new Z80::InstructionEI();
-			m_instructions["IM"] = new Z80::InstructionIM();
-			m_instructions["RLCA"] = new Z80::InstructionRLCA();
-			m_instructions["RLA"] = new Z80::InstructionRLA();
-			m_instructions["RRCA"] = new Z80::InstructionRRCA();
-			m_instructions["RRA"] = new Z80::InstructionRRA();
-			m_instructions["RLC"] = new Z80::InstructionRLC();
-			m_instructions["RL"] = new Z80::InstructionRL();
-			m_instructions["RRC"] = new Z80::InstructionRRC();
-			m_instructions["RR"] = new Z80::InstructionRR();
-			m_instructions["SLA"] = new Z80::InstructionSLA();
-			m_instructions["SLL"] = new Z80::InstructionSLL();//undoc
-			m_instructions["SRA"] = new Z80::InstructionSRA();
-			m_instructions["SRL"] = new Z80::InstructionSRL();
-			m_instructions["RLD"] = new Z80::InstructionRLD();
-			m_instructions["RRD"] = new Z80::InstructionRRD();
-			m_instructions["BIT"] = new Z80::InstructionBIT();
-			m_instructions["SET"] = new Z80::InstructionSET();
-			m_instructions["RES"] = new Z80::InstructionRES();
-			m_instructions["JP"] = new Z80::InstructionJP();
-			m_instructions["JR"] = new Z80::InstructionJR();
-			m_instructions["DJNZ"] = new Z80::InstructionDJNZ();
-			m_instructions["CALL"] = new Z80::InstructionCALL();
-			m_instructions["RET"] = new Z80::InstructionRET();
-			m_instructions["RETI"] = new Z80::InstructionRETI();
-			m_instructions["RETN"] = new Z80::InstructionRETN();
-			m_instructions["RST"] = new Z80::InstructionRST();
-			m_instructions["IN"] = new Z80::InstructionIN();
-			m_instructions["INI"] = new Z80::InstructionINI();
-			m_instructions["INIR"] = new Z80::InstructionINIR();
-			m_instructions["IND"] = new Z80::InstructionIND();
-			m_instructions["INDR"] = new Z80::InstructionINDR();
-			m_instructions["OUT"] = new Z80::InstructionOUT();
-			m_instructions["OUTI"] = new Z80::InstructionOUTI();
-			m_instructions["OTIR"] = new Z80::InstructionOTIR();
-			m_instructions["OUTD"] = new Z80::InstructionOUTD();
-			m_instructions["OTDR"] = new Z80::InstructionOTDR();
+			m_instructions["LD"] = new Z80::InstructionLD(Z80::cpuZ80);
+			m_instructions["PUSH"] = new Z80::InstructionPUSH(Z80::cpuZ80);
+			m_instructions["POP"] = new Z80::InstructionPOP(Z80::cpuZ80);
+			m_instructions["EXX"] = new Z80::InstructionEXX(Z80::cpuZ80);
+			m_instructions["EX"] = new Z80::InstructionEX(Z80::cpuZ80);
+			m_instructions["LDI"] = new Z80::InstructionLDI(Z80::cpuZ80);
+			m_instructions["LDIR"] = new Z80::InstructionLDIR(Z80::cpuZ80);
+			m_instructions["LDD"] = new Z80::InstructionLDD(Z80::cpuZ80);
+			m_instructions["LDDR"] = new Z80::InstructionLDDR(Z80::cpuZ80);
+			m_instructions["CPI"] = new Z80::InstructionCPI(Z80::cpuZ80);
+			m_instructions["CPIR"] = new Z80::InstructionCPIR(Z80::cpuZ80);
+			m_instructions["CPD"] = new Z80::InstructionCPD(Z80::cpuZ80);
+			m_instructions["CPDR"] = new Z80::InstructionCPDR(Z80::cpuZ80);
+			m_instructions["ADD"] = new Z80::InstructionADD(Z80::cpuZ80);
+			m_instructions["ADC"] = new Z80::InstructionADC(Z80::cpuZ80);
+			m_instructions["SUB"] = new Z80::InstructionSUB(Z80::cpuZ80);
+			m_instructions["SBC"] = new Z80::InstructionSBC(Z80::cpuZ80);
+			m_instructions["AND"] = new Z80::InstructionAND(Z80::cpuZ80);
+			m_instructions["OR"] = new Z80::InstructionOR(Z80::cpuZ80);
+			m_instructions["XOR"] = new Z80::InstructionXOR(Z80::cpuZ80);
+			m_instructions["CP"] = new Z80::InstructionCP(Z80::cpuZ80);
+			m_instructions["INC"] = new Z80::InstructionINC(Z80::cpuZ80);
+			m_instructions["DEC"] = new Z80::InstructionDEC(Z80::cpuZ80);
+			m_instructions["DAA"] = new Z80::InstructionDAA(Z80::cpuZ80);
+			m_instructions["CPL"] = new Z80::InstructionCPL(Z80::cpuZ80);
+			m_instructions["NEG"] = new Z80::InstructionNEG(Z80::cpuZ80);
+			m_instructions["CCF"] = new Z80::InstructionCCF(Z80::cpuZ80);
+			m_instructions["SCF"] = new Z80::InstructionSCF(Z80::cpuZ80);
+			m_instructions["NOP"] = new Z80::InstructionNOP(Z80::cpuZ80);
+			m_instructions["HALT"] = new Z80::InstructionHALT(Z80::cpuZ80);
+			m_instructions["DI"] = new Z80::InstructionDI(Z80::cpuZ80);
+			m_instructions["EI"] = new Z80::InstructionEI(Z80::cpuZ80);
+			m_instructions["IM"] = new Z80::InstructionIM(Z80::cpuZ80);
+			m_instructions["RLCA"] = new Z80::InstructionRLCA(Z80::cpuZ80);
+			m_instructions["RLA"] = new Z80::InstructionRLA(Z80::cpuZ80);
+			m_instructions["RRCA"] = new Z80::InstructionRRCA(Z80::cpuZ80);
+			m_instructions["RRA"] = new Z80::InstructionRRA(Z80::cpuZ80);
+			m_instructions["RLC"] = new Z80::InstructionRLC(Z80::cpuZ80);
+			m_instructions["RL"] = new Z80::InstructionRL(Z80::cpuZ80);
+			m_instructions["RRC"] = new Z80::InstructionRRC(Z80::cpuZ80);
+			m_instructions["RR"] = new Z80::InstructionRR(Z80::cpuZ80);
+			m_instructions["SLA"] = new Z80::InstructionSLA(Z80::cpuZ80);
+			m_instructions["SLL"] = new Z80::InstructionSLL(Z80::cpuZ80);//undoc
+			m_instructions["SRA"] = new Z80::InstructionSRA(Z80::cpuZ80);
+			m_instructions["SRL"] = new Z80::InstructionSRL(Z80::cpuZ80);
+			m_instructions["RLD"] = new Z80::InstructionRLD(Z80::cpuZ80);
+			m_instructions["RRD"] = new Z80::InstructionRRD(Z80::cpuZ80);
+			m_instructions["BIT"] = new Z80::InstructionBIT(Z80::cpuZ80);
+			m_instructions["SET"] = new Z80::InstructionSET(Z80::cpuZ80);
+			m_instructions["RES"] = new Z80::InstructionRES(Z80::cpuZ80);
+			m_instructions["JP"] = new Z80::InstructionJP(Z80::cpuZ80);
+			m_instructions["JR"] = new Z80::InstructionJR(Z80::cpuZ80);
+			m_instructions["DJNZ"] = new Z80::InstructionDJNZ(Z80::cpuZ80);
+			m_instructions["CALL"] = new Z80::InstructionCALL(Z80::cpuZ80);
+			m_instructions["RET"] = new Z80::InstructionRET(Z80::cpuZ80);
+			m_instructions["RETI"] = new Z80::InstructionRETI(Z80::cpuZ80);
+			m_instructions["RETN"] = new Z80::InstructionRETN(Z80::cpuZ80);
+			m_instructions["RST"] = new Z80::InstructionRST(Z80::cpuZ80);
+			m_instructions["IN"] = new Z80::InstructionIN(Z80::cpuZ80);
+			m_instructions["INI"] = new Z80::InstructionINI(Z80::cpuZ80);
+			m_instructions["INIR"] = new Z80::InstructionINIR(Z80::cpuZ80);
+			m_instructions["IND"] = new Z80::InstructionIND(Z80::cpuZ80);
+			m_instructions["INDR"] = new Z80::InstructionINDR(Z80::cpuZ80);
+			m_instructions["OUT"] = new Z80::InstructionOUT(Z80::cpuZ80);
+			m_instructions["OUTI"] = new Z80::InstructionOUTI(Z80::cpuZ80);
+			m_instructions["OTIR"] = new Z80::InstructionOTIR(Z80::cpuZ80);
+			m_instructions["OUTD"] = new Z80::InstructionOUTD(Z80::cpuZ80);
+			m_instructions["OTDR"] = new Z80::InstructionOTDR(Z80::cpuZ80);
 		} else if (name=="Z180") {
 			// Z-80 compatible, shorter states
+			for (auto &i : m_instructions) delete i.second;
 			m_instructions.clear();
-			m_instructions["LD"] = new Z180::InstructionLD();
-			m_instructions["PUSH"] = new Z180::InstructionPUSH();
-			m_instructions["POP"] = new Z180::InstructionPOP();
-			m_instructions["EXX"] = new Z180::InstructionEXX();
-			m_instructions["EX"] = new Z180::InstructionEX();
-			m_instructions["LDI"] = new Z180::InstructionLDI();
-			m_instructions["LDIR"] = new Z180::InstructionLDIR();
-			m_instructions["LDD"] = new Z180::InstructionLDD();
-			m_instructions["LDDR"] = new Z180::InstructionLDDR();
-			m_instructions["CPI"] = new Z180::InstructionCPI();
-			m_instructions["CPIR"] = new Z180::InstructionCPIR();
-			m_instructions["CPD"] = new Z180::InstructionCPD();
-			m_instructions["CPDR"] = new Z180::InstructionCPDR();
-			m_instructions["ADD"] = new Z180::InstructionADD();
-			m_instructions["ADC"] = new Z180::InstructionADC();
-			m_instructions["SUB"] = new Z180::InstructionSUB();
-			m_instructions["SBC"] = new Z180::InstructionSBC();
-			m_instructions["AND"] = new Z180::InstructionAND();
-			m_instructions["OR"] = new Z180::InstructionOR();
-			m_instructions["XOR"] = new Z180::InstructionXOR();
-			m_instructions["CP"] = new Z180::InstructionCP();
-			m_instructions["INC"] = new Z180::InstructionINC();
-			m_instructions["DEC"] = new Z180::InstructionDEC();
-			m_instructions["DAA"] = new Z180::InstructionDAA();
-			m_instructions["CPL"] = new Z180::InstructionCPL();
-			m_instructions["NEG"] = new Z180::InstructionNEG();
-			m_instructions["CCF"] = new Z180::InstructionCCF();
-			m_instructions["SCF"] = new Z180::InstructionSCF();
-			m_instructions["NOP"] = new Z180::InstructionNOP();
-			m_instructions["HALT"] = new Z180::InstructionHALT();
-			m_instructions["DI"] = new Z180::InstructionDI();
-			m_instructions["EI"] = new Z180::InstructionEI();
-			m_instructions["IM"] = new Z180::InstructionIM();
-			m_instructions["RLCA"] = new Z180::InstructionRLCA();
-			m_instructions["RLA"] = new Z180::InstructionRLA();
-			m_instructions["RRCA"] = new Z180::InstructionRRCA();
-			m_instructions["RRA"] = new Z180::InstructionRRA();
-			m_instructions["RLC"] = new Z180::InstructionRLC();
-			m_instructions["RL"] = new Z180::InstructionRL();
-			m_instructions["RRC"] = new Z180::InstructionRRC();
-			m_instructions["RR"] = new Z180::InstructionRR();
-			m_instructions["SLA"] = new Z180::InstructionSLA();
-			m_instructions["SLL"] = new Z180::InstructionSLL();//undoc
-			m_instructions["SRA"] = new Z180::InstructionSRA();
-			m_instructions["SRL"] = new Z180::InstructionSRL();
-			m_instructions["RLD"] = new Z180::InstructionRLD();
-			m_instructions["RRD"] = new Z180::InstructionRRD();
-			m_instructions["BIT"] = new Z180::InstructionBIT();
-			m_instructions["SET"] = new Z180::InstructionSET();
-			m_instructions["RES"] = new Z180::InstructionRES();
-			m_instructions["JP"] = new Z180::InstructionJP();
-			m_instructions["JR"] = new Z180::InstructionJR();
-			m_instructions["DJNZ"] = new Z180::InstructionDJNZ();
-			m_instructions["CALL"] = new Z180::InstructionCALL();
-			m_instructions["RET"] = new Z180::InstructionRET();
-			m_instructions["RETI"] = new Z180::InstructionRETI();
-			m_instructions["RETN"] = new Z180::InstructionRETN();
-			m_instructions["RST"] = new Z180::InstructionRST();
-			m_instructions["IN"] = new Z180::InstructionIN();
-			m_instructions["INI"] = new Z180::InstructionINI();
-			m_instructions["INIR"] = new Z180::InstructionINIR();
-			m_instructions["IND"] = new Z180::InstructionIND();
-			m_instructions["INDR"] = new Z180::InstructionINDR();
-			m_instructions["OUT"] = new Z180::InstructionOUT();
-			m_instructions["OUTI"] = new Z180::InstructionOUTI();
-			m_instructions["OTIR"] = new Z180::InstructionOTIR();
-			m_instructions["OUTD"] = new Z180::InstructionOUTD();
-			m_instructions["OTDR"] = new Z180::InstructionOTDR();
+			m_instructions["LD"] = new Z80::InstructionLD(Z180::cpuZ180);
+			m_instructions["PUSH"] = new Z80::InstructionPUSH(Z180::cpuZ180);
+			m_instructions["POP"] = new Z80::InstructionPOP(Z180::cpuZ180);
+			m_instructions["EXX"] = new Z80::InstructionEXX(Z180::cpuZ180);
+			m_instructions["EX"] = new Z80::InstructionEX(Z180::cpuZ180);
+			m_instructions["LDI"] = new Z80::InstructionLDI(Z180::cpuZ180);
+			m_instructions["LDIR"] = new Z80::InstructionLDIR(Z180::cpuZ180);
+			m_instructions["LDD"] = new Z80::InstructionLDD(Z180::cpuZ180);
+			m_instructions["LDDR"] = new Z80::InstructionLDDR(Z180::cpuZ180);
+			m_instructions["CPI"] = new Z80::InstructionCPI(Z180::cpuZ180);
+			m_instructions["CPIR"] = new Z80::InstructionCPIR(Z180::cpuZ180);
+			m_instructions["CPD"] = new Z80::InstructionCPD(Z180::cpuZ180);
+			m_instructions["CPDR"] = new Z80::InstructionCPDR(Z180::cpuZ180);
+			m_instructions["ADD"] = new Z80::InstructionADD(Z180::cpuZ180);
+			m_instructions["ADC"] = new Z80::InstructionADC(Z180::cpuZ180);
+			m_instructions["SUB"] = new Z80::InstructionSUB(Z180::cpuZ180);
+			m_instructions["SBC"] = new Z80::InstructionSBC(Z180::cpuZ180);
+			m_instructions["AND"] = new Z80::InstructionAND(Z180::cpuZ180);
+			m_instructions["OR"] = new Z80::InstructionOR(Z180::cpuZ180);
+			m_instructions["XOR"] = new Z80::InstructionXOR(Z180::cpuZ180);
+			m_instructions["CP"] = new Z80::InstructionCP(Z180::cpuZ180);
+			m_instructions["INC"] = new Z80::InstructionINC(Z180::cpuZ180);
+			m_instructions["DEC"] = new Z80::InstructionDEC(Z180::cpuZ180);
+			m_instructions["DAA"] = new Z80::InstructionDAA(Z180::cpuZ180);
+			m_instructions["CPL"] = new Z80::InstructionCPL(Z180::cpuZ180);
+			m_instructions["NEG"] = new Z80::InstructionNEG(Z180::cpuZ180);
+			m_instructions["CCF"] = new Z80::InstructionCCF(Z180::cpuZ180);
+			m_instructions["SCF"] = new Z80::InstructionSCF(Z180::cpuZ180);
+			m_instructions["NOP"] = new Z80::InstructionNOP(Z180::cpuZ180);
+			m_instructions["HALT"] = new Z80::InstructionHALT(Z180::cpuZ180);
+			m_instructions["DI"] = new Z80::InstructionDI(Z180::cpuZ180);
+			m_instructions["EI"] = new Z80::InstructionEI(Z180::cpuZ180);
+			m_instructions["IM"] = new Z80::InstructionIM(Z180::cpuZ180);
+			m_instructions["RLCA"] = new Z80::InstructionRLCA(Z180::cpuZ180);
+			m_instructions["RLA"] = new Z80::InstructionRLA(Z180::cpuZ180);
+			m_instructions["RRCA"] = new Z80::InstructionRRCA(Z180::cpuZ180);
+			m_instructions["RRA"] = new Z80::InstructionRRA(Z180::cpuZ180);
+			m_instructions["RLC"] = new Z80::InstructionRLC(Z180::cpuZ180);
+			m_instructions["RL"] = new Z80::InstructionRL(Z180::cpuZ180);
+			m_instructions["RRC"] = new Z80::InstructionRRC(Z180::cpuZ180);
+			m_instructions["RR"] = new Z80::InstructionRR(Z180::cpuZ180);
+			m_instructions["SLA"] = new Z80::InstructionSLA(Z180::cpuZ180);
+			m_instructions["SLL"] = new Z80::InstructionSLL(Z180::cpuZ180);//undoc
+			m_instructions["SRA"] = new Z80::InstructionSRA(Z180::cpuZ180);
+			m_instructions["SRL"] = new Z80::InstructionSRL(Z180::cpuZ180);
+			m_instructions["RLD"] = new Z80::InstructionRLD(Z180::cpuZ180);
+			m_instructions["RRD"] = new Z80::InstructionRRD(Z180::cpuZ180);
+			m_instructions["BIT"] = new Z80::InstructionBIT(Z180::cpuZ180);
+			m_instructions["SET"] = new Z80::InstructionSET(Z180::cpuZ180);
+			m_instructions["RES"] = new Z80::InstructionRES(Z180::cpuZ180);
+			m_instructions["JP"] = new Z80::InstructionJP(Z180::cpuZ180);
+			m_instructions["JR"] = new Z80::InstructionJR(Z180::cpuZ180);
+			m_instructions["DJNZ"] = new Z80::InstructionDJNZ(Z180::cpuZ180);
+			m_instructions["CALL"] = new Z80::InstructionCALL(Z180::cpuZ180);
+			m_instructions["RET"] = new Z80::InstructionRET(Z180::cpuZ180);
+			m_instructions["RETI"] = new Z80::InstructionRETI(Z180::cpuZ180);
+			m_instructions["RETN"] = new Z80::InstructionRETN(Z180::cpuZ180);
+			m_instructions["RST"] = new Z80::InstructionRST(Z180::cpuZ180);
+			m_instructions["IN"] = new Z80::InstructionIN(Z180::cpuZ180);
+			m_instructions["INI"] = new Z80::InstructionINI(Z180::cpuZ180);
+			m_instructions["INIR"] = new Z80::InstructionINIR(Z180::cpuZ180);
+			m_instructions["IND"] = new Z80::InstructionIND(Z180::cpuZ180);
+			m_instructions["INDR"] = new Z80::InstructionINDR(Z180::cpuZ180);
+			m_instructions["OUT"] = new Z80::InstructionOUT(Z180::cpuZ180);
+			m_instructions["OUTI"] = new Z80::InstructionOUTI(Z180::cpuZ180);
+			m_instructions["OTIR"] = new Z80::InstructionOTIR(Z180::cpuZ180);
+			m_instructions["OUTD"] = new Z80::InstructionOUTD(Z180::cpuZ180);
+			m_instructions["OTDR"] = new Z80::InstructionOTDR(Z180::cpuZ180);
 			// Z-180 specifics
-			m_instructions["MLT"] = new Z180::InstructionMLT();
-			m_instructions["MULT"] = new Z180::InstructionMLT();
-			m_instructions["OTIM"] = new Z180::InstructionOTIM();
-			m_instructions["OTIMR"] = new Z180::InstructionOTIMR();
-			m_instructions["OTDM"] = new Z180::InstructionOTDM();
-			m_instructions["OTDMR"] = new Z180::InstructionOTDMR();
-			m_instructions["IN0"] = new Z180::InstructionIN0();
-			m_instructions["OUT0"] = new Z180::InstructionOUT0();
-			m_instructions["SLP"] = new Z180::InstructionSLP();
-			m_instructions["TST"] = new Z180::InstructionTST();
-			m_instructions["TSTIO"] = new Z180::InstructionTSTIO();
+			m_instructions["MLT"] = new Z180::InstructionMLT(Z180::cpuZ180);
+			m_instructions["MULT"] = new Z180::InstructionMLT(Z180::cpuZ180);
+			m_instructions["OTIM"] = new Z180::InstructionOTIM(Z180::cpuZ180);
+			m_instructions["OTIMR"] = new Z180::InstructionOTIMR(Z180::cpuZ180);
+			m_instructions["OTDM"] = new Z180::InstructionOTDM(Z180::cpuZ180);
+			m_instructions["OTDMR"] = new Z180::InstructionOTDMR(Z180::cpuZ180);
+			m_instructions["IN0"] = new Z180::InstructionIN0(Z180::cpuZ180);
+			m_instructions["OUT0"] = new Z180::InstructionOUT0(Z180::cpuZ180);
+			m_instructions["SLP"] = new Z180::InstructionSLP(Z180::cpuZ180);
+			m_instructions["TST"] = new Z180::InstructionTST(Z180::cpuZ180);
+			m_instructions["TSTIO"] = new Z180::InstructionTSTIO(Z180::cpuZ180);
+
+		}
+		IndexInstructions();
+	}
+	
+	/** Fills the keyword indexed table from the directives map. The names must be listed in Keywords.h. This is only
+	 done by the constructor because the line splitter threads read this table while the assembler works. */
+	void Assembler::IndexDirectives()
+	{
+		for (int keyword = 0 ; keyword < Keywords::COUNT ; keyword++) {
+			m_directivekeywords[keyword] = nullptr;
+		}
+		for (auto &d : m_directives) {
+			int keyword = Keywords::Find(d.first);
+			if (keyword >= 0) m_directivekeywords[keyword] = d.second;
+		}
+	}
 
+	/** Fills the keyword indexed table from the instructions map. The names must be listed in Keywords.h. */
+	void Assembler::IndexInstructions()
+	{
+		for (int keyword = 0 ; keyword < Keywords::COUNT ; keyword++) {
+			m_instructionkeywords[keyword] = nullptr;
+		}
+		for (auto &i : m_instructions) {
+			int keyword = Keywords::Find(i.first);
+			if (keyword >= 0) m_instructionkeywords[keyword] = i.second;
 		}
 	}
 
@@ -1735,21 +2817,28 @@ namespace MUZ {
 	
 	/** Resets the assembler. */
 	void Assembler::Reset() {
-		m_defsymbols.clear();
-		m_reqsymbols.clear();
-		labels.clear();
+		for (auto &f : m_files) delete f;
 		m_files.clear();
-		for (auto &section : m_sections) delete section.second;
-		m_sections.clear();
-		m_status.cursection = nullptr;
-		m_status.finished = false;
-		m_modes = ParsingModeStack();// resets
+		ClearSymbols();
+		m_symbolnames.Clear();
+		m_testedsymbols.clear();
+		// the instruction set is chosen again by the next source
+		for (auto &i : m_instructions) delete i.second;
+		m_instructions.clear();
+		IndexInstructions();
+		m_curlevel = 0;
+		m_status.firstpass = true;
+		m_status.listing = true;
+		m_status.relax = false;
+		m_relaxchanged = false;
+		m_passtwo = false;
 	}
 	
 	/** Enable/Disable all bytes listing or 2-lines listing. */
 	void Assembler::EnableFullListing(bool yes)
 	{
 		m_status.allcodelisting = yes;
+		ClearListingIndex();
 	}
 	
 	/** Enable/Disable trace on standard output. */
@@ -1757,6 +2846,12 @@ namespace MUZ {
 	{
 		m_status.trace = yes;
 	}
+	
+	/** Enable/Disable the fixups replacing the pass 2. */
+	void Assembler::EnableFixups(bool yes)
+	{
+		m_status.fixups = yes;
+	}
 
 	/** Sets the directory where MUZ places the output files and listings. */
 	void Assembler::SetOutputDirectory(std::string directory)
@@ -1767,6 +2862,18 @@ namespace MUZ {
 		}
 	}
 	
+	/** Sets the directory where MUZ keeps the split tokens of the source files, empty to disable the cache. */
+	void Assembler::SetCacheDirectory(std::string directory)
+	{
+		m_lexcache->SetDirectory(directory);
+	}
+	
+	/** Uses a cache shared with other assemblers instead of the own cache of this assembler. */
+	void Assembler::ShareCache(LexCache& cache)
+	{
+		m_lexcache = &cache;
+	}
+	
 	/** Sets the listing filename. */
 	void Assembler::SetListingFilename(std::string filename)
 	{
@@ -1779,6 +2886,24 @@ namespace MUZ {
 		m_binfilename = filename;
 	}
 	
+	/** Sets the value written in the binary output between the assembled address ranges. */
+	void Assembler::SetBinaryFill(DATATYPE fill)
+	{
+		m_binfill = fill;
+	}
+	
+	/** Enable/Disable one binary file per saved section, named after the binary filename and the section. */
+	void Assembler::EnableBinarySections(bool yes)
+	{
+		m_binsections = yes;
+	}
+	
+	/** Gets the names of the binary files written by the last assembly. */
+	const std::vector<std::string>& Assembler::GetBinaryFiles() const
+	{
+		return m_binfiles;
+	}
+	
 	/** Sets the IntelHex filename. */
 	void Assembler::SetIntelHexFilename(std::string filename)
 	{
@@ -1809,6 +2934,12 @@ namespace MUZ {
 		m_logfilename = filename;
 	}
 
+	/** Sets the binary debug information filename. */
+	void Assembler::SetDebugInfoFilename(std::string filename)
+	{
+		m_debugfilename = filename;
+	}
+
 	/** Gets the full listing from current assembling. */
 	Assembler::Listing Assembler::GetListing(ErrorList& msg)
 	{
@@ -1819,6 +2950,52 @@ namespace MUZ {
 		GenerateFileListing(0, msg, result);
 		return result;
 	}
+	
+	/** Gets the number of listing lines of a file, without its included files. */
+	size_t Assembler::GetListingRows(size_t file, ErrorList& msg)
+	{
+		if (file >= m_files.size()) return 0;
+		SourceFile* sourcefile = m_files[file];
+		IndexListing(sourcefile, msg);
+		return sourcefile->listingrows.back();
+	}
+	
+	/** Gets count listing lines of a file from a given row, without its included files. Only the codelines
+	 having rows in the requested part are listed, using the file listing rows index.
+	 @param file the file number
+	 @param firstrow the first listing row to return, 0 for the file path row
+	 @param count the maximum number of listing rows to return
+	 @param msg the error and warning list referenced by the message lines
+	 @return the listing rows, fewer than count at the end of the file listing
+	 */
+	Assembler::Listing Assembler::GetListing(size_t file, size_t firstrow, size_t count, ErrorList& msg)
+	{
+		Listing result;
+		if (file >= m_files.size()) return result;
+		SourceFile* sourcefile = m_files[file];
+		IndexListing(sourcefile, msg);
+		
+		// rows[0] is the file path row, rows[line] is the first row of the line
+		const std::vector<size_t>& rows = sourcefile->listingrows;
+		if (firstrow >= rows.back()) return result;
+		size_t line = (size_t)(std::upper_bound(rows.begin(), rows.end() - 1, firstrow) - rows.begin()) - 1;
+		Listing lines;
+		for ( ; (result.size() < count) && (line + 1 < rows.size()) ; line++) {
+			lines.clear();
+			if (line == 0) {
+				ListingLine fileline;
+				fileline.parts.file = -1;
+				fileline.file = file;
+				lines.Add(fileline);
+			} else {
+				GenerateCodeLineListing(sourcefile->lines[line - 1], msg, lines);
+			}
+			for (size_t row = (firstrow > rows[line]) ? firstrow - rows[line] : 0 ; (row < lines.size()) && (result.size() < count) ; row++) {
+				result.push_back(lines[row]);
+			}
+		}
+		return result;
+	}
 
 	/** Enable/Disable the listings. */
 	void Assembler::EnableListing(bool yes)
@@ -1838,6 +3015,19 @@ namespace MUZ {
 		m_status.finished = true;
 	}
 
+	/** Enable/Disable the choice of the JP or JR form for the jumps. */
+	void Assembler::EnableRelax(bool yes)
+	{
+		m_status.relax = yes;
+	}
+
+	/** Chooses the form of a relaxed jump for the next assembly, the files will be assembled again if it changes. */
+	void Assembler::RelaxJump(CodeLine& codeline, JumpForm form)
+	{
+		if (form != codeline.jump.next) m_relaxchanged = true;
+		codeline.jump.next = form;
+	}
+
 
 	//MARK: - Sections and current address management
 	
@@ -1878,8 +3068,14 @@ namespace MUZ {
 		if (advance) {
 			// touch current address to just before current address
 			DWORD start = GetAddress();
-			for (size_t i = 0 ; i < advance ; i++)
-				 SetAddress((ADDRESSTYPE)(ADDRESSMASK & (start + i)));
+			if ((ADDRESSMASK & start) + advance - 1 <= ADDRESSMASK) {
+				if (m_status.cursection == nullptr) SetCodeSection();
+				m_status.cursection->SetRange(ADDRESSMASK & start, (ADDRESSMASK & start) + advance - 1);
+			} else {
+				// wraps around the address space
+				for (size_t i = 0 ; i < advance ; i++)
+					 SetAddress((ADDRESSTYPE)(ADDRESSMASK & (start + i)));
+			}
 			// set new current address
 			m_status.cursection->m_curaddress = start + advance;
 		}
@@ -1952,6 +3148,8 @@ namespace MUZ {
 	{
 		SetFirstPass(true);
 		msg.Clear();							// clear warnings
+		m_relaxchanged = false;
+		ClearListingIndex();
 		if (m_status.trace)	printf("Pass 1: %s\n", file.c_str());
 		ErrorType result = errorTypeFALSE;
 		try {
@@ -1961,10 +3159,10 @@ namespace MUZ {
 				if (m_status.trace) printf("Pass 2: %s\n", file.c_str());
 				result = AssembleMainFilePassTwo(file, msg);
 			}
+			result = RelaxLayout(result, msg);
 
 			// output listings anyway
-			Listing listing = GetListing(msg);
-			SaveListing(listing, m_listingfilename, msg);
+			WriteListing(msg);
 
 			if (result != errorTypeFATAL) {
 				// first build memory image and a section with all the written address ranges
@@ -1979,6 +3177,12 @@ namespace MUZ {
 				// Output Intel Hex format
 				GenerateIntelHex(memory, section, mergingMsg);
 
+				// Output raw binary images
+				GenerateBinary(memory, section, mergingMsg);
+
+				// Output debug information
+				GenerateDebugInfo(mergingMsg);
+
 				// clean memory work image
 				free(memory);
 			}
@@ -1992,6 +3196,59 @@ namespace MUZ {
 		return result;
 	}
 
+	/** Replaces lines in a source file of the current assembly and updates the assembly without reading the files.
+	 Lines which only hold instructions or data keep their size and do not change any symbol are assembled again alone,
+	 at their address. Other edits assemble again all the lines kept by the current assembly: only the new lines are
+	 split into tokens, and the expressions compiled for the other lines are reused.
+	 The output files are not written, GetListing() gives the updated listing.
+	 @param file the index of the source file
+	 @param firstline the number of the first line to replace, from 1
+	 @param nblines the number of lines to replace, 0 to insert the new lines before the first line
+	 @param newlines the new source lines
+	 @param msg the list of messages and warnings for the current assembly, updated
+	 @return the assembly result, errorTypeFATAL for invalid parameters
+	 */
+	ErrorType Assembler::UpdateLines(size_t file, size_t firstline, size_t nblines, const std::vector<std::string>& newlines, ErrorList& msg)
+	{
+		// basic security
+		if (file >= m_files.size()) return errorTypeFATAL;
+		SourceFile* sourcefile = m_files[file];
+		std::vector<CodeLine>& lines = sourcefile->lines;
+		if ((firstline < 1) || (firstline - 1 + nblines > lines.size())) return errorTypeFATAL;
+		if (!lines.empty() && lines[0].rawdata) return errorTypeFATAL;
+		if (sourcefile->expansion) return errorTypeFATAL;
+		ClearListingIndex();
+		
+		// the lines replaced one by one are tried alone
+		if (nblines == newlines.size()) {
+			bool local = true;
+			for (size_t line = firstline - 1 ; local && (line < firstline - 1 + nblines) ; line++) {
+				local = IsLocalLine(lines[line]);
+			}
+			if (local) {
+				// forget the messages about these lines
+				msg.erase(std::remove_if(msg.begin(), msg.end(), [&](ErrorMessage& m) {
+					return (m.file == file) && (m.line >= firstline) && (m.line < firstline + nblines);
+				}), msg.end());
+				for (size_t i = 0 ; local && (i < nblines) ; i++) {
+					CodeLine& cl = lines[firstline - 1 + i];
+					cl.source = newlines[i];
+					local = ReassembleLine(cl, msg);
+				}
+				if (local) return errorTypeOK;
+			}
+		}
+		
+		// replace the lines and assemble everything again
+		lines.erase(lines.begin() + (long)(firstline - 1), lines.begin() + (long)(firstline - 1 + nblines));
+		std::vector<CodeLine> inserted(newlines.size());
+		for (size_t i = 0 ; i < newlines.size() ; i++) {
+			inserted[i].source = newlines[i];
+		}
+		lines.insert(lines.begin() + (long)(firstline - 1), inserted.begin(), inserted.end());
+		return RelaxLayout(ReassembleFiles(msg), msg);
+	}
+	
 	/** Get the name of a file from its index. */
 	std::string Assembler::GetFileName(size_t index)
 	{
@@ -1999,39 +3256,63 @@ namespace MUZ {
 		return m_files[index]->filepath + "/" + m_files[index]->filename;
 	}
 	
+	/** Get the number of files in the current assembly, including the #INSERTHEX and #INSERTBIN files and the macro expansions. */
+	size_t Assembler::GetFilesCount()
+	{
+		return m_files.size();
+	}
+	
 	//MARK: - Interface to instructions, labels, directives, symbols
 	
 	/** Try to find a directive in the # and . directives array. */
-	Directive* Assembler::GetDirective(std::string name)
+	Directive* Assembler::GetDirective(const std::string& name)
 	{
-		name = std::to_upper(name);
-		if (m_directives.count(name))
-			return m_directives[name];
-		return nullptr;
+		return GetDirective(Keywords::Find(name));
+	}
+	
+	/** Try to find a directive from its keyword index. */
+	Directive* Assembler::GetDirective(int keyword)
+	{
+		return (keyword >= 0) ? m_directivekeywords[keyword] : nullptr;
 	}
 	
 	/** Try to find an instruction in the instruction set.  */
-	Instruction* Assembler::GetInstruction(std::string name)
+	Instruction* Assembler::GetInstruction(const std::string& name)
 	{
-		name = std::to_upper(name);
-		if (m_instructions.count(name))
-			return m_instructions[name];
-		return nullptr;
+		return GetInstruction(Keywords::Find(name));
+	}
+	
+	/** Try to find an instruction from its keyword index. */
+	Instruction* Assembler::GetInstruction(int keyword)
+	{
+		return (keyword >= 0) ? m_instructionkeywords[keyword] : nullptr;
+	}
+	
+	/** Returns the symbol id for a name, giving a new one to unknown names. */
+	SYMBOLID Assembler::InternSymbol(const std::string& name)
+	{
+		return m_symbolnames.Intern(name);
 	}
 	
 	/** Try to find a named label in local or global labels. */
 	Label* Assembler::GetLabel(std::string name)
 	{
+		return GetLabel(m_symbolnames.Find(name));
+	}
+	
+	/** Try to find a label by its symbol id in local or global labels. Local labels are searched in the scope of the last global label. */
+	Label* Assembler::GetLabel(SYMBOLID symbol)
+	{
+		const std::string& name = m_symbolnames.Name(symbol);
 		if (name.empty()) return nullptr;
 		if (name[0] == '@') {
-			string fullname = GetLastLabelName() + name;
-			if (m_files[m_status.curfile]->labels.count(fullname)) {
-				return m_files[m_status.curfile]->labels[fullname];
+			auto& scopes = m_files[m_status.curfile]->labels;
+			auto scope = scopes.find(m_status.lastlabel);
+			if (scope != scopes.end()) {
+				return scope->second.Get(symbol);
 			}
 		} else {
-			if (labels.count(name)) {
-				return labels[name];
-			}
+			return labels.Get(symbol);
 		}
 		return nullptr;
 	}
@@ -2043,10 +3324,9 @@ namespace MUZ {
 	DefSymbol* Assembler::CreateDefSymbol(std::string name, std::string value)
 	{
 		// Check if the name exists
-		DefSymbol* defsymbol = nullptr;
-		if (m_defsymbols.count(name)) {
-			defsymbol = m_defsymbols[name];
-		}
+		SYMBOLID id = InternSymbol(name);
+		ChangeSymbol(id);
+		DefSymbol* defsymbol = m_defsymbols.Get(id);
 		if (!defsymbol) defsymbol = new DefSymbol();
 		if (!defsymbol) throw OutOfMemoryException();
 		// check if the value is empty and if so, define the symbol as an empty but true defsymbol
@@ -2058,26 +3338,26 @@ namespace MUZ {
 			defsymbol->singledefine = false;
 		}
 		// do the assignment
-		m_defsymbols[name] = defsymbol;
+		m_defsymbols.Set(id, defsymbol);
 		return defsymbol;
 	}
 	
 	/** Delete a #DEFINE symbol. */
 	bool Assembler::DeleteDefSymbol(std::string name)
 	{
-		if (m_defsymbols.count(name)) {
-			m_defsymbols.erase(name);
-			return true;
-		}
-		return false;
+		SYMBOLID id = m_symbolnames.Find(name);
+		ChangeSymbol(id);
+		DefSymbol* defsymbol = m_defsymbols.Remove(id);
+		delete defsymbol;
+		return defsymbol != nullptr;
 	}
 	
 	/** Check if a symbol is #DEFINEd.*/
 	bool Assembler::ExistDefSymbol(std::string name)
 	{
-		if (m_defsymbols.count(name))
-			return true;
-		return false;
+		SYMBOLID id = IsFirstPass() ? InternSymbol(name) : m_symbolnames.Find(name);
+		TestSymbol(id);
+		return m_defsymbols.Get(id) != nullptr;
 	}
 	
 	/** Create a #REQUIRES symbol
@@ -2085,35 +3365,34 @@ namespace MUZ {
 	DefSymbol* Assembler::CreateReqSymbol(std::string name)
 	{
 		// Check if the name exists
-		DefSymbol* reqsymbol = nullptr;
-		if (m_reqsymbols.count(name)) {
-			reqsymbol = m_reqsymbols[name];
-		}
+		SYMBOLID id = InternSymbol(name);
+		ChangeSymbol(id);
+		DefSymbol* reqsymbol = m_reqsymbols.Get(id);
 		if (!reqsymbol) reqsymbol = new DefSymbol();
 		if (!reqsymbol) throw OutOfMemoryException();
 		reqsymbol->value.clear();
 		reqsymbol->singledefine = true;
 		// do the assignment
-		m_reqsymbols[name] = reqsymbol;
+		m_reqsymbols.Set(id, reqsymbol);
 		return reqsymbol;
 	}
 	
 	/** Delete a #REQUIRES symbol. */
 	bool Assembler::DeleteReqSymbol(std::string name)
 	{
-		if (m_reqsymbols.count(name)) {
-			m_reqsymbols.erase(name);
-			return true;
-		}
-		return false;
+		SYMBOLID id = m_symbolnames.Find(name);
+		ChangeSymbol(id);
+		DefSymbol* reqsymbol = m_reqsymbols.Remove(id);
+		delete reqsymbol;
+		return reqsymbol != nullptr;
 	}
 	
 	/** Check if a symbol is #REQUIREd.*/
 	bool Assembler::ExistReqSymbol(std::string name)
 	{
-		if (m_reqsymbols.count(name))
-			return true;
-		return false;
+		SYMBOLID id = IsFirstPass() ? InternSymbol(name) : m_symbolnames.Find(name);
+		TestSymbol(id);
+		return m_reqsymbols.Get(id) != nullptr;
 	}
 
 
@@ -2124,17 +3403,18 @@ namespace MUZ {
 	 */
 	bool Assembler::ReplaceDefSymbol(ParseToken& token)
 	{
-		if (m_defsymbols.count(token.source)) {
-			auto defsymbol = m_defsymbols[token.source];
-			if (defsymbol) {
-				if (defsymbol->singledefine) {
-					token.source = "t";
-					token.type = tokenTypeBOOL;
-				} else {
-					token.source = defsymbol->value;
-					token.type = tokenTypeSTRING;
-				}
+		SYMBOLID id = token.symbol ? token.symbol : m_symbolnames.Find(token.source);
+		TestSymbol(id);
+		DefSymbol* defsymbol = m_defsymbols.Get(id);
+		if (defsymbol) {
+			if (defsymbol->singledefine) {
+				token.source = "t";
+				token.type = tokenTypeBOOL;
+			} else {
+				token.source = defsymbol->value;
+				token.type = tokenTypeSTRING;
 			}
+			token.symbol = 0;
 			return true;
 		}
 		return false; // not found
@@ -2143,13 +3423,13 @@ namespace MUZ {
 
 	/** Try to replace a symbol from the Label table. Returns closest address if this is a local label with more than one address. Returns false if the label
 	 doesn't exist or has no address yet. */
-	bool Assembler::ReplaceLabel(std::string& source)
+	bool Assembler::ReplaceLabel(ParseToken& token)
 	{
 		// local label?
-		if (source.empty()) return false;
-		Label* label = GetLabel(source);
+		if (token.source.empty()) return false;
+		Label* label = token.symbol ? GetLabel(token.symbol) : GetLabel(token.source);
 		if (label && !label->empty()) {
-			source = std::to_string(label->AddressFrom(GetAddress())); // std::to_string() extension at the top of this file
+			token.setNumber(label->AddressFrom(GetAddress()));
 			return true;
 		}
 		return false;
@@ -2195,107 +3475,163 @@ namespace MUZ {
 	/** Save a memory listing to a text file. Use "stdout" to just print on standard output. */
 	ErrorType Assembler::SaveListing( Listing & listing, FILE* file, ErrorList& msg )
 	{
-		FILE* output = (file == nullptr ? stdout : file);
-		int leftpartsize = 22;
-
-		// when this flag is set, finish listing by writing only the line.parts.file lines
-		ErrorType error = errorTypeOK;
+		ListingWriter writer(*this, file, msg);
 		for (auto & line : listing) {
+			writer.Add(line);
+		}
+		return writer.Flush();
+	}
 
-			SourceFile* sourcefile = m_files[line.file];
-			string s;
-			// display a file path?
-			if (line.parts.file ) {
-				string mainfile = sourcefile->fileprefix + sourcefile->filepath + NORMAL_DIR_SEPARATOR + sourcefile->filename;
-				// condense if following a fatal error
-				if (error == errorTypeFATAL) {
-					s = spaces(leftpartsize) + mainfile + "\n";
-				} else {
-					s ="\n" + spaces(leftpartsize) + mainfile + "\n\n";
-				}
-				fprintf(output, "%s", s.c_str());
-			} else if ((error != errorTypeFATAL) && line.parts.message) {
-				// display a warning or error
-				ErrorMessage & m =  msg.at((size_t)line.message);
-				CodeLine& codeline = sourcefile->lines.at(m.line - 1);
-				string prefix = spaces(leftpartsize);
-				if (m.type == MUZ::errorTypeWARNING) {
-					prefix += "      Warning W";
-				} else if (m.type == MUZ::errorTypeERROR) {
-					prefix += "      Error E";
-				} else if (m.type == MUZ::errorTypeFATAL) {
-					prefix += "      FATAL F";
-				}
-				if (m.token >= 0 && m.token < codeline.tokens.size()) {
-					fprintf(output, "%s%04d: '%s': %s\n", prefix.c_str(), m.kind, codeline.tokens[m.token].source.c_str(), msg.GetMessage(m.kind).c_str());
-				} else {
-					fprintf(output, "%s%04d: %s\n", prefix.c_str(), m.kind, msg.GetMessage(m.kind).c_str());
-				}
-				// carry the error type
-				error = m.type;
-			} else if (error != errorTypeFATAL) {
-				if ( ! line.defsymbol.empty()) {
-					if (ExistDefSymbol(line.defsymbol)) {
-						DefSymbol* defsymbol = m_defsymbols[line.defsymbol];
-						if (defsymbol->singledefine) {
-							s = spaces(leftpartsize-2) + "* ";
-						} else {
-							s = string("*") + defsymbol->value.substr(0,(size_t)leftpartsize-3);
-							if (s.length() < (size_t)leftpartsize-2) s += spaces(leftpartsize-2 - (int)s.length());
-							s += "* ";
-						}
-					} else if (ExistReqSymbol(line.defsymbol)) {
-						s = spaces(leftpartsize-2) + "* ";
-					}
-				} else {
-					if (line.parts.address) {
-						int digits = 4;
-						if (line.address > 0xFFFF) {
-							digits = 8;
-						}
-						s = spaces(8-digits) + address_to_base(line.address, 16, digits);
+	//MARK: - Listing output
 
-						if (line.parts.warnaddress) {
-							s += "? ";
-						} else {
-							s += ": ";
-						}
+	/** Size of the formatted text written to the listing file at once. */
+	static const size_t LISTINGBUFFERSIZE = 65536;
+
+	/** Generates the listing of the current assembling directly in the listing file, without keeping the lines
+	 in memory. The tables follow the lines unless a fatal error stopped the assembly. */
+	void Assembler::WriteListing(ErrorList& msg)
+	{
+		FILE* file = PrepareListing(msg);
+		if (file) {
+			ListingWriter writer(*this, file, msg);
+			GenerateFileListing(0, msg, writer);
+			if (writer.Flush() == errorTypeOK) {
+				SaveTables(file);
+			} else {
+				perror("fopen failed? ");
+			}
+			CloseListing(file);
+		}
+	}
+
+	/** Appends the text of a listing line to a string.
+	 @param line the listing line to format
+	 @param msg the error and warning list referenced by the message lines
+	 @param error the type of the last message listed, the lines following a fatal error only show the file paths
+	 @param text the string receiving the formatted line and its ending new line
+	 */
+	void Assembler::FormatListingLine(const ListingLine& line, ErrorList& msg, ErrorType& error, std::string& text)
+	{
+		const size_t leftpartsize = 22;
+		SourceFile* sourcefile = m_files[line.file];
+		// display a file path?
+		if (line.parts.file ) {
+			// condense if following a fatal error
+			if (error != errorTypeFATAL) text += '\n';
+			text.append(leftpartsize, ' ');
+			text += sourcefile->fileprefix;
+			text += sourcefile->filepath;
+			text += NORMAL_DIR_SEPARATOR;
+			text += sourcefile->filename;
+			text += (error == errorTypeFATAL) ? "\n" : "\n\n";
+		} else if ((error != errorTypeFATAL) && line.parts.message) {
+			// display a warning or error
+			ErrorMessage & m =  msg.at((size_t)line.message);
+			CodeLine& codeline = sourcefile->lines.at(m.line - 1);
+			text.append(leftpartsize, ' ');
+			if (m.type == MUZ::errorTypeWARNING) {
+				text += "      Warning W";
+			} else if (m.type == MUZ::errorTypeERROR) {
+				text += "      Error E";
+			} else if (m.type == MUZ::errorTypeFATAL) {
+				text += "      FATAL F";
+			}
+			char kind[16];
+			snprintf(kind, sizeof(kind), "%04d: ", m.kind);
+			text += kind;
+			if (m.token >= 0 && m.token < codeline.tokens.size()) {
+				text += "'" + codeline.tokens[m.token].asString() + "': ";
+			}
+			text += msg.GetMessage(m.kind);
+			text += '\n';
+			// carry the error type
+			error = m.type;
+		} else if (error != errorTypeFATAL) {
+			size_t start = text.size();
+			if ( ! line.defsymbol.empty()) {
+				if (ExistDefSymbol(line.defsymbol)) {
+					DefSymbol* defsymbol = m_defsymbols.Get(m_symbolnames.Find(line.defsymbol));
+					if (defsymbol->singledefine) {
+						text.append(leftpartsize - 2, ' ');
 					} else {
-						if (line.parts.warnaddress) {
-							s += "??" + spaces(8);
-						} else {
-							s = spaces(10);
-						}
-					}
-					if (line.parts.code) {
-						s += line.codebytes;
+						text += '*';
+						text.append(defsymbol->value, 0, leftpartsize - 3);
+						if (text.size() - start < leftpartsize - 2) text.append(leftpartsize - 2 - (text.size() - start), ' ');
 					}
-					s += spaces(leftpartsize - (int)s.length());
+					text += "* ";
+				} else if (ExistReqSymbol(line.defsymbol)) {
+					text.append(leftpartsize - 2, ' ');
+					text += "* ";
 				}
-				if (line.parts.line) {
-					string linenum = std::to_string(line.line);
-					while (linenum.length() < 4) {
-						linenum = "0" + linenum;
+			} else {
+				if (line.parts.address) {
+					int digits = (line.address > 0xFFFF) ? 8 : 4;
+					text.append((size_t)(8 - digits), ' ');
+					for (int shift = (digits - 1) * 4 ; shift >= 0 ; shift -= 4) {
+						text += hexDigits[(line.address >> shift) & 0x0F];
 					}
-					s += linenum + spaces(2);
+					text += line.parts.warnaddress ? "? " : ": ";
+				} else if (line.parts.warnaddress) {
+					text += "??";
+					text.append(8, ' ');
 				} else {
-					s += spaces(6);
-				}
-				if (line.parts.source) {
-					s += line.source;
+					text.append(10, ' ');
 				}
-				if (line.parts.comment) {
-					s += line.comment;
+				if (line.parts.code) {
+					text += line.codebytes;
 				}
-				fprintf(output, "%s\n", s.c_str());
+				if (text.size() - start < leftpartsize) text.append(leftpartsize - (text.size() - start), ' ');
 			}
-
+			if (line.parts.line) {
+				char linenum[24];
+				snprintf(linenum, sizeof(linenum), "%04zu  ", line.line);
+				text += linenum;
+			} else {
+				text.append(6, ' ');
+			}
+			if (line.parts.source) {
+				text += line.source;
+			}
+			if (line.parts.comment) {
+				text += line.comment;
+			}
+			text += '\n';
 		}
-		return error;
+	}
 
+	//MARK: - Assembler::ListingWriter class
+
+	/** Prepares writing to an opened file, the standard output if file is nullptr. */
+	Assembler::ListingWriter::ListingWriter(Assembler& as, FILE* file, ErrorList& msg)
+	: m_as(as), m_msg(msg), m_file(file == nullptr ? stdout : file)
+	{
+		m_buffer.reserve(LISTINGBUFFERSIZE + 1024);
 	}
 
+	/** Writes the lines not written yet. */
+	Assembler::ListingWriter::~ListingWriter()
+	{
+		Flush();
+	}
 
+	/** Formats the line in the buffer, writes the buffer when it is full. */
+	void Assembler::ListingWriter::Add(const ListingLine& line)
+	{
+		m_as.FormatListingLine(line, m_msg, m_error, m_buffer);
+		if (m_buffer.size() >= LISTINGBUFFERSIZE) {
+			Flush();
+		}
+	}
+
+	/** Writes the buffer, returns the type of the last message listed. */
+	ErrorType Assembler::ListingWriter::Flush()
+	{
+		if (!m_buffer.empty()) {
+			fwrite(m_buffer.data(), 1, m_buffer.size(), m_file);
+			m_buffer.clear();
+		}
+		return m_error;
+	}
 
 } // namespace MUZ
 
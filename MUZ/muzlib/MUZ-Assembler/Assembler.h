@@ -16,14 +16,17 @@
 
 #include "MUZ-Common/Types.h"
 #include "MUZ-Common/Exceptions.h"
+#include "MUZ-Common/SourceText.h"
 
 #include "ParsingMode.h"
 #include "Errors.h"
+#include "Symbols.h"
 #include "Label.h"
 #include "DefSymbol.h"
 #include "Directive.h"
 #include "ExpVector.h"
 #include "CodeLine.h"
+#include "LexCache.h"
 
 namespace MUZ {
 	
@@ -78,10 +81,21 @@ namespace MUZ {
 			size_t token = 0;
 		};
 
-		// Contains a ready to use listing
-		struct Listing : public std::vector<ListingLine>
+		/** Receiver for the listing lines, given one at a time in the listing order as they are generated. */
+		struct ListingSink
+		{
+			virtual ~ListingSink() {}
+			/** Receives the next listing line. */
+			virtual void Add(const ListingLine& line) = 0;
+		};
+
+		// Contains a ready to use listing, a sink keeping all the lines in memory
+		struct Listing : public std::vector<ListingLine>, public ListingSink
 		{
 			// contains all lines
+			void Add(const ListingLine& line) override {
+				push_back(line);
+			}
 		};
 
 		//MARK: - Private management structures
@@ -89,18 +103,28 @@ namespace MUZ {
 		struct SourceFile
 		{
 			bool		included = false; 	// true for #INCLUDEd files
+			bool		expansion = false;	// true for the lines expanded from a macro or a .REPT block
 			size_t		parentfile = 0;		// if included, parent file reference
 			size_t		parentline = 0;		// if included, line number in parent file
 			SourceFile*	parent = nullptr;	// if included, parent source file
 			std::string	fileprefix;			// Windows specific prefixes
 			std::string	filepath;			// path part of the file
 			std::string	filename;			// filename part of the file
+			SourceText	text;				// source content, mapped and split into lines when opened
 			std::vector<CodeLine> lines;	// parsed/assembled content, matches the source file lines
-			LabelMap	labels;				// local labels
+			std::unordered_map<SYMBOLID, SymbolScope<Label>> labels;	// local labels, by last global label
+			std::vector<CodeLine> unread;	// lines after a .END directive, kept for UpdateLines()
+			std::vector<size_t> listingrows;// first listing row of each line after the file path row, then the rows count
+			
+			/** Deletes the local labels. */
+			~SourceFile();
 			
 			/** Gets the root parent of this SourceFile. */
 			SourceFile* Root();
 			
+			/** Returns the full path of this SourceFile. */
+			std::string Path() const;
+			
 			/** Sets this SourceFile from the given filename and parent. Set parent to NULL to set a main source file. */
 			ErrorType Set(std::string file, SourceFile* parent);
 		};
@@ -111,23 +135,58 @@ namespace MUZ {
 		friend class DirectiveINSERTHEX;
 		// The #INSERTBIN directive uses Assembler::AssembleBinFile private function
 		friend class DirectiveINSERTBIN;
+		// The .MACRO, .ENDM, .REPT and .ENDR directives record and expand the blocks of lines
+		friend class DirectiveMACRO;
+		friend class DirectiveENDM;
+		friend class DirectiveREPT;
+		friend class DirectiveENDR;
+
+		/** Block of lines recorded by a .MACRO or .REPT directive. The body lines keep the tokens split by pass 1,
+		 each expansion copies them with the parameters replaced by the arguments instead of splitting the lines again. */
+		struct Macro
+		{
+			SYMBOLID				name = 0;			// macro name, 0 for a .REPT block
+			std::vector<SYMBOLID>	parameters;			// parameter names
+			std::vector<CodeLine>	body;				// recorded lines, with their split tokens in lexedtokens
+			bool					repeat = false;		// true for a .REPT block
+			DWORD					count = 1;			// number of expansions of the body
+			Macro*					previous = nullptr;	// macro replaced by this one, kept for its running expansions
+
+			/** Deletes the replaced macros. */
+			~Macro();
+		};
 
 		// Map tables for the instruction set and directives
 		InstructionsMap				m_instructions;
 		DirectivesMap				m_directives;
+		// Same tables indexed by keyword, filled by IndexDirectives() and IndexInstructions()
+		Instruction*				m_instructionkeywords[Keywords::COUNT];
+		Directive*					m_directivekeywords[Keywords::COUNT];
 		
 		// Tables for the assembly
 
+		/** Interned names for all the symbols, the tables below are indexed by symbol id. */
+		SymbolNames					m_symbolnames;
 		/** Table for all the #DEFINE symbols. */
-		DefSymbolsMap				m_defsymbols;
+		SymbolTable<DefSymbol>		m_defsymbols;
 		/** Table for all the #REQUIRES symbols. */
-		DefSymbolsMap				m_reqsymbols;
+		SymbolTable<DefSymbol>		m_reqsymbols;
 		/** Table for all the global labels. */
-		LabelMap					labels;
+		SymbolTable<Label>			labels;
+		/** Table for all the macros. */
+		SymbolTable<Macro>			m_macros;
 		/** Table for each files, [0] is the main file, following are the included files in their inclusion order. */
 		std::vector<SourceFile*>	m_files;
 		/** Map of all sections. Default names are CODE and DATA for the .CODE and .DATA section. */
 		std::unordered_map<std::string, Section*> m_sections;
+		/** Parsers for the code lines, one for each #INCLUDE level because a line including a file is still being
+		 assembled while the included file lines are. Each parser is reused by all the lines at its level. */
+		std::vector<class Parser*>	m_parsers;
+		/** Number of parsers currently used by AssembleCodeLine. */
+		size_t						m_parserlevel = 0;
+		/** Files of the previous assembly while UpdateLines() assembles again, their lines are used instead of
+		 reading the files. */
+		std::vector<SourceFile*>	m_storedfiles;
 
 		// Stack for imbricated #IF conditionnal modes
 
@@ -144,8 +203,8 @@ namespace MUZ {
 			bool		firstpass  = true;
 			/** Number of current file, should always be the last in the m_files array. */
 			size_t		curfile		= 0;
-			/** Last global label, used as a prefix for local labels starting with '@'. */
-			std::string	lastlabel;
+			/** Last global label, used as the scope for local labels starting with '@'. */
+			SYMBOLID	lastlabel	= 0;
 			/** Flag to activate debug trace on standard output. */
 			bool		trace		= false;
 			/** Flag to list all bytes of a line, false to limit to 2 lines of listing. */
@@ -154,7 +213,34 @@ namespace MUZ {
 			bool		listing    = true;
 			/** flag to terminate assembly (.END directive) */
 			bool		finished = false;
+			/** Flag to let the assembler choose the JP or JR form of the jumps (directive .RELAX ON/OFF). */
+			bool		relax = false;
+			/** Flag to assemble again only the fixup lines instead of running the whole pass 2 when possible. */
+			bool		fixups = true;
 		} m_status;
+		/** State of the .MACRO or .REPT block being recorded. Pass 1 records the lines, pass 2 and the blocks in error
+		 only skip them. */
+		struct Recording {
+			/** Set while the lines are recorded or skipped. */
+			bool		active = false;
+			/** Set for a .REPT block. */
+			bool		repeat = false;
+			/** Number of blocks opened by the recorded lines, their closing directives are recorded too. */
+			size_t		level = 0;
+			/** File and line of the directive opening the block. */
+			size_t		file = 0;
+			size_t		line = 0;
+			/** Block receiving the lines, nullptr to skip them. A .REPT block is owned by the recording. */
+			Macro*		macro = nullptr;
+		} m_recording;
+		/** Number of imbricated expansions being assembled by pass 1. */
+		size_t						m_expansiondepth = 0;
+		/** Set when the pass 2 has chosen another form for a relaxed jump, the files must be assembled again. */
+		bool						m_relaxchanged = false;
+		/** Set by pass 1 when some lines other than the fixup lines can be assembled differently by the pass 2. */
+		bool						m_passtwo = false;
+		/** #DEFINE and #REQUIRES symbols tested by pass 1, by symbol id. */
+		std::vector<bool>			m_testedsymbols;
 		
 		//MARK: - Private Output directory and file names
 		/** root output directory for all files */
@@ -171,24 +257,73 @@ namespace MUZ {
 		std::string					m_symbolsfilename;
 		/** file name for errors/warnings log */
 		std::string					m_logfilename;
+		/** file name for the binary debug information */
+		std::string					m_debugfilename;
 		/** Number of bytes in HEX output */
 		ADDRESSTYPE					m_hexbytes = 0x10;
+		/** Value written in the binary output for the addresses not assembled between two ranges */
+		DATATYPE					m_binfill = 0xFF;
+		/** Set to write one binary file per saved section instead of a single image */
+		bool						m_binsections = false;
+		/** Names of the binary files written by the last assembly */
+		std::vector<std::string>	m_binfiles;
+		/** Cache of the split tokens for the source files */
+		LexCache					m_owncache;
+		/** Cache in use, the own cache or a cache shared with other assemblers */
+		LexCache*					m_lexcache = &m_owncache;
+
+		/** Listing sink formatting each line in a reusable buffer, written to the listing file in large blocks. */
+		class ListingWriter : public ListingSink
+		{
+			Assembler&		m_as;
+			ErrorList&		m_msg;
+			FILE*			m_file;
+			std::string		m_buffer;				// formatted lines not written yet
+			ErrorType		m_error = errorTypeOK;	// type of the last message listed
+		public:
+			ListingWriter(Assembler& as, FILE* file, ErrorList& msg);
+			~ListingWriter();
+			/** Formats the line in the buffer, writes the buffer when it is full. */
+			void Add(const ListingLine& line) override;
+			/** Writes the buffer, returns the type of the last message listed. */
+			ErrorType Flush();
+		};
 
 		//MARK: - Private Assembler functions
+		/** Fills the keyword indexed table from the directives map. */
+		void IndexDirectives();
+		/** Fills the keyword indexed table from the instructions map. */
+		void IndexInstructions();
 		/** Assembles a prepared code line. */
 		ErrorType AssembleCodeLine(CodeLine& codeline, ErrorList& msg);
 		/** Initializes listing file, closes previous if any. */
 		FILE* PrepareListing(ErrorList& msg);
 		/** Closes the listing file, ignore if the name is "stdout". */
 		void CloseListing( FILE* & file );
-		/** Generates a listing line for an assembled codeline. */
-		void GenerateCodeLineListing(CodeLine& codeline, ErrorList& msg, Listing & listing);
+		/** Generates the listing lines for an assembled codeline. */
+		void GenerateCodeLineListing(CodeLine& codeline, ErrorList& msg, ListingSink & listing);
+		/** Appends the text of a listing line to a string, error carries the type of the last message listed. */
+		void FormatListingLine(const ListingLine& line, ErrorList& msg, ErrorType& error, std::string& text);
+		/** Generates the listing of the current assembling directly in the listing file. */
+		void WriteListing(ErrorList& msg);
 		/** Initializes memory listing file, close previous if any. */
 		void GenerateMemoryDump(DATATYPE* memory, Section& section, ErrorList& msg);
 		/** Generates Intel HEX output. */
 		void GenerateIntelHex(DATATYPE* memory, Section& section, ErrorList& msg);
-		/** Generates in-memory file listing from current assembling. */
-		void GenerateFileListing(size_t file, ErrorList& msg, Listing & listing);
+		/** Generates the raw binary output, a single image or one file per saved section. */
+		void GenerateBinary(DATATYPE* memory, Section& section, ErrorList& msg);
+		/** Writes address ranges in a binary file, filling the gaps between them. */
+		void WriteBinaryImage(std::string name, DATATYPE* memory, std::vector<AddressRange>& ranges, ErrorList& msg);
+		/** Generates the binary debug information file. */
+		void GenerateDebugInfo(ErrorList& msg);
+		/** Generates the listing lines of a file and its included files from current assembling. */
+		void GenerateFileListing(size_t file, ErrorList& msg, ListingSink & listing);
+		/** Returns the number of listing lines generated for a codeline. */
+		size_t CountCodeLineListing(const CodeLine& codeline);
+		/** Builds the listing rows index of a file if it is not built yet. */
+		void IndexListing(SourceFile* sourcefile, ErrorList& msg);
+		/** Forgets the listing rows index of all the files, the listing of the lines has changed. */
+		void ClearListingIndex();
 		/** Generate the sections list in an opened file. */
 		void GenerateSectionsList( FILE* file );
 		/** Generates the #DEFINE symbols list in an opened file. */
@@ -199,6 +334,10 @@ namespace MUZ {
 		void GenerateEquatesList( FILE* file );
 		/** Generates the global labels in an opened file. */
 		void GenerateLabelsList( FILE* file );
+		/** Generates the list of the jumps changed by the .RELAX mode in an opened file. */
+		void GenerateRelaxedJumpsList( FILE* file );
+		/** Text of the bytes and T-states saved by the .RELAX mode, empty if no jump has been changed. */
+		std::string RelaxedJumpsSummary();
 		/** List tables in an opened file. */
 		void SaveTables( FILE* file );
 		/** Fills a memory image and lists of sections from an assembled source file. */
@@ -252,6 +391,58 @@ namespace MUZ {
 		ErrorType AssembleHexFile(std::string file, CodeLine& codeline, ErrorList& msg);
 		/** Assembles a binary included file. */
 		ErrorType AssembleBinFile(std::string file, CodeLine& codeline, ErrorList& msg);
+		/** Stores a line of data from an HEX or binary included file, with its code already set. */
+		void AddDataLine(SourceFile* sourcefile, size_t filenum, const DATATYPE* data, size_t nbbytes);
+		/** Takes the lines stored by the previous assembly for a file, returns false if the file has not been stored. */
+		bool TakeStoredLines(size_t filenum, const std::string& path, std::vector<CodeLine>& lines);
+
+		//MARK: - Private incremental assembling
+		
+		/** Tells if an assembled line can be assembled again alone. */
+		bool IsLocalLine(const CodeLine& codeline);
+		/** Assembles an edited line again alone at its address, returns false if the whole assembly must be done again. */
+		bool ReassembleLine(CodeLine& codeline, ErrorList& msg);
+		/** Assembles all the stored files again. */
+		ErrorType ReassembleFiles(ErrorList& msg);
+		/** Assembles all the files again until the .RELAX mode does not change any jump form. */
+		ErrorType RelaxLayout(ErrorType result, ErrorList& msg);
+		/** Restores the section, address, file and label scope of a line assembled again alone. */
+		void RestoreContext(CodeLine& codeline);
+
+		//MARK: - Private fixups
+		
+		/** Tells if a line assembled by pass 1 can be assembled again alone once all the labels are known. */
+		bool IsFixupLine(const CodeLine& codeline);
+		/** Flags a line assembled by pass 1 as a fixup if it uses unsolved symbols, and asks for the whole pass 2
+		 if the line cannot be assembled again alone or if it has given a new value to a label. */
+		void CheckFixup(CodeLine& codeline, class Label* previous);
+		/** Assembles the fixup lines again, returns false if the whole pass 2 must be run instead. */
+		bool FixupLines(ErrorList& msg);
+		/** Records a #DEFINE or #REQUIRES symbol tested by pass 1. */
+		void TestSymbol(SYMBOLID id);
+		/** Asks for the whole pass 2 if a #DEFINE or #REQUIRES symbol changes after it has been tested by pass 1. */
+		void ChangeSymbol(SYMBOLID id);
+		/** Deletes all the labels, symbols and sections. */
+		void ClearSymbols();
+
+		//MARK: - Private macros and repeated blocks
+
+		/** Stores a new macro, replacing any macro with the same name. */
+		void DefineMacro(Macro* macro);
+		/** Starts recording the lines of a .MACRO or .REPT block, or skipping them if macro is nullptr. */
+		void StartRecording(Macro* macro, bool repeat, const CodeLine& codeline);
+		/** Records a line of the block, returns false for the line closing the block. */
+		bool RecordLine(CodeLine& codeline);
+		/** Ends the recording and returns the recorded block. */
+		Macro* EndRecording();
+		/** Forgets the block being recorded. */
+		void ClearRecording();
+		/** Tells if a token of a line is the name of a macro expanded by the line. */
+		bool IsMacro(const CodeLine& codeline, const ParseToken& token);
+		/** Assembles the lines of a macro or a .REPT block after the line expanding them, in pass 1. */
+		ErrorType ExpandMacro(Macro& macro, CodeLine& codeline, size_t argtoken, ErrorList& msg);
+		/** Assembles again the lines expanded by pass 1 after a line, in pass 2. */
+		ErrorType ReplayExpansion(CodeLine& codeline, ErrorList& msg);
 
 	public:
 		//MARK: - PUBLIC API
@@ -263,18 +454,30 @@ namespace MUZ {
 		virtual ~Assembler();
 		
 		//MARK: - Initializer and setting output files
-		/** Reset the assembly. */
+		/** Reset the assembly, so that the assembler can assemble another main file. The output settings are kept. */
 		void Reset();
 		/** Enable/Disable all bytes listing or 2-lines listing. */
 		void EnableFullListing(bool yes);
 		/** Enable/Disable trace on standard output. */
 		void EnableTrace(bool yes);
+		/** Enable/Disable the fixups replacing the pass 2, the whole pass 2 is always run when disabled. */
+		void EnableFixups(bool yes);
 		/** Sets the directory where MUZ places the output files and listings. */
 		void SetOutputDirectory(std::string directory);
+		/** Sets the directory where MUZ keeps the split tokens of the source files, empty to disable the cache. */
+		void SetCacheDirectory(std::string directory);
+		/** Uses a cache shared with other assemblers instead of the own cache of this assembler. */
+		void ShareCache(LexCache& cache);
 		/** Sets the listing filename. */
 		void SetListingFilename(std::string filename);
 		/** Sets the binary filename. */
 		void SetBinaryFilename(std::string filename);
+		/** Sets the value written in the binary output between the assembled address ranges. */
+		void SetBinaryFill(DATATYPE fill);
+		/** Enable/Disable one binary file per saved section, named after the binary filename and the section. */
+		void EnableBinarySections(bool yes);
+		/** Gets the names of the binary files written by the last assembly. */
+		const std::vector<std::string>& GetBinaryFiles() const;
 		/** Sets the IntelHex filename. */
 		void SetIntelHexFilename(std::string filename);
 		/** Sets the number of bytes in hex output lines */
@@ -285,10 +488,24 @@ namespace MUZ {
 		void SetSymbolsFilename(std::string filename);
 		/** Sets the erros/warnings log filename. */
 		void SetLogFilename(std::string filename);
+		/** Sets the binary debug information filename. */
+		void SetDebugInfoFilename(std::string filename);
 		/** Gets the full listing from current assembling. */
 		Listing GetListing(ErrorList& msg);
+		/** Gets the number of listing lines of a file, without its included files. */
+		size_t GetListingRows(size_t file, ErrorList& msg);
+		/** Gets count listing lines of a file from a given row, without its included files. */
+		Listing GetListing(size_t file, size_t firstrow, size_t count, ErrorList& msg);
 		/** Terminates assembly at next line */
 		void Terminate();
+		/** Enable/Disable the choice of the JP or JR form for the jumps. */
+		void EnableRelax(bool yes);
+		/** Tells if the jumps form is chosen by the assembler. */
+		bool IsRelaxing() const {
+			return m_status.relax;
+		}
+		/** Chooses the form of a relaxed jump for the next assembly of the layout. */
+		void RelaxJump(CodeLine& codeline, JumpForm form);
 
 		/** Known Processor check **/
 		bool isKnownProcessor(std::string name);
@@ -331,8 +548,12 @@ namespace MUZ {
 		CodeLine AssembleLine(std::string sourceline, ErrorList& msg);
 		/** Assembles a main source file. */
 		ErrorType AssembleFile(std::string file, ErrorList& msg);
+		/** Replaces lines in a file of the current assembly and updates the assembly. */
+		ErrorType UpdateLines(size_t file, size_t firstline, size_t nblines, const std::vector<std::string>& newlines, ErrorList& msg);
 		/** Get the name of a file from its index. */
 		std::string GetFileName(size_t index);
+		/** Get the number of files in the current assembly, including the #INSERTHEX and #INSERTBIN files and the macro expansions. */
+		size_t GetFilesCount();
 
 		//MARK: - Interface to instructions, labels, directives, symbols
 		
@@ -340,11 +561,19 @@ namespace MUZ {
 		void SetInstructions(std::string name);
 		
 		/** Tries to find a directive by name. Must include the '#' or '.' prefix. */
-		Directive* GetDirective(std::string name);
+		Directive* GetDirective(const std::string& name);
+		/** Tries to find a directive by keyword index. */
+		Directive* GetDirective(int keyword);
 		/** Try to find a n instruction in the instruction set. */
-		Instruction* GetInstruction(std::string name);
+		Instruction* GetInstruction(const std::string& name);
+		/** Try to find an instruction by keyword index. */
+		Instruction* GetInstruction(int keyword);
+		/** Returns the symbol id for a name, giving a new one to unknown names. */
+		SYMBOLID InternSymbol(const std::string& name);
 		/** Try to find a named label in assembled labels. */
 		Label* GetLabel(std::string name);
+		/** Try to find a label by its symbol id in assembled labels. */
+		Label* GetLabel(SYMBOLID symbol);
 		/** Create a #DEFINE symbol, optionaly with a given string value. */
 		DefSymbol* CreateDefSymbol(std::string name, std::string value);
 		/** Delete a #DEFINE symbol. */
@@ -354,7 +583,7 @@ namespace MUZ {
 		/** Try to replace a symbol from the #DEFINE table. */
 		bool ReplaceDefSymbol(ParseToken& token);
 		/** try to replace a symbol from the Label table */
-		bool ReplaceLabel(std::string& source);
+		bool ReplaceLabel(ParseToken& token);
 		/** Create a #REQUIRES symbol. */
 		DefSymbol* CreateReqSymbol(std::string name);
 		/** Delete a #REQUIRES symbol. */
@@ -26,8 +26,14 @@ namespace MUZ {
 	/** Pushes codes. */
 	void CodeLine::ResetCode() {
 		code.clear();
+		fillsize = 0;
 	}
 	void CodeLine::AddCode(int b0) {
+		// keep bytes in order if code follows a reserved space
+		if (fillsize) {
+			code.insert(code.end(), fillsize, fillvalue);
+			fillsize = 0;
+		}
 		code.push_back(b0 & DATAMASK);
 	}
 	void CodeLine::AddCode(int b0, int b1) {
@@ -45,4 +51,25 @@ namespace MUZ {
 		AddCode(b2);
 		AddCode(b3);
 	}
+	
+	/** Takes the source and lexing results from a previous assembly of the line, so the line is not split again. */
+	void CodeLine::TakeSource(CodeLine& previous) {
+		source = std::move(previous.source);
+		lexedtokens = std::move(previous.lexedtokens);
+		lexeddirective = previous.lexeddirective;
+		lexedflag = previous.lexedflag;
+		lexed = previous.lexed;
+		expressions = std::move(previous.expressions);
+		jump = previous.jump;
+	}
+	
+	/** Reserves space after the code. */
+	void CodeLine::Fill(DWORD size, int value) {
+		if (fillsize && (fillvalue != (value & DATAMASK))) {
+			code.insert(code.end(), fillsize, fillvalue);
+			fillsize = 0;
+		}
+		fillsize += size;
+		fillvalue = (DATATYPE)(value & DATAMASK);
+	}
 } // namespace
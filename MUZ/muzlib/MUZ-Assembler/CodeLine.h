@@ -14,9 +14,28 @@
 #include "Errors.h"
 #include "MUZ-Common/Types.h"
 #include "ExpVector.h"
+#include "Expression.h"
 
 namespace MUZ {
 	
+	/** Form of a JP or JR jump assembled in the .RELAX mode: the form written in the source, the short JR form,
+	 the long JP form, or the long form kept for good after the short form could not reach the target. */
+	enum JumpForm {
+		jumpformWRITTEN = 0, jumpformSHORT, jumpformLONG, jumpformPINNED
+	};
+	
+	/** Form chosen for a jump by the .RELAX mode, kept by the line between the assemblies of the layout. */
+	struct RelaxedJump {
+		/** Form assembled by the current assembly. */
+		JumpForm			form = jumpformWRITTEN;
+		/** Form chosen by the pass 2 for the next assembly. */
+		JumpForm			next = jumpformWRITTEN;
+		/** Bytes and T-states saved against the written form, negative when the jump has been lengthened. */
+		int					bytes = 0;
+		int					statesmin = 0;
+		int					statesmax = 0;
+	};
+	
 	/** Source and assembled content for one line of source code. */
 	struct CodeLine
 	{
@@ -41,6 +60,24 @@ namespace MUZ {
 		size_t				instructiontoken = 0;
 		/** current position for Reset/Next functions. */
 		size_t				curtoken = 0;
+		/** Pristine copy of the tokens as split in pass 1, restored before each later assembly of the line because
+		 symbol resolution modifies the working tokens. */
+		ExpVector			lexedtokens;
+		/** Last directive met by the split and its Parser ResultFlag, restored along with the tokens. */
+		class Directive*	lexeddirective = nullptr;
+		int					lexedflag = 0;
+		/** Tells if lexedtokens holds the split result for this line. */
+		bool				lexed = false;
+		/** Tells if the line holds data from an #INSERTHEX or #INSERTBIN file: its code is set when the file is
+		 read and the line is never parsed. The source is only kept for the listing. */
+		bool				rawdata = false;
+		/** Expressions compiled by the evaluators for this line tokens, reused by later passes. */
+		ExpressionCache		expressions;
+		/** Form of the jump in this line if it is assembled in the .RELAX mode. */
+		RelaxedJump			jump;
+		/** Set by pass 1 when the line must be assembled again once all the labels are known, because it uses
+		 unsolved symbols or gives messages in pass 2. */
+		bool				fixup = false;
 		
 		// assembled code
 		
@@ -49,6 +86,9 @@ namespace MUZ {
 		ErrorType			assembled = errorTypeFALSE;
 		/** Array of code bytes once assembled. May be empty. */
 		std::vector<BYTE>	code;
+		/** Reserved space following the code bytes, as a run of fillsize bytes set to fillvalue. */
+		DWORD				fillsize = 0;
+		DATATYPE			fillvalue = 0;
 		/** Minimum states  */
 		int					statesmin = 0 ;
 		/** Maximum states, generally when a jump happens because a condition is met. */
@@ -61,6 +101,8 @@ namespace MUZ {
 		size_t				includefile = 0;
 		/** Label reference if this line has a label or is after a line containing only a label. */
 		class Label*		label = nullptr;
+		/** Last global label when the line was assembled, it gives the scope of the local '@' labels used by the line. */
+		SYMBOLID			scope = 0;
 		/** Assembler reference. */
 		class Assembler*	as = nullptr;
 		/** Error/Warning message reference, -1 if no message */
@@ -82,6 +124,22 @@ namespace MUZ {
 		void AddCode(int b0, int b1);
 		void AddCode(int b0, int b1, int b2) ;
 		void AddCode(int b0, int b1, int b2, int b3);
+		
+		/** Takes the source, the lexing results and the jump form of the same line from a previous assembly. */
+		void TakeSource(CodeLine& previous);
+		
+		/** Reserves a number of bytes set to a value after the code, without storing them in the code array. */
+		void Fill(DWORD size, int value);
+		
+		/** Number of bytes for this line, code and reserved space. */
+		DWORD Size() const {
+			return (DWORD)code.size() + fillsize;
+		}
+		
+		/** Returns one of the bytes for this line, from the code or the reserved space. */
+		DATATYPE Byte(size_t index) const {
+			return (index < code.size()) ? code[index] : fillvalue;
+		}
 	};
 
 }
@@ -0,0 +1,386 @@
+//
+//  DebugInfo.cpp
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+#include "pch.h"
+#include "DebugInfo.h"
+#include <algorithm>
+#include <map>
+
+namespace MUZ {
+
+	/** Debug information file signature and format version. */
+	static const char DEBUGINFO_MAGIC[4] = { 'M', 'U', 'Z', 'D' };
+	static const DWORD DEBUGINFO_VERSION = 1;
+	/** Number of lines between two restarts of the differences in the lines table. */
+	static const DWORD DEBUGINFO_BLOCKSIZE = 64;
+	/** Number of words in the header, after the signature. */
+	static const size_t DEBUGINFO_HEADERWORDS = 12;
+	/** Parent file number of the main file. */
+	static const DWORD DEBUGINFO_NOPARENT = 0xFFFFFFFF;
+
+	// Prototypes to avoid warnings
+	void putWord(std::vector<BYTE>& out, DWORD value);
+	void putNumber(std::vector<BYTE>& out, DWORD value);
+	DWORD zigzag(long long value);
+	long long unzigzag(DWORD value);
+	bool getNumber(const std::vector<BYTE>& data, size_t& pos, DWORD& value);
+
+	/** Appends a 32-bit little-endian word. */
+	void putWord(std::vector<BYTE>& out, DWORD value)
+	{
+		out.push_back((BYTE)(value & 0xFF));
+		out.push_back((BYTE)((value >> 8) & 0xFF));
+		out.push_back((BYTE)((value >> 16) & 0xFF));
+		out.push_back((BYTE)((value >> 24) & 0xFF));
+	}
+
+	/** Appends a variable length number, 7 bits per byte with the high bit set when another byte follows. */
+	void putNumber(std::vector<BYTE>& out, DWORD value)
+	{
+		while (value >= 0x80) {
+			out.push_back((BYTE)((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		out.push_back((BYTE)value);
+	}
+
+	/** Maps a signed difference to an unsigned number, small negative values giving small numbers. */
+	DWORD zigzag(long long value)
+	{
+		return (DWORD)((value < 0) ? ((-value) * 2 - 1) : (value * 2));
+	}
+
+	/** Gets a signed difference back from its zigzag number. */
+	long long unzigzag(DWORD value)
+	{
+		return (value & 1) ? -(long long)((value + 1) / 2) : (long long)(value / 2);
+	}
+
+	/** Reads a variable length number, fails past the end of the data. */
+	bool getNumber(const std::vector<BYTE>& data, size_t& pos, DWORD& value)
+	{
+		value = 0;
+		for (int shift = 0 ; shift < 35 && pos < data.size() ; shift += 7) {
+			BYTE b = data[pos++];
+			value |= (DWORD)(b & 0x7F) << shift;
+			if ((b & 0x80) == 0) return true;
+		}
+		return false;
+	}
+
+	//MARK: - Writer
+
+	/** Adds the next source file, files are numbered in the order they are added. */
+	void DebugInfoWriter::AddFile(const std::string& name, size_t parent, size_t parentline, DWORD flags)
+	{
+		DebugInfo::File file;
+		file.name = name;
+		file.parent = parent;
+		file.parentline = parentline;
+		file.flags = flags;
+		m_files.push_back(file);
+	}
+
+	/** Adds a symbol. */
+	void DebugInfoWriter::AddSymbol(const std::string& name, DWORD value, DebugSymbolKind kind, size_t file, size_t line)
+	{
+		DebugInfo::Symbol symbol;
+		symbol.name = name;
+		symbol.value = value;
+		symbol.kind = kind;
+		symbol.file = file;
+		symbol.line = line;
+		m_symbols.push_back(symbol);
+	}
+
+	/** Adds an assembled line with code. */
+	void DebugInfoWriter::AddLine(DWORD address, DWORD size, size_t file, size_t line, int statesmin, int statesmax)
+	{
+		DebugInfo::Line entry;
+		entry.address = address;
+		entry.size = size;
+		entry.file = file;
+		entry.line = line;
+		entry.statesmin = statesmin;
+		entry.statesmax = statesmax;
+		m_lines.push_back(entry);
+	}
+
+	/** Sorts the tables and writes the file, returns false if it cannot be written. */
+	bool DebugInfoWriter::Save(const std::string& path)
+	{
+		std::sort(m_symbols.begin(), m_symbols.end(), [](const DebugInfo::Symbol& a, const DebugInfo::Symbol& b) {
+			return a.name < b.name;
+		});
+		std::stable_sort(m_lines.begin(), m_lines.end(), [](const DebugInfo::Line& a, const DebugInfo::Line& b) {
+			return a.address < b.address;
+		});
+
+		// strings, each name is stored once
+		std::vector<BYTE> strings;
+		std::map<std::string, DWORD> offsets;
+		auto stringOffset = [&](const std::string& name) -> DWORD {
+			auto found = offsets.find(name);
+			if (found != offsets.end()) return found->second;
+			DWORD offset = (DWORD)strings.size();
+			strings.insert(strings.end(), name.begin(), name.end());
+			strings.push_back(0);
+			offsets[name] = offset;
+			return offset;
+		};
+
+		// labels sorted by value
+		std::vector<DWORD> labels;
+		for (DWORD i = 0 ; i < m_symbols.size() ; i++) {
+			if (m_symbols[i].kind == debugSymbolLABEL) labels.push_back(i);
+		}
+		std::stable_sort(labels.begin(), labels.end(), [&](DWORD a, DWORD b) {
+			return m_symbols[a].value < m_symbols[b].value;
+		});
+
+		// lines differences, restarted at each block
+		std::vector<BYTE> lines;
+		std::vector<DWORD> blocks;
+		DebugInfo::Line previous;
+		for (size_t i = 0 ; i < m_lines.size() ; i++) {
+			const DebugInfo::Line& line = m_lines[i];
+			if (i % DEBUGINFO_BLOCKSIZE == 0) {
+				previous = DebugInfo::Line();
+				blocks.push_back(line.address);
+				blocks.push_back((DWORD)lines.size());
+			}
+			putNumber(lines, line.address - previous.address);
+			putNumber(lines, line.size);
+			putNumber(lines, zigzag((long long)line.file - (long long)previous.file));
+			putNumber(lines, zigzag((long long)line.line - (long long)previous.line));
+			putNumber(lines, zigzag(line.statesmin));
+			putNumber(lines, zigzag((long long)line.statesmax - line.statesmin));
+			previous = line;
+		}
+		while (lines.size() % 4) lines.push_back(0);
+
+		// tables
+		std::vector<BYTE> files;
+		for (auto & file : m_files) {
+			putWord(files, stringOffset(file.name));
+			putWord(files, (file.parent == (size_t)-1) ? DEBUGINFO_NOPARENT : (DWORD)file.parent);
+			putWord(files, (DWORD)file.parentline);
+			putWord(files, file.flags);
+		}
+		std::vector<BYTE> symbols;
+		for (auto & symbol : m_symbols) {
+			putWord(symbols, stringOffset(symbol.name));
+			putWord(symbols, symbol.value);
+			putWord(symbols, (DWORD)symbol.kind);
+			putWord(symbols, (DWORD)symbol.file);
+			putWord(symbols, (DWORD)symbol.line);
+		}
+		std::vector<BYTE> labelsindex;
+		for (auto label : labels) putWord(labelsindex, label);
+		std::vector<BYTE> blocksindex;
+		for (auto value : blocks) putWord(blocksindex, value);
+
+		// header then tables
+		std::vector<BYTE> out(DEBUGINFO_MAGIC, DEBUGINFO_MAGIC + 4);
+		DWORD offset = (DWORD)(4 + DEBUGINFO_HEADERWORDS * 4);
+		putWord(out, DEBUGINFO_VERSION);
+		putWord(out, (DWORD)m_files.size());
+		putWord(out, offset);
+		offset += (DWORD)files.size();
+		putWord(out, (DWORD)m_symbols.size());
+		putWord(out, offset);
+		offset += (DWORD)symbols.size();
+		putWord(out, (DWORD)labels.size());
+		putWord(out, offset);
+		offset += (DWORD)labelsindex.size();
+		putWord(out, (DWORD)blocks.size() / 2);
+		putWord(out, offset);
+		offset += (DWORD)blocksindex.size();
+		putWord(out, (DWORD)m_lines.size());
+		putWord(out, offset);
+		offset += (DWORD)lines.size();
+		putWord(out, offset);
+		for (auto table : { &files, &symbols, &labelsindex, &blocksindex, &lines, &strings }) {
+			out.insert(out.end(), table->begin(), table->end());
+		}
+
+		FILE* f = fopen(path.c_str(), "wb");
+		if (f == nullptr) return false;
+		bool written = (fwrite(out.data(), 1, out.size(), f) == out.size());
+		fclose(f);
+		return written;
+	}
+
+	//MARK: - Reader
+
+	/** Reads a word of a loaded file. */
+	DWORD DebugInfo::Word(size_t offset) const
+	{
+		if (offset + 4 > m_data.size()) return 0;
+		return (DWORD)m_data[offset] | ((DWORD)m_data[offset + 1] << 8) | ((DWORD)m_data[offset + 2] << 16) | ((DWORD)m_data[offset + 3] << 24);
+	}
+
+	/** Reads a string of a loaded file from its offset in the strings table. */
+	std::string DebugInfo::String(DWORD offset) const
+	{
+		size_t start = (size_t)m_stringsoffset + offset;
+		size_t end = start;
+		while (end < m_data.size() && m_data[end] != 0) end += 1;
+		if (start >= end) return "";
+		return std::string((const char*)m_data.data() + start, end - start);
+	}
+
+	/** Loads a debug information file, returns false if it cannot be read or is not valid. */
+	bool DebugInfo::Load(const std::string& path)
+	{
+		m_data.clear();
+		FILE* f = fopen(path.c_str(), "rb");
+		if (f == nullptr) return false;
+		BYTE buffer[65536];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+			m_data.insert(m_data.end(), buffer, buffer + read);
+		}
+		fclose(f);
+		if (m_data.size() < 4 + DEBUGINFO_HEADERWORDS * 4 || memcmp(m_data.data(), DEBUGINFO_MAGIC, 4) != 0 || Word(4) != DEBUGINFO_VERSION) {
+			m_data.clear();
+			return false;
+		}
+		m_files = Word(8);		m_filesoffset = Word(12);
+		m_symbols = Word(16);	m_symbolsoffset = Word(20);
+		m_labels = Word(24);	m_labelsoffset = Word(28);
+		m_blocks = Word(32);	m_blocksoffset = Word(36);
+		m_lines = Word(40);		m_linesoffset = Word(44);
+		m_stringsoffset = Word(48);
+		// the tables must fit in the file
+		if ((size_t)m_filesoffset + (size_t)m_files * 16 > m_data.size()
+			|| (size_t)m_symbolsoffset + (size_t)m_symbols * 20 > m_data.size()
+			|| (size_t)m_labelsoffset + (size_t)m_labels * 4 > m_data.size()
+			|| (size_t)m_blocksoffset + (size_t)m_blocks * 8 > m_data.size()
+			|| m_linesoffset > m_data.size() || m_stringsoffset > m_data.size()) {
+			m_data.clear();
+			return false;
+		}
+		return true;
+	}
+
+	/** Number of source files. */
+	size_t DebugInfo::FilesCount() const
+	{
+		return m_data.empty() ? 0 : m_files;
+	}
+
+	/** Gets a source file from its number. */
+	DebugInfo::File DebugInfo::GetFile(size_t index) const
+	{
+		File file;
+		if (index >= FilesCount()) return file;
+		size_t offset = m_filesoffset + index * 16;
+		file.name = String(Word(offset));
+		DWORD parent = Word(offset + 4);
+		file.parent = (parent == DEBUGINFO_NOPARENT) ? (size_t)-1 : parent;
+		file.parentline = Word(offset + 8);
+		file.flags = Word(offset + 12);
+		return file;
+	}
+
+	/** Number of symbols. */
+	size_t DebugInfo::SymbolsCount() const
+	{
+		return m_data.empty() ? 0 : m_symbols;
+	}
+
+	/** Gets a symbol from its index in the table sorted by name. */
+	DebugInfo::Symbol DebugInfo::GetSymbol(size_t index) const
+	{
+		Symbol symbol;
+		if (index >= SymbolsCount()) return symbol;
+		size_t offset = m_symbolsoffset + index * 20;
+		symbol.name = String(Word(offset));
+		symbol.value = Word(offset + 4);
+		symbol.kind = (DebugSymbolKind)Word(offset + 8);
+		symbol.file = Word(offset + 12);
+		symbol.line = Word(offset + 16);
+		return symbol;
+	}
+
+	/** Finds a symbol by name with a binary search in the symbols table. */
+	bool DebugInfo::FindSymbol(const std::string& name, Symbol& symbol) const
+	{
+		size_t low = 0, high = SymbolsCount();
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+			std::string middlename = String(Word(m_symbolsoffset + middle * 20));
+			if (middlename < name) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		if (low >= SymbolsCount()) return false;
+		symbol = GetSymbol(low);
+		return symbol.name == name;
+	}
+
+	/** Finds the label with the highest address lower or equal to an address, with a binary search in the labels
+	 table. */
+	bool DebugInfo::FindLabel(DWORD address, Symbol& symbol) const
+	{
+		size_t low = 0, high = m_data.empty() ? 0 : m_labels;
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+			DWORD index = Word(m_labelsoffset + middle * 4);
+			if (Word(m_symbolsoffset + index * 20 + 4) <= address) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		if (low == 0) return false;
+		symbol = GetSymbol(Word(m_labelsoffset + (low - 1) * 4));
+		return true;
+	}
+
+	/** Finds the line whose code contains an address. The block is found with a binary search, then its lines are
+	 decoded up to the address. */
+	bool DebugInfo::FindLine(DWORD address, Line& line) const
+	{
+		size_t low = 0, high = m_data.empty() ? 0 : m_blocks;
+		while (low < high) {
+			size_t middle = (low + high) / 2;
+			if (Word(m_blocksoffset + middle * 8) <= address) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		if (low == 0) return false;
+		size_t block = low - 1;
+		size_t pos = m_linesoffset + Word(m_blocksoffset + block * 8 + 4);
+		size_t count = std::min<size_t>(DEBUGINFO_BLOCKSIZE, m_lines - block * DEBUGINFO_BLOCKSIZE);
+		Line current;
+		bool found = false;
+		for (size_t i = 0 ; i < count ; i++) {
+			DWORD values[6];
+			for (auto & value : values) {
+				if (!getNumber(m_data, pos, value)) return found;
+			}
+			current.address += values[0];
+			if (current.address > address) break;
+			current.size = values[1];
+			current.file = (size_t)((long long)current.file + unzigzag(values[2]));
+			current.line = (size_t)((long long)current.line + unzigzag(values[3]));
+			current.statesmin = (int)unzigzag(values[4]);
+			current.statesmax = current.statesmin + (int)unzigzag(values[5]);
+			if (address < current.address + current.size) {
+				line = current;
+				found = true;
+			}
+		}
+		return found;
+	}
+
+} // namespace MUZ
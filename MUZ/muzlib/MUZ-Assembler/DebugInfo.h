@@ -0,0 +1,130 @@
+//
+//  DebugInfo.h
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+
+#ifndef DebugInfo_h
+#define DebugInfo_h
+
+#include <string>
+#include <vector>
+#include "MUZ-Common/Types.h"
+
+namespace MUZ {
+
+	/** Kind of a symbol in the debug information file. */
+	enum DebugSymbolKind {
+		debugSymbolLABEL = 0,		// global label, the value is its address
+		debugSymbolEQUATE = 1		// .EQU symbol, the value is not an address
+	};
+
+	/** Flags of a source file in the debug information file. */
+	enum DebugFileFlags {
+		debugFileINCLUDED = 1,		// #INCLUDEd, #INSERTHEX or #INSERTBIN file
+		debugFileEXPANSION = 2		// lines expanded from a macro or a .REPT block
+	};
+
+	/** Binary debug information written by the assembler for emulators, profilers and disassemblers.
+	 All the numbers are 32-bit little-endian words except in the lines table. The file has:
+	 - a header: "MUZD", version, then the count and offset of the files, symbols, labels, blocks and lines tables,
+	   and the offset of the strings table
+	 - the files table: name, parent file (0xFFFFFFFF for the main file), line in the parent file, DebugFileFlags
+	 - the symbols table sorted by name: name, value, DebugSymbolKind, file and line of the definition
+	 - the labels table: the indexes of the label symbols sorted by value
+	 - the blocks table: for every DEBUGINFO_BLOCKSIZE lines, the address of the first line and its offset in the
+	   lines table
+	 - the lines table: the assembled lines with code sorted by address. Each line is given by variable length
+	   numbers, 7 bits per byte with the high bit set when another byte follows: address minus previous address,
+	   code size, file minus previous file, line minus previous line, minimum T-states, maximum minus minimum
+	   T-states. The differences can be negative and are zigzag encoded, except the address one. The previous
+	   values are 0 at the start of each block.
+	 - the strings table: names ending with a zero byte, given by their offset in this table.
+	 A line or a symbol is found with a binary search in the blocks, symbols or labels tables.
+	 */
+	class DebugInfo
+	{
+	public:
+		/** An assembled line. */
+		struct Line {
+			DWORD	address = 0;
+			DWORD	size = 0;
+			size_t	file = 0;
+			size_t	line = 0;
+			int		statesmin = 0;
+			int		statesmax = 0;
+		};
+		/** A symbol with its definition. */
+		struct Symbol {
+			std::string		name;
+			DWORD			value = 0;
+			DebugSymbolKind	kind = debugSymbolLABEL;
+			size_t			file = 0;
+			size_t			line = 0;
+		};
+		/** A source file. */
+		struct File {
+			std::string		name;
+			size_t			parent = 0;
+			size_t			parentline = 0;
+			DWORD			flags = 0;
+		};
+
+	private:
+		/** Content of a loaded file. */
+		std::vector<BYTE>	m_data;
+		/** Header values of a loaded file. */
+		DWORD				m_files = 0, m_filesoffset = 0;
+		DWORD				m_symbols = 0, m_symbolsoffset = 0;
+		DWORD				m_labels = 0, m_labelsoffset = 0;
+		DWORD				m_blocks = 0, m_blocksoffset = 0;
+		DWORD				m_lines = 0, m_linesoffset = 0;
+		DWORD				m_stringsoffset = 0;
+
+		/** Reads a word of a loaded file. */
+		DWORD Word(size_t offset) const;
+		/** Reads a string of a loaded file from its offset in the strings table. */
+		std::string String(DWORD offset) const;
+
+	public:
+		/** Loads a debug information file, returns false if it cannot be read or is not valid. */
+		bool Load(const std::string& path);
+
+		/** Number of source files. */
+		size_t FilesCount() const;
+		/** Gets a source file from its number. */
+		File GetFile(size_t index) const;
+		/** Number of symbols. */
+		size_t SymbolsCount() const;
+		/** Gets a symbol from its index in the table sorted by name. */
+		Symbol GetSymbol(size_t index) const;
+		/** Finds a symbol by name. */
+		bool FindSymbol(const std::string& name, Symbol& symbol) const;
+		/** Finds the label with the highest address lower or equal to an address. */
+		bool FindLabel(DWORD address, Symbol& symbol) const;
+		/** Finds the line whose code contains an address. */
+		bool FindLine(DWORD address, Line& line) const;
+	};
+
+	/** Builds a debug information file from the files, symbols and lines of an assembly. */
+	class DebugInfoWriter
+	{
+		std::vector<DebugInfo::File>	m_files;
+		std::vector<DebugInfo::Symbol>	m_symbols;
+		std::vector<DebugInfo::Line>	m_lines;
+
+	public:
+		/** Adds the next source file, files are numbered in the order they are added. */
+		void AddFile(const std::string& name, size_t parent, size_t parentline, DWORD flags);
+		/** Adds a symbol. */
+		void AddSymbol(const std::string& name, DWORD value, DebugSymbolKind kind, size_t file, size_t line);
+		/** Adds an assembled line with code. */
+		void AddLine(DWORD address, DWORD size, size_t file, size_t line, int statesmin, int statesmax);
+		/** Sorts the tables and writes the file, returns false if it cannot be written. */
+		bool Save(const std::string& path);
+	};
+
+} // namespace MUZ
+
+#endif /* DebugInfo_h */
@@ -36,6 +36,11 @@ namespace MUZ {
 						   ErrorList& msg) {
 			return msg.Error(errorNonDerivedDirective, codeline);
 		}
+		/** Tells if the directive only stores data in its code line, without changing any symbol, address or
+		 assembly mode. Such lines can be assembled again alone when they are edited. */
+		virtual bool IsData() const {
+			return false;
+		}
 	};
 	
 	typedef std::unordered_map<std::string, Directive*> DirectivesMap;
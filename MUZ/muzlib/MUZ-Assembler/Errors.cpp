@@ -17,72 +17,78 @@ namespace MUZ {
 	bool TestPass(CodeLine& codeline, int pass);
 
 
-	// This construction avoids the "requires exit-time destructor" warning
-	//MessageTextMap & messageText = *new MessageTextMap;
-	std::map<ErrorKind,const char*> * MUZ::ErrorList::messageText = nullptr;
-	int MUZ::ErrorList::arc = 0;
+	/** Builds the message texts. This construction avoids the "requires exit-time destructor" warning. */
+	static std::map<ErrorKind,const char*>* BuildMessageTexts() {
+		std::map<ErrorKind,const char*>* messageText = new std::map<ErrorKind,const char*>;
+		(*messageText)[errorOK] = "no error";
+		(*messageText)[errorUnknown] = "unknown error";
+		(*messageText)[errorNonDerivedInstruction] = "SHOULD NOT OCCUR: Non derived Instruction class used (fatal)";
+		(*messageText)[errorNonDerivedDirective] = "SHOULD NOT OCCUR: Non derived Directive class used (fatal)";
+		(*messageText)[errorWritingListing] = "Cannot write listing file (about file) ";
+		(*messageText)[errorOpeningSource] = "Cannot open source file: asm, hex or binary file not found";
+		(*messageText)[errorElseNoIf] = "#ELSE without corresponding #IF/#IFDEF/#IFNDEF";
+		(*messageText)[errorEndifNoIf] = "#ENDIF without #ELSE or #IF";
+		(*messageText)[errorLabelExists] = "label re-defined later";
+		(*messageText)[errorUnknownSyntax] = "line does not start with a label, a directive or an instruction";
+		(*messageText)[errorUnknownDirective] = "directive starting with '.' or '#' is unknown";
+		(*messageText)[errorUknownInstruction] = "an instruction should have been found, probable wrong syntax";
+		(*messageText)[errorMUZNoSection] = "SHOULD NOT OCCUR: assembled code has no section";
+		(*messageText)[warningMisplacedChar] = "a '.' or '#' was found in an unsusual place";
+		(*messageText)[errorMissingComma] = "a ',' is missing in instruction operands";
+		(*messageText)[errorWrongOperand1] = "first operand is wrong type";
+		(*messageText)[errorWrongOperand2] = "second operand is wrong type";
+		(*messageText)[errorWrongOperand3] = "third operand is wrong type";
+		(*messageText)[errorWrongRegister] = "register name is not valid";
+		(*messageText)[errorMissingParenthesisClose] = "a ')' is missing";
+		(*messageText)[errorWrongCondition] = "A condition is invalid (e.g. JR PO,nn)";
+		(*messageText)[errorNotRegister] = "expected register name was not found";
+		(*messageText)[errorWrongComma] = "unexpected comma";
+		(*messageText)[errorLeftOperandMissing] = "left operand missing in expression";
+		(*messageText)[errorMissingToken] = "missing operands or punctuation";
+		(*messageText)[errorDefine] = "#DEFINE could not define a symbol";
+		(*messageText)[errorInvalidSymbol] = "invalid symbol name after DEFINE";
+		(*messageText)[errorInvalidExpression] = "invalid expression after symbol";
+		(*messageText)[errorFileSyntax] = "invalid syntax for file name";
+		(*messageText)[errorProcessor] = "unsupported processor in .PROC";
+		(*messageText)[warningUnsolvedExpression] = "a symbol was unsolved in an expression";
+		(*messageText)[errorEquate] = ".EQU could not create label or assign value";
+		(*messageText)[errorSet] = ".SET could not create label or assign value";
+		(*messageText)[errorTooBigValue] = "number too big for accepted values";
+		(*messageText)[errorTooBigBit] = "number too big for a bit number (0-7)";
+		(*messageText)[warningTooBig8] = "number too big for 8 bits";
+		(*messageText)[warningTooBig16] = "number too big for 16 bits";
+		(*messageText)[warningTooFar] = "DJNZ or JR target is too far";
+		(*messageText)[errorMacroName] = "invalid macro or parameter name";
+		(*messageText)[errorMacroNotClosed] = "block not closed by .ENDM or .ENDR";
+		(*messageText)[errorMacroEnd] = ".ENDM or .ENDR without .MACRO or .REPT";
+		(*messageText)[errorMacroArguments] = "too many macro arguments";
+		(*messageText)[errorReptCount] = ".REPT count must be known in pass 1 and below 65536";
+		(*messageText)[errorMacroDepth] = "too many imbricated macro expansions";
+		return messageText;
+	}
 
 	ErrorList::ErrorList() {
-		if (messageText == nullptr) {
-			messageText = new std::map<ErrorKind,const char*>;
-			(*messageText)[errorOK] = "no error";
-			(*messageText)[errorUnknown] = "unknown error";
-			(*messageText)[errorNonDerivedInstruction] = "SHOULD NOT OCCUR: Non derived Instruction class used (fatal)";
-			(*messageText)[errorNonDerivedDirective] = "SHOULD NOT OCCUR: Non derived Directive class used (fatal)";
-			(*messageText)[errorWritingListing] = "Cannot write listing file (about file) ";
-			(*messageText)[errorOpeningSource] = "Cannot open source file: asm, hex or binary file not found";
-			(*messageText)[errorElseNoIf] = "#ELSE without corresponding #IF/#IFDEF/#IFNDEF";
-			(*messageText)[errorEndifNoIf] = "#ENDIF without #ELSE or #IF";
-			(*messageText)[errorLabelExists] = "label re-defined later";
-			(*messageText)[errorUnknownSyntax] = "line does not start with a label, a directive or an instruction";
-			(*messageText)[errorUnknownDirective] = "directive starting with '.' or '#' is unknown";
-			(*messageText)[errorUknownInstruction] = "an instruction should have been found, probable wrong syntax";
-			(*messageText)[errorMUZNoSection] = "SHOULD NOT OCCUR: assembled code has no section";
-			(*messageText)[warningMisplacedChar] = "a '.' or '#' was found in an unsusual place";
-			(*messageText)[errorMissingComma] = "a ',' is missing in instruction operands";
-			(*messageText)[errorWrongOperand1] = "first operand is wrong type";
-			(*messageText)[errorWrongOperand2] = "second operand is wrong type";
-			(*messageText)[errorWrongOperand3] = "third operand is wrong type";
-			(*messageText)[errorWrongRegister] = "register name is not valid";
-			(*messageText)[errorMissingParenthesisClose] = "a ')' is missing";
-			(*messageText)[errorWrongCondition] = "A condition is invalid (e.g. JR PO,nn)";
-			(*messageText)[errorNotRegister] = "expected register name was not found";
-			(*messageText)[errorWrongComma] = "unexpected comma";
-			(*messageText)[errorLeftOperandMissing] = "left operand missing in expression";
-			(*messageText)[errorMissingToken] = "missing operands or punctuation";
-			(*messageText)[errorDefine] = "#DEFINE could not define a symbol";
-			(*messageText)[errorInvalidSymbol] = "invalid symbol name after DEFINE";
-			(*messageText)[errorInvalidExpression] = "invalid expression after symbol";
-			(*messageText)[errorFileSyntax] = "invalid syntax for file name";
-			(*messageText)[errorProcessor] = "unsupported processor in .PROC";
-			(*messageText)[warningUnsolvedExpression] = "a symbol was unsolved in an expression";
-			(*messageText)[errorEquate] = ".EQU could not create label or assign value";
-			(*messageText)[errorSet] = ".SET could not create label or assign value";
-			(*messageText)[errorTooBigValue] = "number too big for accepted values";
-			(*messageText)[errorTooBigBit] = "number too big for a bit number (0-7)";
-			(*messageText)[warningTooBig8] = "number too big for 8 bits";
-			(*messageText)[warningTooBig16] = "number too big for 16 bits";
-			(*messageText)[warningTooFar] = "DJNZ or JR target is too far";
-		}
-		arc += 1;
 	}
 
 	ErrorList::~ErrorList() {
-		arc -= 1;
-		if (arc <= 0) {
-			delete messageText;
-			messageText = nullptr;
-		}
 	}
 
 	void ErrorList::Clear() {
 	}
 	std::string ErrorList::GetMessage( ErrorKind kind ) {
-		return (*messageText)[kind];
+		// built once by the first caller, assemblers can run in parallel threads
+		static const std::map<ErrorKind,const char*>* messageText = BuildMessageTexts();
+		auto found = messageText->find(kind);
+		return (found != messageText->end()) ? found->second : "";
 	}
 	bool TestPass(CodeLine& codeline, int pass)
 	{
 		if (codeline.as == nullptr) return false;
+		if (pass == 2 && codeline.as->IsFirstPass()) {
+			// the message will be given when the line is assembled again
+			codeline.fixup = true;
+			return false;
+		}
 		return pass == 1 ? codeline.as->IsFirstPass() : ! codeline.as->IsFirstPass();
 
 	}
@@ -125,7 +131,7 @@ namespace MUZ {
 	/** Close the list by sorting it and setting message references into codelines. */
 	void ErrorList::Close(Assembler& as)
 	{
-		std::sort(begin(), end(), []( ErrorMessage& m1, ErrorMessage& m2) {
+		std::stable_sort(begin(), end(), []( const ErrorMessage& m1, const ErrorMessage& m2) {
 			if (m1.file < m2.file) return true;
 			if (m1.file > m2.file) return false;
 			return m1.line < m2.line;
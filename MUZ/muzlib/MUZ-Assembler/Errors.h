@@ -97,6 +97,14 @@ namespace MUZ {
 		warningTooBig16,				// number too big for 16 bits
 		warningTooFar,					// DJNZ or JR target is too far
 
+		// errors on macros and repeated blocks
+		errorMacroName,					// invalid name for a macro or a macro parameter
+		errorMacroNotClosed,			// .MACRO or .REPT without .ENDM or .ENDR
+		errorMacroEnd,					// .ENDM or .ENDR without .MACRO or .REPT
+		errorMacroArguments,			// more arguments than macro parameters
+		errorReptCount,					// .REPT count unknown in pass 1 or too big
+		errorMacroDepth,				// too many imbricated macro expansions
+
 	};
 	
 	struct ErrorMessage {
@@ -110,8 +118,6 @@ namespace MUZ {
 	
 	class ErrorList : public std::vector<ErrorMessage>
 	{
-		static std::map<ErrorKind,const char*> * messageText ;
-		static int arc;
 	public:
 		ErrorList();
 		~ErrorList();
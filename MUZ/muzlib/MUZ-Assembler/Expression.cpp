@@ -168,138 +168,320 @@ namespace MUZ {
 		typeConvert.clear();
 	}
 	
-	/** Evaluates a series of tokens as an expression
-	 @param tokens the vector holding all tokens from a line
-	 @param start the first token to use for evaluation
-	 @return a token containing the result
-	 @throw EXPRESSIONLeftOperandMissing
+	/** Tells if a token type can be part of an expression. */
+	static bool isExpressionToken(TokenType type)
+	{
+		switch (type) {
+			case tokenTypePAROPEN:
+			case tokenTypeBOOL:			// <- bool should never happen, this is just in case
+			case tokenTypeSTRING:		// explicitely enquoted strings
+			case tokenTypeCHAR:			// 'c'
+			case tokenTypeLETTERS: 		// <- letters asked for evaluation are considered as string
+			case tokenTypeDECNUMBER:
+			case tokenTypePARCLOSE:
+			case tokenTypeOP_LSHIFT:
+			case tokenTypeOP_RSHIFT:
+			case tokenTypeOP_DIFF:
+			case tokenTypeOP_EQUAL:
+			case tokenTypeOP_LT:
+			case tokenTypeOP_GT:
+			case tokenTypeOP_LTE:
+			case tokenTypeOP_GTE:
+			case tokenTypeOP_OR:
+			case tokenTypeOP_AND:
+			case tokenTypeOP_BINOR:
+			case tokenTypeOP_BINAND:
+			case tokenTypeOP_BINXOR:
+			case tokenTypeOP_NOT:
+			case tokenTypeOP_PLUS:
+			case tokenTypeOP_MINUS:
+			case tokenTypeOP_MUL:
+			case tokenTypeOP_DIV:
+			case tokenTypeOP_MOD:
+			case tokenTypeOP_HEXCHAR:
+				return true;
+			default:
+				// non recognized token types put an end to expression
+				return false;
+		}
+	}
+	
+	/** Tells if a token type is an operand value in an expression. */
+	static bool isOperandToken(TokenType type)
+	{
+		return (type == tokenTypeBOOL) || (type == tokenTypeSTRING) || (type == tokenTypeCHAR) || (type == tokenTypeLETTERS) || (type == tokenTypeDECNUMBER);
+	}
+	
+	/** Applies the programmed inter-types conversion to a token. */
+	void ExpressionEvaluator::Convert(ParseToken& token)
+	{
+		// if not a convertible type, ignore this token (operators, commas ...)
+		if (token.type <= tokenTypeFIRSTCONVERTIBLE || token.type >= tokenTypeLASTCONVERTIBLE)
+			return;
+		// check the default and then specific new type type
+		TokenType newType = defaultTypeConversion;
+		if (!typeConvert.empty() && typeConvert.count(token.type)) {
+			newType = typeConvert[token.type];
+		}
+		// if no conversion, ignore this token
+		if (newType == tokenTypeUNKNOWN)
+			return;
+		
+		// if new type is numeric, adjust
+		if (newType >= tokenTypeFIRSTNUMERIC && newType <= tokenTypeLASTNUMERIC) {
+			// smart conversion of current value to decimal number (handles prefixes and all kind of convertible token types)
+			DWORD number = token.asInteger();
+			// -> back convert to destination type
+			if (newType == tokenTypeDECNUMBER) {
+				token.setNumber(number);
+			} else if (newType == tokenTypeOCTNUMBER) {
+				token.source = address_to_base(number, 8, number > 255 ? 6 : 3);
+			} else if (newType == tokenTypeHEXNUMBER) {
+				token.source = address_to_base(number, 16, number > 255 ? 4 : 2);
+			} else { // binary
+				token.source = address_to_base(number, 2, number > 255 ? 16 : 8);
+			}
+			if (newType != tokenTypeDECNUMBER) token.valued = false;
+		}
+		// if new type is boolean, adjust
+		else if (newType == tokenTypeBOOL) {
+			std::string newValue = "";
+			if (newType==tokenTypeDECNUMBER || newType==tokenTypeHEXNUMBER || newType==tokenTypeOCTNUMBER || newType==tokenTypeBINNUMBER) {
+				// non null numbers considered as "true" value
+				newValue = token.asInteger() == 0 ? "" : "t";
+			} else {
+				// non empty strings considered true
+				newValue = token.asString().empty() ? "" : "t";
+			}
+			token.source = newValue;
+			token.valued = false;
+		}
+		// other types need the source string, including for valued numbers
+		else if (token.valued) {
+			token.source = token.asString();
+			token.valued = false;
+		}
+		// value has been adjusted now take new type
+		token.type = newType;
+	}
+	
+	/** Compiles the expression starting at a given token into a postfix program, using the operators priorities
+	 of the allOps array. Unary operators are only accepted at the start of an expression or after an opening
+	 parenthesis, which are the only places where EvaluateExpression() computes them. Any unusual syntax leaves the
+	 program flagged as not postfix so it will be reduced in place the same way as before.
 	 */
-	ParseToken ExpressionEvaluator::Evaluate(ExpVector& tokens, int start, int& end)
+	void ExpressionEvaluator::Compile(ExpVector& tokens, int start, int end, ExpressionProgram& program)
 	{
-		// reset stack
-		stack.clear();
+		program.start = start;
+		program.end = end;
+		program.steps.clear();
+		program.postfix = false;
 		
-		// 1c) build working copy, stops at first non expression token (comma ...)
-		bool done = false;
+		// find the expression end, stops at first non expression token (comma ...)
+		int last = (end == -1) ? (int)tokens.size() - 1 : end;
 		int curtoken = start;
-		if (end == -1) {
-			end = (int)tokens.size() - 1;
-		}
+		bool done = false;
 		do {
-			ParseToken& token = tokens.at((size_t)curtoken);
-			switch( token.type ) {
-					
-				case tokenTypePAROPEN:
-				case tokenTypeBOOL:			// <- bool should never happen, this is just in case
-				case tokenTypeSTRING:		// explicitely enquoted strings
-				case tokenTypeCHAR:			// 'c'
-				case tokenTypeLETTERS: 		// <- letters asked for evaluation are considered as string
-				case tokenTypeDECNUMBER:
-				case tokenTypePARCLOSE:
-				case tokenTypeOP_LSHIFT:
-				case tokenTypeOP_RSHIFT:
-				case tokenTypeOP_DIFF:
-				case tokenTypeOP_EQUAL:
-				case tokenTypeOP_LT:
-				case tokenTypeOP_GT:
-				case tokenTypeOP_LTE:
-				case tokenTypeOP_GTE:
-				case tokenTypeOP_OR:
-				case tokenTypeOP_AND:
-				case tokenTypeOP_BINOR:
-				case tokenTypeOP_BINAND:
-				case tokenTypeOP_BINXOR:
-				case tokenTypeOP_NOT:
-				case tokenTypeOP_PLUS:
-				case tokenTypeOP_MINUS:
-				case tokenTypeOP_MUL:
-				case tokenTypeOP_DIV:
-				case tokenTypeOP_MOD:
-				case tokenTypeOP_HEXCHAR:
-					stack.push_back(token);
-					break;
-					
-				default:
-					// non recognized token types put an end to expression
-					done = true;
-					break;
-					
-			};
-			// next token
-			if (!done) curtoken += 1;
-			
-		} while (!done && (curtoken <= end));
-		
-		// programmed inter-types conversion
-		for (auto & token : stack) {
-
-			// if not a convertible type, ignore this token (operators, commas ...)
-			if (token.type <= tokenTypeFIRSTCONVERTIBLE || token.type >= tokenTypeLASTCONVERTIBLE)
-				continue;
-			// check the default and then specific new type type
-			TokenType newType = defaultTypeConversion;
-			if (typeConvert.count(token.type)) {
-				newType = typeConvert[token.type];
+			if (isExpressionToken(tokens.at((size_t)curtoken).type)) {
+				curtoken += 1;
+			} else {
+				done = true;
 			}
-			// if no conversion, ignore this token
-			if (newType == tokenTypeUNKNOWN)
-				continue;
-			
-			// if new type is numeric, adjust
-			if (newType >= tokenTypeFIRSTNUMERIC && newType <= tokenTypeLASTNUMERIC) {
-				// smart conversion of current value to decimal number (handles prefixes and all kind of convertible token types)
-				DWORD number = token.asInteger();
-				// -> back convert to destination type
-				if (newType == tokenTypeDECNUMBER) {
-					token.source = std::to_string(number);
-				} else if (newType == tokenTypeOCTNUMBER) {
-					token.source = address_to_base(number, 8, number > 255 ? 6 : 3);
-				} else if (newType == tokenTypeHEXNUMBER) {
-					token.source = address_to_base(number, 16, number > 255 ? 4 : 2);
-				} else { // binary
-					token.source = address_to_base(number, 2, number > 255 ? 16 : 8);
+		} while (!done && (curtoken <= last));
+		program.next = curtoken;
+		if (program.next <= start) return;
+		
+		// check parenthesis levels
+		int level = 0;
+		for (int i = start ; i < program.next ; i++) {
+			TokenType type = tokens[(size_t)i].type;
+			if (type == tokenTypePAROPEN) level += 1;
+			else if (type == tokenTypePARCLOSE) level -= 1;
+			if (level < 0) break;
+		}
+		program.parlevel = level;
+		if (level != 0) return;
+		
+		// shunting-yard
+		std::vector<ExpressionStep> operators;
+		bool expectOperand = true;	// true where an operand, an opening parenthesis or a unary operator is awaited
+		bool subStart = true;		// true at the start of the expression or after an opening parenthesis
+		for (int i = start ; i < program.next ; i++) {
+			TokenType type = tokens[(size_t)i].type;
+			ExpressionStep step;
+			step.index = i;
+			if (isOperandToken(type)) {
+				if (!expectOperand) return;
+				program.steps.push_back(step);
+				expectOperand = false;
+				subStart = false;
+			} else if (type == tokenTypePAROPEN) {
+				if (!expectOperand) return;
+				step.op = type;
+				operators.push_back(step);
+				subStart = true;
+			} else if (type == tokenTypePARCLOSE) {
+				if (expectOperand) return;
+				while (!operators.empty() && operators.back().op != tokenTypePAROPEN) {
+					program.steps.push_back(operators.back());
+					operators.pop_back();
+				}
+				if (operators.empty()) return;
+				operators.pop_back();
+				subStart = false;
+			} else if (expectOperand) {
+				// unary operator, must start an expression and be followed by an operand or a parenthesis
+				if ((type != tokenTypeOP_NOT) && (type != tokenTypeOP_MINUS) && (type != tokenTypeOP_HEXCHAR)) return;
+				if (!subStart) return;
+				if (i + 1 >= program.next) return;
+				TokenType nexttype = tokens[(size_t)i + 1].type;
+				if (!isOperandToken(nexttype) && nexttype != tokenTypePAROPEN) return;
+				step.op = type;
+				step.unary = true;
+				operators.push_back(step);
+				subStart = false;
+			} else {
+				// binary operator
+				if ((type == tokenTypeOP_NOT) || (type == tokenTypeOP_HEXCHAR)) return;
+				int priority = allOps[type].priority;
+				while (!operators.empty() && operators.back().op != tokenTypePAROPEN
+					   && (operators.back().unary || allOps[operators.back().op].priority <= priority)) {
+					program.steps.push_back(operators.back());
+					operators.pop_back();
 				}
+				step.op = type;
+				operators.push_back(step);
+				expectOperand = true;
 			}
-			// if new type is boolean, adjust
-			else if (newType == tokenTypeBOOL) {
-				std::string newValue = "";
-				if (newType==tokenTypeDECNUMBER || newType==tokenTypeHEXNUMBER || newType==tokenTypeOCTNUMBER || newType==tokenTypeBINNUMBER) {
-					// non null numbers considered as "true" value
-					newValue = token.asInteger() == 0 ? "" : "t";
+		}
+		if (expectOperand) return;
+		while (!operators.empty()) {
+			if (operators.back().op == tokenTypePAROPEN) return;
+			program.steps.push_back(operators.back());
+			operators.pop_back();
+		}
+		program.postfix = true;
+	}
+	
+	/** Checks that a compiled program still matches the kind of tokens it was compiled from. */
+	bool ExpressionEvaluator::Matches(ExpVector& tokens, ExpressionProgram& program)
+	{
+		if ((size_t)program.next > tokens.size()) return false;
+		for (auto & step : program.steps) {
+			TokenType type = tokens[(size_t)step.index].type;
+			if (step.op == tokenTypeUNKNOWN) {
+				if (!isOperandToken(type)) return false;
+			} else if (type != step.op) {
+				return false;
+			}
+		}
+		return true;
+	}
+	
+	/** Runs a postfix program against the current token values. Unary operators get the same arguments as in
+	 EvaluateExpression(): the operand twice for '!', and a zero left operand for '-' and HEXCHAR.
+	 */
+	ParseToken ExpressionEvaluator::Run(ExpVector& tokens, ExpressionProgram& program)
+	{
+		values.clear();
+		for (auto & step : program.steps) {
+			if (step.op == tokenTypeUNKNOWN) {
+				values.push_back(tokens[(size_t)step.index]);
+				Convert(values.back());
+			} else if (step.unary) {
+				ParseToken& arg = values.back();
+				if (step.op == tokenTypeOP_NOT) {
+					arg = allOps[step.op].op->Exec(arg, arg);
 				} else {
-					// non empty strings considered true
-					newValue = token.source.empty() ? "" : "t";
+					ParseToken zero = {"0", tokenTypeDECNUMBER};
+					arg = allOps[step.op].op->Exec(zero, arg);
 				}
-				token.source = newValue;
+			} else {
+				size_t top = values.size() - 1;
+				ParseToken result = allOps[step.op].op->Exec(values[top - 1], values[top]);
+				values.pop_back();
+				values.back() = result;
 			}
-			// value has been adjusted now take new type
-			token.type = newType;
 		}
+		return values.back();
+	}
+	
+	/** Reduces the tokens of a program in place with ReduceParenthesis() and EvaluateExpression().
+	 @throw EXPRESSIONLeftOperandMissing
+	 */
+	ParseToken ExpressionEvaluator::Reduce(ExpVector& tokens, ExpressionProgram& program)
+	{
+		// build working copy
+		stack.clear();
+		for (int i = program.start ; i < program.next ; i++) {
+			stack.push_back(tokens[(size_t)i]);
+		}
+		// programmed inter-types conversion
+		for (auto & token : stack) {
+			Convert(token);
+		}
+		//2a) reduce parenthesis
+		int stackend = (int)stack.size() - 1;
+		ReduceParenthesis(stack, 0, stackend);
 		
-		// 1) check parenthesiss levels
-		if (stack.size() > 0) {
-			int parlevel = CheckParenthesis(stack);
-			if (parlevel < 0) {
-				throw EXPRESSIONCloseParenthesisTooMuch();
-			} else if (parlevel > 0) {
-				throw EXPRESSIONOpenParenthesisTooMuch();
+		// 2b) compute expression
+		stackend = -1;
+		return EvaluateExpression(stack, 0, stackend);
+	}
+	
+	/** Evaluates a series of tokens as an expression
+	 @param tokens the vector holding all tokens from a line
+	 @param start the first token to use for evaluation
+	 @param cache compiled expressions for these tokens, nullptr to compile the expression for this evaluation only
+	 @return a token containing the result
+	 @throw EXPRESSIONLeftOperandMissing
+	 */
+	ParseToken ExpressionEvaluator::Evaluate(ExpVector& tokens, int start, int& end, ExpressionCache* cache)
+	{
+		// find or compile the program for this expression
+		ExpressionProgram local;
+		ExpressionProgram* program = nullptr;
+		if (cache) {
+			for (auto & cached : *cache) {
+				if (cached.start == start && cached.end == end) {
+					program = &cached;
+					if (!Matches(tokens, cached)) {
+						Compile(tokens, start, end, cached);
+					}
+					break;
+				}
+			}
+			if (!program) {
+				cache->emplace_back();
+				program = &cache->back();
+				Compile(tokens, start, end, *program);
 			}
+		} else {
+			program = &local;
+			Compile(tokens, start, end, local);
+		}
 		
-			//2a) reduce parenthesis
-			int stackend = (int)stack.size() - 1;
-			ReduceParenthesis(stack, 0, stackend);
-
-			// 2b) compute expression
-			stackend = -1;
-			ParseToken result = EvaluateExpression(stack, 0, stackend);
-			
-			// compute the next token index
-			end = curtoken;
-			return result;
+		if (program->next <= start) {
+			if (end == -1) {
+				end = (int)tokens.size() - 1;
+			}
+			//TODO: parenthesis error
+			return nop;
 		}
 		
-		//TODO: parenthesis error
-		return nop;
+		// 1) check parenthesiss levels
+		if (program->parlevel < 0) {
+			throw EXPRESSIONCloseParenthesisTooMuch();
+		} else if (program->parlevel > 0) {
+			throw EXPRESSIONOpenParenthesisTooMuch();
+		}
+		
+		// 2) compute expression
+		ParseToken result = program->postfix ? Run(tokens, *program) : Reduce(tokens, *program);
+		
+		// compute the next token index
+		end = program->next;
+		return result;
 	}
 
 	/** Check parenthesis levels are paired.
@@ -18,6 +18,38 @@
 
 
 namespace MUZ {
+	
+	/** One step of a compiled expression. An operand step pushes a copy of a token on the evaluation stack, an operator
+	 step replaces the top of stack by the operator result. */
+	struct ExpressionStep {
+		/** Operator type, or tokenTypeUNKNOWN for an operand. */
+		TokenType	op = tokenTypeUNKNOWN;
+		/** Index of the operand or operator in the tokens array. */
+		int			index = 0;
+		/** True for unary operators: '!', HEXCHAR and a '-' starting an expression. */
+		bool		unary = false;
+	};
+	
+	/** Postfix program compiled from a range of expression tokens. The program only depends on the kind of each token
+	 (operand, operator or parenthesis) and not on values, so it stays valid when symbols change between passes. */
+	struct ExpressionProgram {
+		/** First token of the expression. */
+		int			start = 0;
+		/** Last token given by the caller, -1 for the end of tokens. */
+		int			end = -1;
+		/** Index of the first token after the expression. */
+		int			next = 0;
+		/** Parenthesis balance computed by CheckParenthesis(). */
+		int			parlevel = 0;
+		/** False if the expression has an unusual syntax and must be reduced in place by EvaluateExpression(). */
+		bool		postfix = false;
+		/** Operands and operators in postfix order. */
+		std::vector<ExpressionStep> steps;
+	};
+	
+	/** Compiled expressions for one code line. */
+	typedef std::vector<ExpressionProgram> ExpressionCache;
+	
 
 
 	/** Class for the expression evaluator. Automatic type conversion can be set in the evaluator: it will replaced a type by another in all internal sub expressions before evaluation by operators. */
@@ -25,6 +57,8 @@ namespace MUZ {
 	{
 		/** Stack for arguments and operators. */
 		ExpVector stack;
+		/** Stack for postfix program values. */
+		std::vector<ParseToken> values;
 		
 		/** Specific type conversions. */
 		std::map<TokenType, TokenType>typeConvert;
@@ -41,6 +75,18 @@ namespace MUZ {
 		 @throw EXPRESSIONLeftOperandMissing
 		 */
 		ParseToken ReduceParenthesis(ExpVector& tokens, int start, int& end) noexcept(false);
+		/** Applies the programmed type conversions to a token. */
+		void Convert(ParseToken& token);
+		/** Compiles the expression starting at a given token into a postfix program. */
+		void Compile(ExpVector& tokens, int start, int end, ExpressionProgram& program);
+		/** Checks that a compiled program still matches the kind of tokens it was compiled from. */
+		bool Matches(ExpVector& tokens, ExpressionProgram& program);
+		/** Runs a postfix program against the current token values. */
+		ParseToken Run(ExpVector& tokens, ExpressionProgram& program);
+		/** Reduces the tokens of a program in place, for expressions which could not be compiled in postfix.
+		 @throw EXPRESSIONLeftOperandMissing
+		 */
+		ParseToken Reduce(ExpVector& tokens, ExpressionProgram& program) noexcept(false);
 
 	public:
 		ExpressionEvaluator();
@@ -60,10 +106,11 @@ namespace MUZ {
 		int CheckParenthesis(ExpVector& tokens);
 		
 		/** Evaluates a sub expression starting at a given token until end of tokens or invalid token type.
-		 Returns a result, and updates the last token used
+		 Returns a result, and updates the last token used. When a cache is given, the expression is compiled once
+		 and the compiled program is reused by next evaluations of the same tokens.
 		 @throw EXPRESSIONLeftOperandMissing
 		 */
-		ParseToken Evaluate(ExpVector& tokens, int start, int& end) noexcept(false);
+		ParseToken Evaluate(ExpVector& tokens, int start, int& end, ExpressionCache* cache = nullptr) noexcept(false);
 	};
 	
 } // namespace
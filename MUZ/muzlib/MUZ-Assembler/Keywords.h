@@ -0,0 +1,138 @@
+//
+//  Keywords.h
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+
+#ifndef Keywords_h
+#define Keywords_h
+
+#include <string>
+#include "MUZ-Common/Types.h"
+
+namespace MUZ {
+
+	/** Perfect hash for the directive names, instruction mnemonics and operand names.
+	 Each keyword is identified by its index in the names table. The hash slots are computed by the compiler and
+	 checked to be free of collisions, so a lookup costs one hash of the name and one comparison, without
+	 allocating an upper case copy.
+	 Every name registered in Assembler::m_directives or Assembler::m_instructions must be listed here. */
+	namespace Keywords {
+
+		/** All the keywords: directives (without their '.' or '#' prefix), Z-80 and Z-180 mnemonics, then register and
+		 condition names. */
+		constexpr const char* names[] = {
+			"DEFINE", "UNDEF", "IF", "COND", "IFDEF", "ELSE", "IFNDEF", "ENDIF", "ENDC", "INCLUDE",
+			"INSERTHEX", "INSERTBIN", "NOLIST", "LIST", "REQUIRES", "IFREQUIRED", "PROC", "ORG", "DATA",
+			"CODE", "END", "EQU", "SET", "BYTE", "DB", "DEFB", "WORD", "DW", "DEFW", "SPACE", "DS", "DEFS",
+			"HEXBYTES", "RELAX", "MACRO", "ENDM", "REPT", "ENDR",
+			"LD", "PUSH", "POP", "EXX", "EX", "LDI", "LDIR", "LDD", "LDDR", "CPI", "CPIR", "CPD", "CPDR",
+			"ADD", "ADC", "SUB", "SBC", "AND", "OR", "XOR", "CP", "INC", "DEC", "DAA", "CPL", "NEG", "CCF",
+			"SCF", "NOP", "HALT", "DI", "EI", "IM", "RLCA", "RLA", "RRCA", "RRA", "RLC", "RL", "RRC", "RR",
+			"SLA", "SLL", "SRA", "SRL", "RLD", "RRD", "BIT", "RES", "JP", "JR", "DJNZ", "CALL", "RET",
+			"RETI", "RETN", "RST", "IN", "INI", "INIR", "IND", "INDR", "OUT", "OUTI", "OTIR", "OUTD", "OTDR",
+			"MLT", "MULT", "OTIM", "OTIMR", "OTDM", "OTDMR", "IN0", "OUT0", "SLP", "TST", "TSTIO",
+			"A", "B", "C", "D", "E", "H", "L", "I", "R", "F", "IXH", "IXL", "IYH", "IYL",
+			"AF", "AF'", "BC", "DE", "HL", "SP", "IX", "IY",
+			"NZ", "Z", "NC", "PO", "PE", "P", "M",
+		};
+
+		/** Number of keywords. */
+		constexpr int COUNT = (int)(sizeof(names) / sizeof(names[0]));
+		/** Number of hash slots, must be a power of 2. */
+		constexpr DWORD SLOTS = 1024;
+		/** Hash seed giving no collision for the keywords in SLOTS slots. Must be changed when a collision is signaled. */
+		constexpr DWORD SEED = 0x171B;
+
+		/** Upper case of an ASCII character. */
+		constexpr char Upper(char c) {
+			return (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+		}
+
+		/** Length of a C string. */
+		constexpr size_t Length(const char* s) {
+			size_t length = 0;
+			while (s[length]) length += 1;
+			return length;
+		}
+
+		/** Longest keyword length, longer names are rejected without hashing. */
+		constexpr size_t MaxLength() {
+			size_t longest = 0;
+			for (int i = 0 ; i < COUNT ; i++) {
+				if (Length(names[i]) > longest) longest = Length(names[i]);
+			}
+			return longest;
+		}
+		constexpr size_t MAXLENGTH = MaxLength();
+
+		/** Case insensitive FNV-1a hash of a name, reduced to a slot number. */
+		constexpr DWORD Slot(const char* s, size_t length) {
+			DWORD h = SEED;
+			for (size_t i = 0 ; i < length ; i++) {
+				h ^= (DWORD)(unsigned char)Upper(s[i]);
+				h *= 16777619u;
+			}
+			h ^= h >> 15;
+			return h & (SLOTS - 1);
+		}
+
+		/** Case insensitive comparison of a name with an upper case keyword. */
+		constexpr bool Equal(const char* s, size_t length, const char* keyword) {
+			for (size_t i = 0 ; i < length ; i++) {
+				if (keyword[i] == 0 || Upper(s[i]) != keyword[i]) return false;
+			}
+			return keyword[length] == 0;
+		}
+
+		/** Index of a keyword, -1 if the name is not a keyword. This is meant for compile time constants like Index("IF"). */
+		constexpr int Index(const char* name) {
+			for (int i = 0 ; i < COUNT ; i++) {
+				if (Equal(name, Length(name), names[i])) return i;
+			}
+			return -1;
+		}
+
+		/** Slots table, gives the keyword index for each hash slot or -1 for unused slots. */
+		struct SlotsTable {
+			short index[SLOTS];
+		};
+
+		constexpr SlotsTable BuildSlots() {
+			SlotsTable table = {};
+			for (DWORD i = 0 ; i < SLOTS ; i++) table.index[i] = -1;
+			for (int i = 0 ; i < COUNT ; i++) table.index[Slot(names[i], Length(names[i]))] = (short)i;
+			return table;
+		}
+		constexpr SlotsTable slots = BuildSlots();
+
+		/** Checks that each keyword has its own slot. */
+		constexpr bool IsPerfect() {
+			for (int i = 0 ; i < COUNT ; i++) {
+				if (slots.index[Slot(names[i], Length(names[i]))] != i) return false;
+			}
+			return true;
+		}
+		static_assert(IsPerfect(), "keywords hash has collisions, change Keywords::SEED");
+
+		/** Returns the index of a keyword in any case, or -1 if the name is not a keyword. */
+		inline int Find(const char* s, size_t length) {
+			if (length == 0 || length > MAXLENGTH) return -1;
+			int index = slots.index[Slot(s, length)];
+			return (index >= 0 && Equal(s, length, names[index])) ? index : -1;
+		}
+		inline int Find(const std::string& name) {
+			return Find(name.data(), name.size());
+		}
+
+		/** Tells if a name matches an upper case word in any case. */
+		inline bool Match(const std::string& name, const char* word) {
+			return Equal(name.data(), name.size(), word);
+		}
+
+	} // namespace Keywords
+
+} // namespace MUZ
+
+#endif /* Keywords_h */
@@ -18,13 +18,14 @@ namespace MUZ {
 	/** Structure to store a label from source file. */
 	class Label
 	{
-		size_t							file;
-		size_t 							line;
+		size_t							file = 0;
+		size_t 							line = 0;
 	public:
 		std::vector<DWORD>				addresses;		// addresses of this label, unique for global label, multiple for local
 		bool							equate=false;	// this label is set by a .EQU
 		std::vector<struct CodeLine*>	referencers;	// Code lines where it is used
 		bool							multiple=false;	// true to authorize more than one address
+		bool							redefined=false;// true if a value has been set again after an address or a .EQU value
 		
 		void ClearAddresses() {
 			addresses.clear();
@@ -35,6 +36,16 @@ namespace MUZ {
 			line = theline;
 		}
 
+		/** Returns the file where the label is defined. */
+		size_t File() const {
+			return file;
+		}
+		
+		/** Returns the line where the label is defined. */
+		size_t Line() const {
+			return line;
+		}
+
 		/** returns true if the label is at the given file/line .*/
 		bool isAt(size_t thefile, size_t theline) {
 			return (file == thefile && line == theline);
@@ -42,6 +53,7 @@ namespace MUZ {
 
 		/** Sets a label address value from a .EQU directive. This sets the label with a unique value and equate mode. */
 		void Equate(unsigned int integer) {
+			if (equate && !addresses.empty()) redefined = true;
 			equate = true;
 			multiple = false;
 			ClearAddresses();
@@ -50,6 +62,7 @@ namespace MUZ {
 		
 		/** Sets an address into the label. If the label accepts multiple values, it is added to existing values, else it replaces the current value. */
 		void SetAddress( unsigned int integer ) {
+			if (!addresses.empty()) redefined = true;
 			if (equate) Equate(integer);
 			if (!multiple) ClearAddresses();
 			addresses.push_back(integer);
@@ -0,0 +1,240 @@
+//
+//  LexCache.cpp
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+#include "pch.h"
+#include "LexCache.h"
+#include "Assembler.h"
+#include "MUZ-Common/FileUtils.h"
+#include "MUZ-Common/StrUtils.h"
+#include <thread>
+#include <algorithm>
+
+namespace MUZ {
+
+	/** Cache file signature and format version, the version must be changed when the Parser splits lines differently
+	 or when the Keywords names change, because the tokens store their keyword index. */
+	static const char LEXCACHE_MAGIC[4] = { 'M', 'U', 'Z', 'L' };
+	static const DWORD LEXCACHE_VERSION = 3;
+
+	/** Reads cache file values from a buffer, fails for good at the first read past the end of the buffer. */
+	struct CacheReader {
+		const std::vector<char>& buffer;
+		size_t pos = 0;
+		bool ok = true;
+
+		CacheReader(const std::vector<char>& b) : buffer(b) {}
+
+		bool Read(void* value, size_t length) {
+			if (!ok || pos + length > buffer.size()) return ok = false;
+			memcpy(value, buffer.data() + pos, length);
+			pos += length;
+			return true;
+		}
+		template<typename T> T Get() {
+			T value = 0;
+			Read(&value, sizeof(value));
+			return value;
+		}
+	};
+
+	/** Writes a value to a cache file. */
+	template<typename T> static void Put(FILE* f, T value) {
+		fwrite(&value, sizeof(value), 1, f);
+	}
+
+	/** Path of the cache file for a content hash. */
+	std::string LexCache::FilePath(uint64_t hash) const
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.lex", (unsigned long long)hash);
+		return m_directory + NORMAL_DIR_SEPARATOR + name;
+	}
+
+		/** Sets the cache directory and creates it if needed. An empty directory disables the cache files. */
+	void LexCache::SetDirectory(const std::string& directory)
+	{
+		m_directory = directory;
+		if (!m_directory.empty() && !ExistDir(m_directory)) {
+			_mkdir(m_directory.c_str());
+		}
+	}
+
+	/** Enables the memory cache. */
+	void LexCache::EnableMemory(bool yes)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_memory = yes;
+		if (!yes) m_memorylines.clear();
+	}
+
+	/** Forgets the least recently used contents kept in memory beyond the given count. */
+	void LexCache::TrimMemory(size_t maxfiles)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_memorylines.size() <= maxfiles) return;
+		if (maxfiles == 0) {
+			m_memorylines.clear();
+			return;
+		}
+		std::vector<uint64_t> stamps;
+		for (auto & entry : m_memorylines) {
+			stamps.push_back(entry.second.used);
+		}
+		std::nth_element(stamps.begin(), stamps.begin() + (long)(stamps.size() - maxfiles), stamps.end());
+		uint64_t oldest = stamps[stamps.size() - maxfiles];
+		for (auto entry = m_memorylines.begin() ; entry != m_memorylines.end() ; ) {
+			if (entry->second.used < oldest) {
+				entry = m_memorylines.erase(entry);
+			} else {
+				++entry;
+			}
+		}
+	}
+
+	/** Loads the split tokens for a source content into one CodeLine per text line, returns false if the content
+	 is not in the cache. */
+	bool LexCache::Load(const SourceText& text, Assembler& as, std::vector<CodeLine>& lines)
+	{
+		if (!Enabled()) return false;
+		uint64_t hash = text.Hash();
+		
+		// lines in memory are copied, then their symbols and directive are set for this assembler
+		if (m_memory) {
+			std::shared_ptr<const std::vector<CodeLine>> memorylines;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				auto found = m_memorylines.find(hash);
+				if (found != m_memorylines.end()) {
+					memorylines = found->second.lines;
+					found->second.used = ++m_stamp;
+				}
+			}
+			if (memorylines && memorylines->size() == text.LineCount()) {
+				lines.assign(memorylines->begin(), memorylines->end());
+				for (auto & cl : lines) {
+					cl.lexedtokens.update();
+					for (auto & token : cl.lexedtokens) {
+						if (token.type == tokenTypeLETTERS) {
+							token.symbol = as.InternSymbol(token.source);
+						} else if (token.type == tokenTypeDIRECTIVE) {
+							cl.lexeddirective = as.GetDirective(token.keyword);
+						}
+					}
+				}
+				return true;
+			}
+		}
+		if (m_directory.empty()) return false;
+		
+		FILE* f = fopen(FilePath(hash).c_str(), "rb");
+		if (!f) return false;
+		std::vector<char> buffer;
+		char block[4096];
+		size_t read;
+		while ((read = fread(block, 1, sizeof(block), f)) > 0) {
+			buffer.insert(buffer.end(), block, block + read);
+		}
+		fclose(f);
+
+		// check the header against the content
+		CacheReader reader(buffer);
+		char magic[4];
+		reader.Read(magic, sizeof(magic));
+		if (!reader.ok || memcmp(magic, LEXCACHE_MAGIC, sizeof(magic)) != 0) return false;
+		if (reader.Get<DWORD>() != LEXCACHE_VERSION) return false;
+		if (reader.Get<uint64_t>() != hash) return false;
+		if (reader.Get<uint64_t>() != (uint64_t)text.Size()) return false;
+		size_t nblines = reader.Get<DWORD>();
+		if (!reader.ok || nblines != text.LineCount()) return false;
+
+		// read the tokens for each line
+		std::vector<CodeLine> cached(nblines);
+		for (auto & cl : cached) {
+			if (reader.Get<BYTE>() == 0) continue;
+			cl.lexedflag = reader.Get<int>();
+			size_t nbtokens = reader.Get<DWORD>();
+			for (size_t i = 0 ; reader.ok && (i < nbtokens) ; i++) {
+				ParseToken token;
+				token.type = (TokenType)reader.Get<int>();
+				token.keyword = reader.Get<int>();
+				if (token.keyword < -1 || token.keyword >= Keywords::COUNT) return false;
+				token.source.resize(reader.Get<DWORD>());
+				reader.Read(&token.source[0], token.source.size());
+				if (token.type == tokenTypeLETTERS) {
+					token.symbol = as.InternSymbol(token.source);
+				} else if (token.type == tokenTypeDIRECTIVE) {
+					// the last directive of the line is the one kept by the split
+					cl.lexeddirective = as.GetDirective(token.keyword);
+				}
+				cl.lexedtokens.push_back(token);
+			}
+			cl.lexed = true;
+		}
+		if (!reader.ok) return false;
+		lines = std::move(cached);
+		return true;
+	}
+
+	/** Saves the split tokens of the lines for a source content. */
+	void LexCache::Save(const SourceText& text, const std::vector<CodeLine>& lines, const std::vector<CodeLine>& unread)
+	{
+		if (!Enabled()) return;
+		if (lines.size() + unread.size() != text.LineCount()) return;
+		uint64_t hash = text.Hash();
+		
+		// keep a copy of the split tokens in memory
+		if (m_memory) {
+			std::vector<CodeLine>* memorylines = new std::vector<CodeLine>(text.LineCount());
+			size_t line = 0;
+			for (const std::vector<CodeLine>* part : { &lines, &unread }) {
+				for (auto & cl : *part) {
+					CodeLine& copy = (*memorylines)[line++];
+					copy.lexedtokens = cl.lexedtokens;
+					copy.lexedtokens.update();
+					copy.lexedflag = cl.lexedflag;
+					copy.lexed = cl.lexed;
+				}
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			MemoryLines& entry = m_memorylines[hash];
+			if (!entry.lines) entry.lines.reset(memorylines); else delete memorylines;
+			entry.used = ++m_stamp;
+		}
+		if (m_directory.empty()) return;
+		
+		std::string path = FilePath(hash);
+
+		// write a temporary file so that other assemblies never read a partial cache file
+		std::string temppath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		FILE* f = fopen(temppath.c_str(), "wb");
+		if (!f) return;
+		fwrite(LEXCACHE_MAGIC, sizeof(LEXCACHE_MAGIC), 1, f);
+		Put<DWORD>(f, LEXCACHE_VERSION);
+		Put<uint64_t>(f, hash);
+		Put<uint64_t>(f, (uint64_t)text.Size());
+		Put<DWORD>(f, (DWORD)text.LineCount());
+		for (const std::vector<CodeLine>* part : { &lines, &unread }) {
+			for (auto & cl : *part) {
+				Put<BYTE>(f, cl.lexed ? 1 : 0);
+				if (!cl.lexed) continue;
+				Put<int>(f, cl.lexedflag);
+				Put<DWORD>(f, (DWORD)cl.lexedtokens.size());
+				for (auto & token : cl.lexedtokens) {
+					Put<int>(f, (int)token.type);
+					Put<int>(f, token.keyword);
+					Put<DWORD>(f, (DWORD)token.source.size());
+					fwrite(token.source.data(), 1, token.source.size(), f);
+				}
+			}
+		}
+		bool written = (ferror(f) == 0);
+		fclose(f);
+		if (!written || rename(temppath.c_str(), path.c_str()) != 0) {
+			remove(temppath.c_str());
+		}
+	}
+
+} // namespace MUZ
@@ -0,0 +1,72 @@
+//
+//  LexCache.h
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+
+#ifndef LexCache_h
+#define LexCache_h
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "MUZ-Common/SourceText.h"
+#include "CodeLine.h"
+
+namespace MUZ {
+
+	/** On-disk cache of the split tokens for source files, shared by successive assemblies.
+	 Each cache file is named from the hash of a source content and stores the lexedtokens, lexeddirective and
+	 lexedflag of every line, so an unchanged file can have its lines restored instead of being split again. The split
+	 only depends on the source text, not on the assembly state, so the content hash is the only key. Interned symbols
+	 are not stored: the LETTERS tokens are interned again when loaded.
+	 A cache can also keep the split lines in memory, to be shared by several assemblers working in parallel threads
+	 on the same sources. */
+	class LexCache
+	{
+		/** Directory for the cache files, empty if the cache files are disabled. */
+		std::string		m_directory;
+		/** Split lines kept in memory by content hash, if the memory cache is enabled, with the stamp of their
+		 last use. */
+		struct MemoryLines {
+			std::shared_ptr<const std::vector<CodeLine>> lines;
+			uint64_t used = 0;
+		};
+		bool			m_memory = false;
+		std::unordered_map<uint64_t, MemoryLines> m_memorylines;
+		uint64_t		m_stamp = 0;
+		std::mutex		m_mutex;
+
+		/** Path of the cache file for a content hash. */
+		std::string FilePath(uint64_t hash) const;
+
+	public:
+		/** Sets the cache directory and creates it if needed. An empty directory disables the cache files. */
+		void SetDirectory(const std::string& directory);
+
+		/** Enables the memory cache. */
+		void EnableMemory(bool yes);
+
+		/** Forgets the least recently used contents kept in memory beyond the given count. */
+		void TrimMemory(size_t maxfiles);
+
+		/** Tells if the cache is enabled. */
+		bool Enabled() const {
+			return m_memory || !m_directory.empty();
+		}
+
+		/** Loads the split tokens for a source content into one CodeLine per text line, returns false if the content
+		 is not in the cache. The source member of the lines is not set. */
+		bool Load(const SourceText& text, class Assembler& as, std::vector<CodeLine>& lines);
+
+		/** Saves the split tokens of the lines for a source content. Lines which have not been split are saved
+		 as such and will be split when the file is assembled again. */
+		void Save(const SourceText& text, const std::vector<CodeLine>& lines, const std::vector<CodeLine>& unread);
+	};
+
+} // namespace MUZ
+
+#endif /* LexCache_h */
@@ -0,0 +1,79 @@
+//
+//  LineSplitter.cpp
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+#include "pch.h"
+#include "LineSplitter.h"
+#include "Assembler.h"
+#include "Parser.h"
+
+namespace MUZ {
+
+	LineSplitter::LineSplitter() : m_produced(0), m_consumed(0), m_stop(false)
+	{
+	}
+
+	/** Stops the worker and waits for it. */
+	LineSplitter::~LineSplitter()
+	{
+		m_stop = true;
+		if (m_worker.joinable()) m_worker.join();
+	}
+
+	/** Tells if a text with this number of lines should be split by a worker. */
+	bool LineSplitter::Worthwhile(size_t nblines)
+	{
+		static const unsigned processors = std::thread::hardware_concurrency();
+		return (nblines >= SPLITTER_MINLINES) && (processors > 1);
+	}
+
+	/** Starts splitting the lines of a text. */
+	void LineSplitter::Start(const SourceText& text, Assembler& as)
+	{
+		m_ring.resize(SPLITTER_AHEAD);
+		m_worker = std::thread(&LineSplitter::Split, this, std::cref(text), std::ref(as));
+	}
+
+	/** Worker function, splits all the lines of the text. */
+	void LineSplitter::Split(const SourceText& text, Assembler& as)
+	{
+		Parser parser(as, true);
+		ErrorList msg;
+		for (size_t line = 0 ; line < text.LineCount() ; line++) {
+			// wait for a free slot
+			while (line - m_consumed.load(std::memory_order_acquire) >= SPLITTER_AHEAD) {
+				if (m_stop) return;
+				std::this_thread::yield();
+			}
+			CodeLine& cl = m_ring[line % SPLITTER_AHEAD];
+			cl = CodeLine();
+			cl.source.assign(text.LineStart(line), text.LineLength(line));
+			try {
+				parser.Split(cl, msg);
+			} catch (std::exception&) {
+				cl.lexed = false; // the assembler will split it again and handle the error
+			}
+			m_produced.store(line + 1, std::memory_order_release);
+		}
+	}
+
+	/** Takes the next line in order. */
+	void LineSplitter::Take(CodeLine& codeline, Assembler& as)
+	{
+		size_t line = m_consumed.load(std::memory_order_relaxed);
+		while (m_produced.load(std::memory_order_acquire) <= line) {
+			std::this_thread::yield();
+		}
+		CodeLine& cl = m_ring[line % SPLITTER_AHEAD];
+		codeline.TakeSource(cl);
+		for (auto & token : codeline.lexedtokens) {
+			if (token.type == tokenTypeLETTERS) {
+				token.symbol = as.InternSymbol(token.source);
+			}
+		}
+		m_consumed.store(line + 1, std::memory_order_release);
+	}
+
+} // namespace MUZ
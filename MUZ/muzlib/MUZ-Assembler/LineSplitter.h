@@ -0,0 +1,66 @@
+//
+//  LineSplitter.h
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+
+#ifndef LineSplitter_h
+#define LineSplitter_h
+
+#include <atomic>
+#include <thread>
+#include "MUZ-Common/SourceText.h"
+#include "CodeLine.h"
+
+namespace MUZ {
+
+	/** Splits the lines of a source text on a worker thread, ahead of the pass 1 which takes them in order.
+	 The split lines go through a bounded single producer/single consumer ring: the worker waits when it is
+	 SPLITTER_AHEAD lines ahead of the assembler, and the assembler waits when it catches up with the worker.
+	 The worker uses a background Parser, so the assembler interns the symbols when it takes a line, and the lines
+	 giving a warning are left unsplit and will be split by the assembler. */
+	class LineSplitter
+	{
+		/** Number of lines the worker can split ahead of the assembler. */
+		static const size_t SPLITTER_AHEAD = 1024;
+
+		/** Ring of split lines, line N is in slot N % SPLITTER_AHEAD. */
+		std::vector<CodeLine>	m_ring;
+		/** Number of lines split by the worker. */
+		std::atomic<size_t>		m_produced;
+		/** Number of lines taken by the assembler. */
+		std::atomic<size_t>		m_consumed;
+		/** Tells the worker to stop, when the assembler doesn't take all the lines. */
+		std::atomic<bool>		m_stop;
+		/** Worker thread. */
+		std::thread				m_worker;
+
+		/** Worker function, splits all the lines of the text. */
+		void Split(const SourceText& text, class Assembler& as);
+
+	public:
+		LineSplitter();
+		/** Stops the worker and waits for it. */
+		~LineSplitter();
+		LineSplitter(const LineSplitter&) = delete;
+		LineSplitter& operator=(const LineSplitter&) = delete;
+
+		/** Minimum number of lines for a text to be worth a worker thread. */
+		static const size_t SPLITTER_MINLINES = 256;
+
+		/** Tells if a text with this number of lines should be split by a worker: the text must be long enough and
+		 the system must run threads on more than one processor. */
+		static bool Worthwhile(size_t nblines);
+
+		/** Starts splitting the lines of a text, which must stay open until the splitter is deleted. */
+		void Start(const SourceText& text, class Assembler& as);
+
+		/** Takes the next line in order: waits for the worker to split it, then moves its source and split
+		 tokens into a code line, interning the symbols. */
+		void Take(CodeLine& codeline, class Assembler& as);
+	};
+
+} // namespace MUZ
+
+#endif /* LineSplitter_h */
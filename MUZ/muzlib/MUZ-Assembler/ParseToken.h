@@ -13,6 +13,8 @@
 #include "MUZ-Common/Types.h"
 #include "MUZ-Common/StrUtils.h"
 #include "TokenType.h"
+#include "Symbols.h"
+#include "Keywords.h"
 
 namespace MUZ {
 	
@@ -32,11 +34,34 @@ namespace MUZ {
 		 	as a directiven an instruction, or a symbol. It is normal for symbols which appear later in assembly
 		    to have this flag set.*/
 		bool 		unsolved = false;
+		/** Numeric value for decimal number tokens computed by symbols resolution or by operators. When 'valued' is true,
+		 the source string is left empty: use asInteger(), asAddress() or asString() to read the value. */
+		DWORD		value = 0;
+		bool		valued = false;
+		/** Interned name for LETTERS tokens, set by the parser. 0 for other tokens or when the source has been replaced. */
+		SYMBOLID	symbol = 0;
+		/** Keyword index for LETTERS and DIRECTIVE tokens, set by the parser. -1 if the token is not a keyword. */
+		int			keyword = -1;
+		
+		/** Turns the token into a decimal number holding the given value. */
+		void setNumber(DWORD number) {
+			type = tokenTypeDECNUMBER;
+			value = number;
+			valued = true;
+			symbol = 0;
+			keyword = -1;
+			source.clear();
+		}
+		
+		/** Returns the source string, or the decimal representation for a valued number. */
+		std::string asString() const {
+			return valued ? std::to_string(value) : source;
+		}
 
 		/** Returns true if this token is one of the including file directive. */
 		bool isIncludingDirective() {
 			//return (type == tokenTypeDIRECTIVE) && ((source == "#INCLUDE") || (source == "#INSERTHEX") || (source == "#INSERTBIN"));
-			return (type == tokenTypeDIRECTIVE) && ((source == "INCLUDE") || (source == "INSERTHEX") || (source == "INSERTBIN"));
+			return (type == tokenTypeDIRECTIVE) && ((keyword == Keywords::Index("INCLUDE")) || (keyword == Keywords::Index("INSERTHEX")) || (keyword == Keywords::Index("INSERTBIN")));
 		}
 
 		/** Returns true if the token type is one of the given vector. */
@@ -61,6 +86,7 @@ namespace MUZ {
 		 	Hexa, decimal, binary and octal numbers will return their value
 		 	String will return the appropriate values for accepptable prefixes (0x, 0b, 0) and suffixes (H, B)  */
 		DWORD asInteger() {
+			if (valued) return value;
 			if (source.empty()) return 0;
 			if (type <= tokenTypeFIRSTCONVERTIBLE || type >= tokenTypeLASTCONVERTIBLE) return 0;
 			switch (type) {
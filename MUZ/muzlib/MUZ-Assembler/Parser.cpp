@@ -208,8 +208,10 @@ namespace MUZ {
 			
 			// Test as a directive, only for letters
 			Directive* directive = nullptr;
+			int keyword = -1;
 			if (type == tokenTypeLETTERS || type == tokenTypeDIRECTIVE) {
-				directive = as->GetDirective(word);
+				keyword = Keywords::Find(word);
+				directive = as->GetDirective(keyword);
 				if (directive) {
 					type = tokenTypeDIRECTIVE;
 				}
@@ -219,19 +221,36 @@ namespace MUZ {
 			ParseToken token;
 			token.source = word;
 			token.type = type;
+			token.keyword = keyword;
+			if (type == tokenTypeLETTERS && !background) {
+				token.symbol = as->InternSymbol(word);
+			}
 			tokens->push_back(token);// store current value
 			
 			// set result flags for some directives and handle special #INCLUDE case
 			if (token.type == tokenTypeDIRECTIVE) {
 				resultFlag = hasNOTHING;
 				lastDirective = directive;
-				if (DirectiveIF::Identify(token.source) || DirectiveIFREQUIRED::Identify(token.source) || DirectiveIFDEF::Identify(token.source) || DirectiveIFNDEF::Identify(token.source)) {
-					resultFlag = hasIF;
+				switch (keyword) {
+					case Keywords::Index("IF"):
+					case Keywords::Index("COND"):
+					case Keywords::Index("IFREQUIRED"):
+					case Keywords::Index("IFDEF"):
+					case Keywords::Index("IFNDEF"):
+						resultFlag = hasIF;
+						break;
+					case Keywords::Index("ELSE"):
+						resultFlag = hasELSE;
+						break;
+					case Keywords::Index("ENDIF"):
+					case Keywords::Index("ENDC"):
+						resultFlag = hasENDIF;
+						break;
+					case Keywords::Index("DEFINE"):
+						resultFlag = hasDEFINE;
+						break;
 				}
-				else if (DirectiveELSE::Identify(token.source)) resultFlag = hasELSE;
-				else if (DirectiveENDIF::Identify(token.source)) resultFlag = hasENDIF;
-				else if (DirectiveDEFINE::Identify(token.source)) resultFlag = hasDEFINE;
-				else if (token.isIncludingDirective()) {
+				if (token.isIncludingDirective()) {
 					// special case: the rest of source is a filename even if no quotes surrounds it
 					// first skip white space
 					size_t len = source->length();
@@ -261,11 +280,12 @@ namespace MUZ {
 	
 	// publics
 	
-	Parser::Parser(class Assembler& assembler) {
+	Parser::Parser(class Assembler& assembler, bool background) {
 		// references to (CodeLine) elements
 		tokens = nullptr;
 		curtoken = nullptr;
 		as = &assembler;
+		this->background = background;
 		
 		//internal allocated objects
 		evalString = new ExpressionEvaluator;
@@ -313,52 +333,44 @@ namespace MUZ {
 		auto &token = tokens->at((size_t)index);
 		if (token.type == tokenTypeCOMMENT)
 			return true;
-		if (token.type == tokenTypeDECNUMBER)
+		if (token.type == tokenTypeDECNUMBER) {
+			if (!token.valued) token.setNumber(dec_to_unsigned(token.source));
 			return true;
+		}
 		// This only occurs on the LETTER type tokens
 		if (token.type == tokenTypeLETTERS) {
 			if (as->ReplaceDefSymbol(token))
 				return true;
-			if (as->ReplaceLabel(token.source)) {
-				token.type = tokenTypeDECNUMBER;
+			if (as->ReplaceLabel(token))
 				return true;
-			}
 			token.unsolved = true;
 			return false;// unknown symbol, not resolved
 		}
 		// replace "$" current address if found
 		if (token.type == tokenTypeDOLLAR) {
-			token.source = std::to_string(as->GetAddress());
-			token.type = tokenTypeDECNUMBER;
+			token.setNumber(as->GetAddress());
 			return true;
 		}
 		// translate hex numbers
 		if (token.type == tokenTypeHEXNUMBER) {
-			unsigned int uint = hex_to_unsigned(token.source);
-			token.source = std::to_string(uint);
-			token.type = tokenTypeDECNUMBER;
+			token.setNumber(hex_to_unsigned(token.source));
 			return true;
 		}
 		// translate binary numbers
 		if (token.type == tokenTypeBINNUMBER) {
-			unsigned int uint = bin_to_unsigned(token.source);
-			token.source = std::to_string(uint);
-			token.type = tokenTypeDECNUMBER;
+			token.setNumber(bin_to_unsigned(token.source));
 			return true;
 		}
 		// translate octal numbers
 		if (token.type == tokenTypeOCTNUMBER) {
-			unsigned int uint = oct_to_unsigned(token.source);
-			token.source = std::to_string(uint);
-			token.type = tokenTypeDECNUMBER;
+			token.setNumber(oct_to_unsigned(token.source));
 			return true;
 		}
 		// translate characters in bytes
 		if (token.type == tokenTypeCHAR) {
 			token.source = unescape(token.source, joker); // take care of escaped characters
 			unsigned int uint = token.source.size() > 0 ? (unsigned int)token.source.at(0) : 0; // '' will be 00
-			token.source = std::to_string(uint);
-			token.type = tokenTypeDECNUMBER;
+			token.setNumber(uint);
 			return true;
 		}
 		// translate escape sequences in strings
@@ -409,16 +421,23 @@ namespace MUZ {
 	{
 		// Init target on codeline
 		tokens = &codeline.tokens;
+		expressions = &codeline.expressions;
 		curtoken = &codeline.curtoken;
 		source = &codeline.source;
 		
-		// split initialisation
+		// split initialisation, the parser is reused for all the lines
 		*curtoken = 0;
 		tokens->clear();
 		resultFlag = hasNOTHING;
+		lastDirective = nullptr;
+		status = inNothing;
+		doubleQuoted = false;
+		warned = false;
+		hasNext = true;
+		c = nextc = upperc = uppernextc = '\0';
 		pos = -1;								// current parsing position in string
 		const int len = (int)source->length();		// explicitely signed because unsigned would fail the test (pos < len)
-		word.empty();							// current parsed word
+		word.clear();							// current parsed word
 		type = tokenTypeUNKNOWN;				// current token type
 				
 		tokens->clear();						// clear results
@@ -576,7 +595,8 @@ namespace MUZ {
 				// we're not supposed to reach here: would mean a '.' or '#' contained in a word
 				// so just keep going and emit a warning
 				word += c;
-				msg.Warning(warningMisplacedChar, codeline); // pass 1 only
+				if (background) warned = true;
+				else msg.Warning(warningMisplacedChar, codeline); // pass 1 only
 				continue;
 			}
 			
@@ -801,6 +821,55 @@ namespace MUZ {
 		
 		// store last current token if any
 		StoreToken();
+		
+		// keep the result so next passes don't need to split again
+		codeline.lexedtokens = *tokens;
+		codeline.lexedtokens.update();
+		codeline.lexeddirective = lastDirective;
+		codeline.lexedflag = (int)resultFlag;
+		codeline.lexed = !warned;
+	}
+
+	/** Restores the tokens kept by a previous Split() of the same code line. The copy is needed because
+	 the tokens are modified by symbols resolution and expression evaluation.
+	 */
+	bool Parser::Restore(CodeLine& codeline)
+	{
+		if (!codeline.lexed) return false;
+		tokens = &codeline.tokens;
+		expressions = &codeline.expressions;
+		curtoken = &codeline.curtoken;
+		source = &codeline.source;
+		*tokens = codeline.lexedtokens;
+		tokens->update();
+		*curtoken = 0;
+		lastDirective = codeline.lexeddirective;
+		resultFlag = (ResultFlag)codeline.lexedflag;
+		return true;
+	}
+
+	/** Tells if a source line may change the conditionnal mode or give a warning when split. The tokens are made of
+	 consecutive source characters, so a line can only hold IF, IFDEF, IFNDEF, IFREQUIRED, ENDIF, ELSE, COND or ENDC
+	 if it contains "IF", "ELSE", "COND" or "ENDC" in any case. The warning for a '.' or '#' within a word can only
+	 happen if the character follows another one than a space or a tabulation. Comments and strings are not
+	 recognized, so they can only make the line to be split for nothing.
+	 */
+	bool Parser::MaySplitConditional(const std::string& source)
+	{
+		// last three characters in upper case, spaces before the line start
+		char c1 = ' ', c2 = ' ', c3 = ' ';
+		for (char c : source) {
+			char upper = upperchar(c);
+			if ((upper == 'F') && (c1 == 'I')) return true;
+			if ((upper == 'E') && (c3 == 'E') && (c2 == 'L') && (c1 == 'S')) return true;
+			if ((upper == 'D') && (c3 == 'C') && (c2 == 'O') && (c1 == 'N')) return true;
+			if ((upper == 'C') && (c3 == 'E') && (c2 == 'N') && (c1 == 'D')) return true;
+			if (((c == '.') || (c == '#')) && (c1 != ' ') && (c1 != '\t')) return true;
+			c3 = c2;
+			c2 = c1;
+			c1 = upper;
+		}
+		return false;
 	}
 
 	/** Execute the last directive and returns its result: this is used by IF directives called from CodeLine.Assemble() to choose
@@ -825,7 +894,7 @@ namespace MUZ {
 	bool Parser::EvaluateBoolean(bool & result)
 	{
 		int lasttoken = -1;
-		ParseToken evaluated = evalBool->Evaluate(*tokens, (int)*curtoken, lasttoken);
+		ParseToken evaluated = evalBool->Evaluate(*tokens, (int)*curtoken, lasttoken, expressions);
 		if (evaluated.type == tokenTypeDECNUMBER) {
 			*curtoken = (size_t)lasttoken;
 			result = evaluated.asInteger() != 0;
@@ -847,10 +916,10 @@ namespace MUZ {
 	{
 		// convert tokens
 		int lasttoken = -1;
-		ParseToken evaluated = evalString->Evaluate(*tokens, (int)*curtoken, lasttoken);
+		ParseToken evaluated = evalString->Evaluate(*tokens, (int)*curtoken, lasttoken, expressions);
 		if ((evaluated.type == tokenTypeSTRING) || (evaluated.type == tokenTypeDECNUMBER) || (evaluated.type == tokenTypeLETTERS)) {
 			*curtoken = (size_t)lasttoken;
-			result = evaluated.source;
+			result = evaluated.asString();
 			return true;
 		}
 		if (evaluated.type == tokenTypeBOOL) {
@@ -868,7 +937,7 @@ namespace MUZ {
 	{
 		int lasttoken = -1;
 		ParseToken evaluated;
-		evaluated = evalNumber->Evaluate(*tokens, (int)*curtoken, lasttoken);
+		evaluated = evalNumber->Evaluate(*tokens, (int)*curtoken, lasttoken, expressions);
 		if ((evaluated.type == tokenTypeSTRING) || (evaluated.type == tokenTypeDECNUMBER)) {
 			*curtoken = (size_t)lasttoken;
 			// special case with one character: return character code
@@ -892,7 +961,7 @@ namespace MUZ {
 	{
 		int lasttoken = -1;
 		ParseToken evaluated;
-		evaluated = evalNumber->Evaluate(*tokens, (int)*curtoken, lasttoken);
+		evaluated = evalNumber->Evaluate(*tokens, (int)*curtoken, lasttoken, expressions);
 		if ((evaluated.type == tokenTypeSTRING) || (evaluated.type == tokenTypeDECNUMBER)) {
 			*curtoken = (size_t)lasttoken;
 			// special case with one character: return character code
@@ -43,7 +43,8 @@ namespace MUZ {
 	} ;
 
 	
-	/** Structure for the code line parser.  It works on one line at a time. */
+	/** Structure for the code line parser.  It works on one line at a time. The Assembler keeps its parsers and reuses
+	 them for all the lines, so the evaluators and working buffers are only allocated once. */
 	class Parser {
 		
 		// parsing status variables for current code line
@@ -58,6 +59,8 @@ namespace MUZ {
 		std::string word;								/// cumulated characters for current token string
 		TokenType type = tokenTypeUNKNOWN;				/// current token type
 		bool doubleQuoted = false;						/// true while parsing a string between double quotes, also works for filenames
+		bool background = false;						/// true for a parser splitting lines on a worker thread
+		bool warned = false;							/// true if the split met a warning while working in background
 		
 		// shortcuts to usefull objects
 		class Directive* lastDirective = nullptr;		/// Direct directive access for conditionnal and including directives
@@ -70,6 +73,8 @@ namespace MUZ {
 
 		/** Points to the parsing result. Each parsed token will be pushed in this result. */
 		ExpVector* tokens = nullptr;
+		/** Points to the compiled expressions for the tokens. */
+		ExpressionCache* expressions = nullptr;
 		/** Points to the current token variable from caller. */
 		size_t* curtoken = nullptr;
 		/** Points to the original source string. */
@@ -110,7 +115,10 @@ namespace MUZ {
 	
 	public:
 		
-		Parser(class Assembler& assembler);
+		/** Creates a parser for an assembler. A background parser splits lines on a worker thread: it doesn't intern
+		 the LETTERS symbols and doesn't store warnings, the lines which would give a warning are left unsplit so the
+		 assembler splits them again. */
+		Parser(class Assembler& assembler, bool background = false);
 		~Parser();
 		
 		/** Test particular results (directives). */
@@ -187,6 +195,17 @@ namespace MUZ {
 		 */
 		void Split(CodeLine& codeline, ErrorList& msg);
 		
+		/** Restores the tokens kept by a previous Split() of the same code line instead of parsing the source again.
+		 Returns false if the line has never been split, in which case Split() must be called.
+		 */
+		bool Restore(CodeLine& codeline);
+		
+		/** Tells if a source line may change the conditionnal mode or give a warning when split. This only looks for
+		 the letters of the conditionnal directive names and for misplaced '.' or '#', so the lines of an inactive
+		 conditionnal block which return false can be skipped without being split.
+		 */
+		static bool MaySplitConditional(const std::string& source);
+		
 		/** Execute the last directive and returns its result: this is used by IF directives called from CodeLine.Assemble() to choose
 		 the parsing mode. */
 		ErrorType LastDirective(CodeLine& codeline, ErrorList& msg);
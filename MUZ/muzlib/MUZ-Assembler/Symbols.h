@@ -0,0 +1,142 @@
+//
+//  Symbols.h
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+
+#ifndef Symbols_h
+#define Symbols_h
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "MUZ-Common/Types.h"
+
+namespace MUZ {
+
+	/** Identifier for an interned symbol name. 0 is never given to a name and means "no symbol". */
+	typedef DWORD SYMBOLID;
+
+	/** Interning table for the identifiers met in sources. Each name gets its id once when the parser stores its token,
+	 and the symbol tables are then indexed by this id instead of hashing the name again at each lookup. */
+	class SymbolNames
+	{
+		std::unordered_map<std::string, SYMBOLID> ids;
+		std::vector<std::string> names;
+	public:
+		SymbolNames() {
+			Clear();
+		}
+
+		/** Returns the id for a name, giving it a new id if it is not known yet. */
+		SYMBOLID Intern(const std::string& name) {
+			if (name.empty()) return 0;
+			auto found = ids.find(name);
+			if (found != ids.end()) return found->second;
+			SYMBOLID id = (SYMBOLID)names.size();
+			names.push_back(name);
+			ids[name] = id;
+			return id;
+		}
+
+		/** Returns the id for a known name, or 0 if the name has never been interned. */
+		SYMBOLID Find(const std::string& name) const {
+			auto found = ids.find(name);
+			return (found != ids.end()) ? found->second : 0;
+		}
+
+		/** Returns the name for an id, empty string for unknown ids. */
+		const std::string& Name(SYMBOLID id) const {
+			return (id < names.size()) ? names[id] : names[0];
+		}
+
+		/** Forgets all names. */
+		void Clear() {
+			ids.clear();
+			names.clear();
+			names.push_back("");
+		}
+	};
+
+	/** Flat table of symbol objects indexed by symbol id. Missing symbols are null pointers. The table does not
+	 own the objects. */
+	template <class T> class SymbolTable
+	{
+		std::vector<T*> items;
+		size_t count = 0;
+	public:
+		/** Returns the object for an id, nullptr if there is none. */
+		T* Get(SYMBOLID id) const {
+			return (id < items.size()) ? items[id] : nullptr;
+		}
+
+		/** Stores an object for an id, replacing the previous one. */
+		void Set(SYMBOLID id, T* item) {
+			if (id >= items.size()) items.resize((size_t)id + 1, nullptr);
+			if (items[id] == nullptr && item != nullptr) count += 1;
+			if (items[id] != nullptr && item == nullptr) count -= 1;
+			items[id] = item;
+		}
+
+		/** Removes and returns the object for an id. */
+		T* Remove(SYMBOLID id) {
+			T* item = Get(id);
+			if (item) Set(id, nullptr);
+			return item;
+		}
+
+		/** Number of stored objects. */
+		size_t size() const {
+			return count;
+		}
+
+		/** Upper bound for the ids of stored objects, for loops over the table. */
+		SYMBOLID end() const {
+			return (SYMBOLID)items.size();
+		}
+
+		/** Removes all objects. */
+		void Clear() {
+			items.clear();
+			count = 0;
+		}
+	};
+
+	/** Sub-table for the local '@' labels following a global label in a source file. A scope holds a few labels so
+	 it is searched linearly. */
+	template <class T> class SymbolScope
+	{
+		std::vector<std::pair<SYMBOLID, T*>> items;
+	public:
+		/** Returns the object for an id, nullptr if there is none. */
+		T* Get(SYMBOLID id) const {
+			for (auto & item : items) {
+				if (item.first == id) return item.second;
+			}
+			return nullptr;
+		}
+
+		/** Stores an object for an id, replacing the previous one. */
+		void Set(SYMBOLID id, T* item) {
+			for (auto & existing : items) {
+				if (existing.first == id) {
+					existing.second = item;
+					return;
+				}
+			}
+			items.push_back(std::make_pair(id, item));
+		}
+
+		/** Deletes all the objects, which are owned by the scope owner. */
+		void DeleteAll() {
+			for (auto & item : items) {
+				delete item.second;
+			}
+			items.clear();
+		}
+	};
+
+} // namespace MUZ
+
+#endif /* Symbols_h */
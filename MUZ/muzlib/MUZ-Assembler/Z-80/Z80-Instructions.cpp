@@ -14,7 +14,179 @@
 namespace MUZ {
 namespace Z80 {
 
-	OperandTools & optools = *new OperandTools;
+	// one instance per thread because the evaluators keep working buffers, assemblers can run in parallel threads
+	thread_local OperandTools & optools = *new OperandTools;
+
+	//MARK: - Z-80 processor
+
+	/** Z-80 timings, with undocumented instructions. */
+	const Processor cpuZ80 = {
+		true,
+		// unprefixed opcodes
+		{
+			/* 00 */ {4,4}, {10,10}, {7,7}, {6,6}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {11,11}, {7,7}, {6,6}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 10 */ {8,13}, {10,10}, {7,7}, {6,6}, {4,4}, {4,4}, {7,7}, {4,4}, {12,12}, {11,11}, {7,7}, {6,6}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 20 */ {7,12}, {10,10}, {16,16}, {6,6}, {4,4}, {4,4}, {7,7}, {4,4}, {7,12}, {11,11}, {16,16}, {6,6}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 30 */ {7,12}, {10,10}, {13,13}, {6,6}, {11,11}, {11,11}, {10,10}, {4,4}, {7,12}, {11,11}, {13,13}, {6,6}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 40 */ {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 50 */ {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 60 */ {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 70 */ {7,7}, {7,7}, {7,7}, {7,7}, {7,7}, {7,7}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 80 */ {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* 90 */ {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* A0 */ {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* B0 */ {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {4,4}, {7,7}, {4,4},
+			/* C0 */ {5,11}, {10,10}, {10,10}, {10,10}, {10,17}, {11,11}, {7,7}, {11,11}, {5,11}, {10,10}, {10,10}, {0,0}, {10,17}, {17,17}, {7,7}, {11,11},
+			/* D0 */ {5,11}, {10,10}, {10,10}, {11,11}, {10,17}, {11,11}, {7,7}, {11,11}, {5,11}, {4,4}, {10,10}, {11,11}, {10,17}, {0,0}, {7,7}, {11,11},
+			/* E0 */ {5,11}, {10,10}, {10,10}, {19,19}, {10,17}, {11,11}, {7,7}, {11,11}, {5,11}, {4,4}, {10,10}, {4,4}, {10,17}, {0,0}, {7,7}, {11,11},
+			/* F0 */ {5,11}, {10,10}, {10,10}, {4,4}, {10,17}, {11,11}, {7,7}, {11,11}, {5,11}, {6,6}, {10,10}, {4,4}, {10,17}, {0,0}, {7,7}, {11,11},
+		},
+		// CB prefix
+		{
+			/* 00 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* 10 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* 20 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* 30 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* 40 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8},
+			/* 50 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8},
+			/* 60 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8},
+			/* 70 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {12,12}, {8,8},
+			/* 80 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* 90 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* A0 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* B0 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {15,15}, {8,8},
+			/* C0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* D0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* E0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* F0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+		},
+		// ED prefix
+		{
+			/* 00 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 10 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 20 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 30 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 40 */ {12,12}, {12,12}, {15,15}, {20,20}, {8,8}, {14,14}, {8,8}, {9,9}, {12,12}, {12,12}, {15,15}, {20,20}, {0,0}, {14,14}, {0,0}, {0,0},
+			/* 50 */ {12,12}, {12,12}, {15,15}, {20,20}, {0,0}, {0,0}, {8,8}, {9,9}, {12,12}, {12,12}, {15,15}, {20,20}, {0,0}, {0,0}, {8,8}, {9,9},
+			/* 60 */ {12,12}, {12,12}, {15,15}, {0,0}, {0,0}, {0,0}, {0,0}, {18,18}, {12,12}, {12,12}, {15,15}, {0,0}, {0,0}, {0,0}, {0,0}, {18,18},
+			/* 70 */ {12,12}, {12,12}, {15,15}, {20,20}, {0,0}, {0,0}, {0,0}, {0,0}, {12,12}, {12,12}, {15,15}, {20,20}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 80 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 90 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* A0 */ {16,16}, {16,16}, {16,16}, {16,16}, {0,0}, {0,0}, {0,0}, {0,0}, {16,16}, {16,16}, {16,16}, {16,16}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* B0 */ {16,21}, {16,21}, {21,21}, {16,21}, {0,0}, {0,0}, {0,0}, {0,0}, {16,21}, {16,21}, {16,21}, {16,21}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* C0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* D0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* E0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* F0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+		},
+		// DD and FD prefixes
+		{
+			/* 00 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {15,15}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 10 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {15,15}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 20 */ {0,0}, {14,14}, {20,20}, {10,10}, {8,8}, {8,8}, {11,11}, {0,0}, {0,0}, {15,15}, {20,20}, {10,10}, {8,8}, {8,8}, {11,11}, {0,0},
+			/* 30 */ {0,0}, {0,0}, {0,0}, {0,0}, {23,23}, {23,23}, {10,10}, {0,0}, {0,0}, {15,15}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* 40 */ {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0},
+			/* 50 */ {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0},
+			/* 60 */ {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {19,19}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {8,8}, {19,19}, {8,8},
+			/* 70 */ {7,7}, {7,7}, {7,7}, {7,7}, {7,7}, {7,7}, {0,0}, {7,7}, {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0},
+			/* 80 */ {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0},
+			/* 90 */ {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0},
+			/* A0 */ {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0},
+			/* B0 */ {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {8,8}, {8,8}, {19,19}, {0,0},
+			/* C0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* D0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* E0 */ {0,0}, {14,14}, {0,0}, {23,23}, {0,0}, {15,15}, {0,0}, {0,0}, {0,0}, {8,8}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+			/* F0 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {10,10}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0},
+		},
+		// DD CB and FD CB prefixes, opcode following the displacement
+		{
+			/* 00 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* 10 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* 20 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* 30 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* 40 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {23,23}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {0,0},
+			/* 50 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {0,0},
+			/* 60 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {0,0},
+			/* 70 */ {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {0,0}, {20,20}, {0,0},
+			/* 80 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* 90 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* A0 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* B0 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* C0 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* D0 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* E0 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+			/* F0 */ {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23}, {23,23},
+		},
+	};
+
+	/** Finds the T-states table entry for the opcode stored in a code line. */
+	void Processor::SetStates(CodeLine& codeline) const
+	{
+		const std::vector<BYTE>& code = codeline.code;
+		const OpcodeStates* states = nullptr;
+		if (code.empty()) return;
+		if (code[0] == 0xCB) {
+			if (code.size() > 1) states = &cb[code[1]];
+		} else if (code[0] == 0xED) {
+			if (code.size() > 1) states = &ed[code[1]];
+		} else if (code[0] == 0xDD || code[0] == 0xFD) {
+			if (code.size() > 3 && code[1] == 0xCB) states = &xycb[code[3]];
+			else if (code.size() > 1) states = &xy[code[1]];
+		} else {
+			states = &main[code[0]];
+		}
+		if (states) codeline.SetStates(states->min, states->max);
+	}
+
+	/** Encodes the instruction, then sets the timings from the processor tables. */
+	bool InstructionZ80::Assemble(CodeLine& codeline, ErrorList& msg)
+	{
+		bool result = Encode(codeline, msg);
+		cpu.SetStates(codeline);
+		return result;
+	}
+
+	/** Encodes a JP or JR jump in the .RELAX mode. The pass 1 assembles the form chosen by the previous assembly,
+	 or the written form the first time. The pass 2 keeps the same size so the addresses stay valid, and chooses
+	 the form of the next assembly: a JP which can reach its target becomes a JR, and a JR which cannot reach it
+	 becomes a JP for good.
+	 */
+	bool InstructionZ80::EncodeRelaxed(CodeLine& codeline, BYTE shortcode, BYTE longcode, int target, bool writtenshort)
+	{
+		Assembler& as = *codeline.as;
+		RelaxedJump& jump = codeline.jump;
+		if (!as.IsRelaxing()) {
+			jump = RelaxedJump();
+			return false;
+		}
+		int offset = target - ((int)as.GetAddress() + 2);
+		if (as.IsFirstPass() || jump.form == jumpformWRITTEN) {
+			codeline.fixup = true; // the pass 2 checks if the target can be reached
+			if (jump.next == jumpformWRITTEN) jump.next = writtenshort ? jumpformSHORT : jumpformLONG;
+			jump.form = jump.next;
+		} else {
+			bool reach = (offset >= -128) && (offset <= 127);
+			if (jump.form == jumpformSHORT && !reach) as.RelaxJump(codeline, jumpformPINNED);
+			if (jump.form == jumpformLONG && reach) as.RelaxJump(codeline, jumpformSHORT);
+		}
+		BYTE opcode;
+		if (jump.form == jumpformSHORT) {
+			opcode = shortcode;
+			codeline.AddCode(opcode, offset);
+		} else {
+			opcode = longcode;
+			codeline.AddCode(opcode, (target & 0xFF), (target >> 8));
+		}
+		
+		// savings against the written form
+		BYTE writtencode = writtenshort ? shortcode : longcode;
+		jump.bytes = (writtenshort ? 2 : 3) - (int)codeline.code.size();
+		jump.statesmin = cpu.main[writtencode].min - cpu.main[opcode].min;
+		jump.statesmax = cpu.main[writtencode].max - cpu.main[opcode].max;
+		return true;
+	}
+
+	//MARK: - Z-80 instructions
 
 	/** Assemble instruction at current token, returns false if error.
 	 tok index 0   1   2   3
@@ -25,7 +197,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionADC::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionADC::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest, src;
 		int d;
@@ -37,41 +209,37 @@ namespace Z80 {
 			if (!GetComma(codeline)) {
 				// ADC A
 				codeline.AddCode(0x88 + optools.GetSubCode(regA));
-				codeline.SetStates(4);
 				return true;
 			}
 			// ADC A,r
 			operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 			if (operr == operrOK) {
 				codeline.AddCode(0x88 + optools.GetSubCode(src));
-				codeline.SetStates(4);
 				return true;
 			}
-			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-			if (operr == operrOK) {
-				codeline.AddCode(optools.GetPrefix(src), 0x88 + optools.GetSubCode(src));
-				codeline.SetStates(8);
-				return true;
+			if (cpu.undocumented) {
+				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+				if (operr == operrOK) {
+					codeline.AddCode(optools.GetPrefix(src), 0x88 + optools.GetSubCode(src));
+					return true;
+				}
 			}
 			// ADC  A,(HL)
 			operr = optools.GetIndHL(codeline);
 			if (operr == operrOK) {
 				codeline.AddCode(0x8E);
-				codeline.SetStates(7);
 				return true;
 			}
 			// ADC A,(X+d)
 			operr = optools.GetIndX(codeline, src, d);
 			if (operr == operrOK) {
 				codeline.AddCode(optools.GetPrefix(src), 0x8E, d);
-				codeline.SetStates(19);
 				return true;
 			}
 			// ADC A,n
 			operr = optools.GetNum8(codeline, d);
 			if (operr == operrOK) {
 				codeline.AddCode(0xCE, d);
-				codeline.SetStates(7);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);
@@ -84,7 +252,6 @@ namespace Z80 {
 			operr = optools.GetReg16(codeline, src,REGFLAGS::BCDESP | REGFLAGS::HL);
 			if (operr == operrOK) {
 				codeline.AddCode(0xED, 0x4A + optools.GetSubCode(src));
-				codeline.SetStates(15);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);
@@ -96,21 +263,20 @@ namespace Z80 {
 		if (operr == operrOK) {
 			if (GetComma(codeline)) return msg.Error(errorWrongComma, codeline);
 			codeline.AddCode(0x88 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0x88 + optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0x88 + optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// ADC  (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			if (GetComma(codeline)) return msg.Error(errorWrongComma, codeline);
 			codeline.AddCode(0x8E);
-			codeline.SetStates(7);
 			return true;
 		}
 		// ADC (X+d)
@@ -118,7 +284,6 @@ namespace Z80 {
 		if (operr == operrOK) {
 			if (GetComma(codeline)) return msg.Error(errorWrongComma, codeline);
 			codeline.AddCode(optools.GetPrefix(src), 0x8E, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// ADC n
@@ -126,7 +291,6 @@ namespace Z80 {
 		if (operr == operrOK) {
 			if (GetComma(codeline)) return msg.Error(errorWrongComma, codeline);
 			codeline.AddCode(0xCE, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -145,7 +309,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionADD::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionADD::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest, src;
 		int d;
@@ -157,42 +321,38 @@ namespace Z80 {
 			if (!GetComma(codeline)) {
 				// ADD A
 				codeline.AddCode(0x87);
-				codeline.SetStates(4);
 				return true;
 			}
 			// ADD A,r
 			operr = optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL);
 			if (operr == operrOK) {
 				codeline.AddCode(0x80 + optools.GetSubCode(src));
-				codeline.SetStates(4);
 				return true;
 			}
 			// ADD r,undoc
-			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-			if (operr == operrOK) {
-				codeline.AddCode(optools.GetPrefix(src), 0x80 + optools.GetSubCode(src));
-				codeline.SetStates(8);
-				return true;
+			if (cpu.undocumented) {
+				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+				if (operr == operrOK) {
+					codeline.AddCode(optools.GetPrefix(src), 0x80 + optools.GetSubCode(src));
+					return true;
+				}
 			}
 			// ADD A,(HL)
 			operr = optools.GetIndHL(codeline);
 			if (operr == operrOK) {
 				codeline.AddCode(0x86);
-				codeline.SetStates(7);
 				return true;
 			}
 			// ADD A,(X+d)
 			operr = optools.GetIndX(codeline, src, d);
 			if (operr == operrOK) {
 				codeline.AddCode(optools.GetPrefix(src), 0x86, d);
-				codeline.SetStates(19);
 				return true;
 			}
 			// ADD A,n
 			operr = optools.GetNum8(codeline, d);
 			if (operr == operrOK) {
 				codeline.AddCode(0xC6, d);
-				codeline.SetStates(7);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);;
@@ -206,7 +366,6 @@ namespace Z80 {
 			// ADD IY, BC DE IY SP
 			operr = optools.GetReg16(codeline, src,REGFLAGS::BCDESP | REGFLAGS::HLXY);
 			if (operr == operrOK) {
-				int cycles = 11;
 				// HL/IX/IY as source: only accept HL,HL - IX,IX - IY,IY
 				if (optools.RegAccept(REGFLAGS::HLXY, src)) {
 					if (src != dest) {
@@ -217,11 +376,9 @@ namespace Z80 {
 				// indexed prefix?
 				if ( optools.RegAccept(REGFLAGS::XY, dest)) {
 					codeline.AddCode(optools.GetPrefix(dest));
-					cycles = 15;
 				}
 				// ADD HL opcode
 				codeline.AddCode(0x09 + optools.GetSubCode(src));
-				codeline.SetStates(cycles);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);
@@ -235,35 +392,32 @@ namespace Z80 {
 		operr = optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0x80 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
 		// ADD undoc
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0x80 + optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0x80 + optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// ADD (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0x86);
-			codeline.SetStates(7);
 			return true;
 		}
 		// ADD (X+d)
 		operr = optools.GetIndX(codeline, src, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(src), 0x86, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// ADD n
 		operr = optools.GetNum8(codeline, d);
 		if (operr == operrOK) {
 			codeline.AddCode(0xC6, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -276,7 +430,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionAND::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionAND::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src;
 		int d;
@@ -289,34 +443,31 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0xA0 + optools.GetSubCode(src));
-					codeline.SetStates(4);
 					return true;
 				}
-				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(src), 0xA0 + optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
+				if (cpu.undocumented) {
+					operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(src), 0xA0 + optools.GetSubCode(src));
+						return true;
+					}
 				}
 				// AND A,(HL)
 				operr = optools.GetIndHL(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0xA6);
-					codeline.SetStates(7);
 					return true;
 				}
 				// AND A,(X+d)
 				operr = optools.GetIndX(codeline, src, d);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(src), 0xA6, d);
-					codeline.SetStates(19);
 					return true;
 				}
 				// AND A,n
 				operr = optools.GetNum8(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0xE6, d);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -328,34 +479,31 @@ namespace Z80 {
 		operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xA0 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0xA0 + optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0xA0 + optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// AND (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xA6);
-			codeline.SetStates(7);
 			return true;
 		}
 		// AND (X+d)
 		operr = optools.GetIndX(codeline, src, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(src), 0xA6, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// AND n
 		operr = optools.GetNum8(codeline, d);
 		if (operr == operrOK) {
 			codeline.AddCode(0xE6, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -368,7 +516,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionBIT::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionBIT::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		int d=0;
 		OperandType src, bit;
@@ -380,12 +528,11 @@ namespace Z80 {
 		if (!GetComma(codeline)) return msg.Error(errorMissingComma, codeline);
 		operr = optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
-			codeline.SetStates(8);
+			// BIT b,r
 		} else if (operrOK == optools.GetIndHL(codeline)) {
-			codeline.SetStates(12);
 			src = indHL;
 		} else if (operrOK == optools.GetIndX(codeline, src, d)) {
-			codeline.SetStates(20);
+			// BIT b,(X+d)
 		} else {
 			return msg.Error(errorWrongOperand2, codeline);
 		}
@@ -411,7 +558,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCALL::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionCALL::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType cond;
 		int addr;
@@ -421,7 +568,6 @@ namespace Z80 {
 				operr = optools.GetNum16(codeline, addr);
 				if (operr == operrOK) {
 					codeline.AddCode(0xC4 + optools.GetSubCode(cond), (addr & 0xFF), (addr >> 8));
-					codeline.SetStates(10,17);
 					return true;
 				}
 				if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -432,7 +578,6 @@ namespace Z80 {
 		operr = optools.GetNum16(codeline, addr);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCD, (addr & 0xFF), (addr >> 8));
-			codeline.SetStates(17);
 			return true;
 		}
 		if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -444,10 +589,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCCF::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionCCF::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x3F);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -458,7 +602,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCP::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionCP::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src;
 		int d ;
@@ -467,7 +611,6 @@ namespace Z80 {
 			if (!GetComma(codeline)) {
 				// CP A
 				codeline.AddCode(0xB8 + optools.GetSubCode(src));
-				codeline.SetStates(4);
 				return true;
 			}
 
@@ -475,34 +618,31 @@ namespace Z80 {
 			operr = optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL);
 			if (operr == operrOK) {
 				codeline.AddCode(0xB8 + optools.GetSubCode(src));
-				codeline.SetStates(4);
 				return true;
 			}
-			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-			if (operr == operrOK) {
-				codeline.AddCode(optools.GetPrefix(src), 0xB8 + optools.GetSubCode(src));
-				codeline.SetStates(8);
-				return true;
+			if (cpu.undocumented) {
+				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+				if (operr == operrOK) {
+					codeline.AddCode(optools.GetPrefix(src), 0xB8 + optools.GetSubCode(src));
+					return true;
+				}
 			}
 			// CP A,(HL)
 			operr = optools.GetIndHL(codeline);
 			if (operr == operrOK) {
 				codeline.AddCode(0xBE);
-				codeline.SetStates(7);
 				return true;
 			}
 			// CP A,(X+d)
 			operr = optools.GetIndX(codeline, src, d);
 			if (operr == operrOK) {
 				codeline.AddCode(optools.GetPrefix(src), 0xBE, d);
-				codeline.SetStates(19);
 				return true;
 			}
 			// CP A,n
 			operr = optools.GetNum8(codeline, d);
 			if (operr == operrOK) {
 				codeline.AddCode(0xFE, d);
-				codeline.SetStates(7);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);
@@ -511,34 +651,31 @@ namespace Z80 {
 		operr = optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xB8 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0xB8 + optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0xB8 + optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// CP (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xBE);
-			codeline.SetStates(7);
 			return true;
 		}
 		// CP (X+d)
 		operr = optools.GetIndX(codeline, src, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(src), 0xBE, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// CP n
 		operr = optools.GetNum8(codeline, d);
 		if (operr == operrOK) {
 			codeline.AddCode(0xFE, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -548,10 +685,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCPD::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionCPD::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xA9);
-		codeline.SetStates(16);
 		return true;
 	}
 
@@ -559,10 +695,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCPDR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionCPDR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xB9);
-		codeline.SetStates(16,21);
 		return true;
 	}
 
@@ -570,10 +705,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCPI::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionCPI::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xA1);
-		codeline.SetStates(16);
 		return true;
 	}
 
@@ -581,10 +715,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCPIR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionCPIR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xB1);
-		codeline.SetStates(16,21); // 5 if repeat, 4 when finished
 		return true;
 	}
 
@@ -592,10 +725,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionCPL::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionCPL::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x2F);
-		codeline.SetStates(4); // 5 if repeat, 4 when finished
 		return true;
 	}
 
@@ -603,10 +735,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionDAA::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionDAA::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x27);
-		codeline.SetStates(4); // 5 if repeat, 4 when finished
 		return true;
 	}
 
@@ -630,7 +761,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionDEC::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionDEC::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest;
 		int d;
@@ -638,15 +769,15 @@ namespace Z80 {
 		OperandError operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0x05 + 8 * optools.GetSubCode(dest));
-			codeline.SetStates(4);
 			return true;
 		}
 		// DEC undoc
-		operr = optools.GetReg8(codeline, dest, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(dest), 0x05 + 8 * optools.GetSubCode(dest));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, dest, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(dest), 0x05 + 8 * optools.GetSubCode(dest));
+				return true;
+			}
 		}
 		// DEC rp
 		operr = optools.GetReg16(codeline, dest);
@@ -654,13 +785,11 @@ namespace Z80 {
 			// DEC BC DE HL SP
 			if (optools.RegAccept(REGFLAGS::BCDEHLSP, dest)) {
 				codeline.AddCode(0x0B + optools.GetSubCode(dest));
-				codeline.SetStates(6);
 				return true;
 			}
 			// DEC IX IY
 			if (optools.RegAccept(REGFLAGS::XY, dest)) {
 				codeline.AddCode(optools.GetPrefix(dest), 0x0B + optools.GetSubCode(regHL));
-				codeline.SetStates(10);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);
@@ -669,14 +798,12 @@ namespace Z80 {
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0x35);
-			codeline.SetStates(11);
 			return true;
 		}
 		// DEC (X+d)
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(dest), 0x35, d);
-			codeline.SetStates(23);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -686,10 +813,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionDI::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionDI::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xF3);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -697,7 +823,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionDJNZ::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionDJNZ::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		int d;
 		OperandError operr = optools.GetNum16(codeline, d);
@@ -708,7 +834,6 @@ namespace Z80 {
 			}
 			depl = 0x100 - depl;
 			codeline.AddCode(0x10, depl);
-			codeline.SetStates(8,13);
 			return true;
 		}
 		if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -719,10 +844,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionEI::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionEI::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xFB);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -736,7 +860,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionEX::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionEX::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest, src;
 		OperandError operr = optools.GetReg16(codeline, dest,REGFLAGS::AF | REGFLAGS::DE);
@@ -746,12 +870,10 @@ namespace Z80 {
 				if (operr == operrOK) {
 					if (src == regAFp && dest == regAF) {
 						codeline.AddCode(0x08);
-						codeline.SetStates(4);
 						return true;
 					}
 					if (src == regHL && dest == regDE) {
 						codeline.AddCode(0xEB);
-						codeline.SetStates(4);
 						return true;
 					}
 					// wrong syntax,  EX AF,HL or EX DE,AF'
@@ -768,12 +890,10 @@ namespace Z80 {
 				if (operr == operrOK) {
 					if (src == regHL) {
 						codeline.AddCode(0xE3);
-						codeline.SetStates(19);
 						return true;
 					}
 					// EX (SP),IX/IY
 					codeline.AddCode(optools.GetPrefix(src), 0xE3);
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -787,10 +907,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionEXX::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionEXX::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xD9);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -798,10 +917,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionHALT::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionHALT::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x76);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -813,7 +931,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionIM::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionIM::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		int m;
 		OperandError operr = optools.GetNum8(codeline, m);
@@ -821,7 +939,6 @@ namespace Z80 {
 			if (m >= 0 && m <= 2) {
 				const int code[3] = { 0x46, 0x56, 0x5E };
 				codeline.AddCode(0xED, code[m]);
-				codeline.SetStates(8);
 				return true;
 			}
 			return msg.Error(errorTooBigValue, codeline, 2);
@@ -836,7 +953,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionIN::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionIN::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest;
 		int n;
@@ -848,16 +965,14 @@ namespace Z80 {
 				operr = optools.GetIndC(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0xED, 0x40 + optools.GetSubCode(dest) * 8);
-					codeline.SetStates(12);
 					return true;
 				}
 				// IN A,(num8)
 				if (dest == regA && optools.GetInd16(codeline, n) == operrOK) {
 					if (n > 255) {
-						if (! codeline.as->IsFirstPass()) msg.ForceWarning(warningTooBig8, codeline);
+						msg.Warning(warningTooBig8, codeline, 2);
 					}
 					codeline.AddCode(0xDB, n);
-					codeline.SetStates(11);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -868,7 +983,6 @@ namespace Z80 {
 		operr = optools.GetIndC(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xED, 0x40 + optools.GetSubCode(regA) * 8);
-			codeline.SetStates(12);
 			return true;
 		}
 		// IN (num8)
@@ -878,7 +992,6 @@ namespace Z80 {
 				msg.Warning(warningTooBig8, codeline); // pass 1 only
 			}
 			codeline.AddCode(0xDB, n);
-			codeline.SetStates(11);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -904,7 +1017,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionINC::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionINC::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest;
 		int d;
@@ -912,40 +1025,36 @@ namespace Z80 {
 		OperandError operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0x04 + 8 * optools.GetSubCode(dest));
-			codeline.SetStates(4);
 			return true;
 		}
 		// INC undoc
-		operr = optools.GetReg8(codeline, dest, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(dest), 0x04 + 8 * optools.GetSubCode(dest));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, dest, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(dest), 0x04 + 8 * optools.GetSubCode(dest));
+				return true;
+			}
 		}
 		// INC rp
 		operr = optools.GetReg16(codeline, dest,REGFLAGS::BCDEHLSP | REGFLAGS::XY);
 		if (operr == operrOK) {
 			if (optools.RegAccept(REGFLAGS::XY, dest)) {
 				codeline.AddCode(optools.GetPrefix(dest), 0x03 + optools.GetSubCode(regHL));
-				codeline.SetStates(10);
 				return true;
 			}
 			codeline.AddCode(0x03 + optools.GetSubCode(dest));
-			codeline.SetStates(6);
 			return true;
 		}
 		// INC (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0x34);
-			codeline.SetStates(11);
 			return true;
 		}
 		// INC (X+d)
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(dest), 0x34, d);
-			codeline.SetStates(23);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -955,10 +1064,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionIND::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionIND::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xAA);
-		codeline.SetStates(16);
 		return true;
 	}
 
@@ -966,10 +1074,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionINDR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionINDR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xBA);
-		codeline.SetStates(16,21); // 5 when repeat, 4 when finished
 		return true;
 	}
 
@@ -977,10 +1084,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionINI::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionINI::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xA2);
-		codeline.SetStates(16); // 5 when repeat, 4 when finished
 		return true;
 	}
 
@@ -988,10 +1094,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionINIR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionINIR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xB2);
-		codeline.SetStates(21); // 5 when repeat, 4 when finished
 		return true;
 	}
 
@@ -1004,10 +1109,12 @@ namespace Z80 {
 
 	 condNZ, condZ, condNC, condC, condPO, condPE, condP, condM,
 	 c2      ca     d2      da     e2      ea      f2     fa
+
+	 In the .RELAX mode, JP num16 and JP NZ/Z/NC/C,num16 are assembled as JR when they can reach the target.
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionJP::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionJP::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType cond, reg;
 		int addr;
@@ -1017,8 +1124,11 @@ namespace Z80 {
 			if (GetComma(codeline)) {
 				operr = optools.GetNum16(codeline, addr);
 				if (operr == operrOK) {
+					// only NZ, Z, NC and C have a JR form
+					if (cond == condZ || cond == condNZ || cond == condC || cond == condNC) {
+						if (EncodeRelaxed(codeline, 0x20 + optools.GetSubCode(cond), 0xC2 + optools.GetSubCode(cond), addr, false)) return true;
+					}
 					codeline.AddCode(0xC2 + optools.GetSubCode(cond), (addr & 0xFF), (addr >> 8));
-					codeline.SetStates(10);
 					return true;
 				}
 				if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -1030,15 +1140,15 @@ namespace Z80 {
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xE9);
-			codeline.SetStates(4);
 			return true;
 		}
 		// JP (X+d)
-		operr = optools.GetIndX(codeline, reg, addr);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(reg), 0xE9);
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetIndX(codeline, reg, addr);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(reg), 0xE9);
+				return true;
+			}
 		}
 		// JP (IX) or (IY)
 		if (codeline.tokens[codeline.curtoken].type == tokenTypePAROPEN) {
@@ -1048,7 +1158,6 @@ namespace Z80 {
 				if (codeline.curtoken < codeline.tokens.size()) {
 					if (codeline.tokens[codeline.curtoken].type == tokenTypePARCLOSE) {
 						codeline.AddCode(optools.GetPrefix(reg), 0xE9);
-						codeline.SetStates(8);
 						return true;
 					}
 				}
@@ -1059,8 +1168,8 @@ namespace Z80 {
 		// JP nn
 		operr = optools.GetNum16(codeline, addr);
 		if (operr == operrOK) {
+			if (EncodeRelaxed(codeline, 0x18, 0xC3, addr, false)) return true;
 			codeline.AddCode(0xC3, (addr & 0xFF), (addr >> 8));
-			codeline.SetStates(10);
 			return true;
 		}
 		if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -1079,10 +1188,12 @@ namespace Z80 {
 
 	 invalid: condPO, condPE, condP, condM
 
+	 In the .RELAX mode, a JR which cannot reach the target is assembled as a JP.
+
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionJR::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionJR::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType cond;
 		int d;
@@ -1093,13 +1204,13 @@ namespace Z80 {
 				if (GetComma(codeline)) {
 					operr = optools.GetNum16(codeline, d);
 					if (operr == operrOK) {
+						if (EncodeRelaxed(codeline, 0x20 + optools.GetSubCode(cond), 0xC2 + optools.GetSubCode(cond), d, true)) return true;
 						int depl = (int)codeline.as->GetAddress() + 2 - d;
 						if ( depl < -126 || depl > +129) {
 							msg.Warning(warningTooFar, codeline, 2);
 						}
 						depl = 0x100 - depl;
 						codeline.AddCode(0x20 + optools.GetSubCode(cond), depl);
-						codeline.SetStates(7,12);
 						return true;
 					}
 					if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -1112,13 +1223,13 @@ namespace Z80 {
 		// JR nn
 		operr = optools.GetNum16(codeline, d);
 		if (operr == operrOK) {
+			if (EncodeRelaxed(codeline, 0x18, 0xC3, d, true)) return true;
 			int depl = (int)codeline.as->GetAddress() + 2 - d;
 			if (depl < -126 || depl > +129) {
 				msg.Warning(warningTooFar, codeline, 2);
 			}
 			depl = 0x100 - depl; // 2-complement
 			codeline.AddCode(0x18, depl);
-			codeline.SetStates(12);
 			return true;
 		}
 		if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -1171,7 +1282,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionLD::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionLD::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src, dest;
 		int d;
@@ -1182,7 +1293,6 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::A);
 				if (operr == operrOK) {
 					codeline.AddCode(0xED, 0x40 + optools.GetSubCode(src));
-					codeline.SetStates(9);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1197,27 +1307,22 @@ namespace Z80 {
 				// LD SP, HL IX IY
 				operr = optools.GetReg16(codeline, src, REGFLAGS::HLXY);
 				if (operr == operrOK) {
-					int cycles = 6;
 					if (src != regHL) {
 						codeline.AddCode(optools.GetPrefix(src));
-						cycles = 10;
 					}
 					codeline.AddCode(0xF9);
-					codeline.SetStates(cycles);
 					return true;
 				}
 				// LD SP,(nn)
 				operr = optools.GetInd16(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0xED, 0x7B, d & 0xFF, d >> 8);
-					codeline.SetStates(20);
 					return true;
 				}
 				// LD SP,nn
 				operr = optools.GetNum16(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0x31, d & 0xFF, d >> 8);
-					codeline.SetStates(10);
 					return true;
 				}
 				if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -1238,20 +1343,15 @@ namespace Z80 {
 					// LD IY,(nn)  FD 2A nn nn
 					if (dest == regBC) {
 						codeline.AddCode(0xED, 0x4B, d & 0xFF, d >> 8);
-						codeline.SetStates(20);
 						return true;
 					} else if (dest == regDE) {
 						codeline.AddCode(0xED, 0x5B, d & 0xFF, d >> 8);
-						codeline.SetStates(20);
 						return true;
 					}
-					int cycles  = 16;
 					if (dest != regHL) {
 						codeline.AddCode(optools.GetPrefix(dest));
-						cycles = 20;
 					}
 					codeline.AddCode(0x2A, d & 0xFF, d >> 8);
-					codeline.SetStates(cycles);
 					return true;
 				}
 				operr = optools.GetNum16(codeline, d);
@@ -1263,20 +1363,15 @@ namespace Z80 {
 					// LD IY,nn  FD 21 nn nn
 					if (dest == regBC) {
 						codeline.AddCode(0x01, d & 0xFF, d >> 8);
-						codeline.SetStates(10);
 						return true;
 					} else if (dest == regDE) {
 						codeline.AddCode(0x11, d & 0xFF, d >> 8);
-						codeline.SetStates(10);
 						return true;
 					}
-					int cycles  = 10;
 					if (dest != regHL) {
 						codeline.AddCode(optools.GetPrefix(dest));
-						cycles = 14;
 					}
 					codeline.AddCode(0x21, d & 0xFF, d >> 8);
-					codeline.SetStates(cycles);
 					return true;
 				}
 				if (operr == operrWRONGREGISTER) return msg.Error(errorWrongRegister, codeline);
@@ -1291,13 +1386,11 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0x70 + optools.GetSubCode(src));
-					codeline.SetStates(7);
 					return true;
 				}
 				operr = optools.GetNum8(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0x36, d);
-					codeline.SetStates(10);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1311,13 +1404,11 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0x70 + optools.GetSubCode(src), d);
-					codeline.SetStates(7);
 					return true;
 				}
 				operr = optools.GetNum8(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0x36, d);
-					codeline.SetStates(10);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1331,7 +1422,6 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::A);
 				if (operr == operrOK) {
 					codeline.AddCode(0x02);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1345,7 +1435,6 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::A);
 				if (operr == operrOK) {
 					codeline.AddCode(0x12);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1359,34 +1448,27 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::A);
 				if (operr == operrOK) {
 					codeline.AddCode(0x32, d & 0xFF, d >> 8);
-					codeline.SetStates(13);
 					return true;
 				}
 				operr = optools.GetReg16(codeline, src, REGFLAGS::BCDEHLSP | REGFLAGS::XY);
 				if (operr == operrOK) {
 					if (src == regBC) {
 						codeline.AddCode(0xED, 0x43, d & 0xFF, d >> 8);
-						codeline.SetStates(20);
 						return true;
 					}
 					if (src == regDE) {
 						codeline.AddCode(0xED, 0x53, d & 0xFF, d >> 8);
-						codeline.SetStates(20);
 						return true;
 					}
 					if (src == regSP) {
 						codeline.AddCode(0xED, 0x73, d & 0xFF, d >> 8);
-						codeline.SetStates(20);
 						return true;
 					}
 					// HL, IX, IY
-					int cycles = 16;
 					if (src == regIX || src == regIY) {
 						codeline.AddCode(optools.GetPrefix(src));
-						cycles = 20;
 					}
 					codeline.AddCode(0x22, d & 0xFF, d >> 8);
-					codeline.SetStates(cycles);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1401,63 +1483,56 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::I | REGFLAGS::R);
 				if (operr == operrOK) {
 					codeline.AddCode(0xED, 0x50 + optools.GetSubCode(src));
-					codeline.SetStates(9);
 					return true;
 				}
 				// LD A, r
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0x78 + optools.GetSubCode(src));
-					codeline.SetStates(4);
 					return true;
 				}
 				// LD A,undoc
-				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(src), 0x78 + optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
+				if (cpu.undocumented) {
+					operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(src), 0x78 + optools.GetSubCode(src));
+						return true;
+					}
 				}
 				// LD A,(HL)
 				operr = optools.GetIndHL(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0x7E);
-					codeline.SetStates(7);
 					return true;
 				}
 				// LD A,(BC)
 				operr = optools.GetIndBC(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0x0A);
-					codeline.SetStates(7);
 					return true;
 				}
 				// LD A,(DE)
 				operr = optools.GetIndDE(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0x1A);
-					codeline.SetStates(7);
 					return true;
 				}
 				// LD A,(X+d)
 				operr = optools.GetIndX(codeline, src, d);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(src), 0x7E, d);
-					codeline.SetStates(19);
 					return true;
 				}
 				// LD A,(nn)
 				operr = optools.GetInd16(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0x3A, d & 0xFF, d >> 8);
-					codeline.SetStates(13);
 					return true;
 				}
 				// LD A,n
 				operr = optools.GetNum8(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0x3E, d);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1472,35 +1547,32 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0x40 + 8 * optools.GetSubCode(dest) + optools.GetSubCode(src));
-					codeline.SetStates(4);
 					return true;
 				}
 				// LD r,undoc
-				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(src), 0x40 + 8 * optools.GetSubCode(dest) + optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
+				if (cpu.undocumented) {
+					operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(src), 0x40 + 8 * optools.GetSubCode(dest) + optools.GetSubCode(src));
+						return true;
+					}
 				}
 				// LD r,(HL)
 				operr = optools.GetIndHL(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0x46 + 8 * optools.GetSubCode(dest));
-					codeline.SetStates(7);
 					return true;
 				}
 				// LD r,(x+d)
 				operr = optools.GetIndX(codeline, src, d);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(src), 0x46 + 8 * optools.GetSubCode(dest), d );
-					codeline.SetStates(19);
 					return true;
 				}
 				// LD r,n
 				operr = optools.GetNum8(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0x06 + 8 * optools.GetSubCode(dest), d);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1508,33 +1580,32 @@ namespace Z80 {
 			return msg.Error(errorMissingComma, codeline);
 		}
 		// LD undoc,r n
-		operr = optools.GetReg8(codeline, dest, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			if (GetComma(codeline)) {
-				// LD undoc,r
-				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(dest), 0x40 + 8 * optools.GetSubCode(dest) + optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
-				}
-				// LD undoc,undoc
-				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(dest), 0x40 + 8 * optools.GetSubCode(dest) + optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
-				}
-				// LD undoc,n
-				operr = optools.GetNum8(codeline, d);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(dest), 0x06 + 8 * optools.GetSubCode(dest), d);
-					codeline.SetStates(11);
-					return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, dest, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				if (GetComma(codeline)) {
+					// LD undoc,r
+					operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(dest), 0x40 + 8 * optools.GetSubCode(dest) + optools.GetSubCode(src));
+						return true;
+					}
+					// LD undoc,undoc
+					operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(dest), 0x40 + 8 * optools.GetSubCode(dest) + optools.GetSubCode(src));
+						return true;
+					}
+					// LD undoc,n
+					operr = optools.GetNum8(codeline, d);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(dest), 0x06 + 8 * optools.GetSubCode(dest), d);
+						return true;
+					}
+					return msg.Error(errorWrongOperand2, codeline);
 				}
-				return msg.Error(errorWrongOperand2, codeline);
+				return msg.Error(errorMissingComma, codeline);
 			}
-			return msg.Error(errorMissingComma, codeline);
 		}
 		return msg.Error(errorWrongOperand1, codeline);
 	}
@@ -1543,10 +1614,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionLDD::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionLDD::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xA8);
-		codeline.SetStates(16);
 		return true;
 	}
 
@@ -1554,10 +1624,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionLDDR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionLDDR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xB8);
-		codeline.SetStates(16,21);
 		return true;
 	}
 
@@ -1565,10 +1634,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionLDI::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionLDI::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xA0);
-		codeline.SetStates(16);
 		return true;
 	}
 
@@ -1576,10 +1644,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionLDIR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionLDIR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xB0);
-		codeline.SetStates(16,21);
 		return true;
 	}
 
@@ -1587,10 +1654,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionNEG::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionNEG::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0x44);
-		codeline.SetStates(8);
 		return true;
 	}
 
@@ -1598,10 +1664,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionNOP::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionNOP::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x00);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -1612,7 +1677,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionOR::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionOR::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src;
 		int d;
@@ -1625,35 +1690,32 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0xB0 + optools.GetSubCode(src));
-					codeline.SetStates(4);
 					return true;
 				}
 				// OR A,undoc
-				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(src), 0xB0 + optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
+				if (cpu.undocumented) {
+					operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(src), 0xB0 + optools.GetSubCode(src));
+						return true;
+					}
 				}
 				// OR A,(HL)
 				operr = optools.GetIndHL(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0xB6);
-					codeline.SetStates(7);
 					return true;
 				}
 				// OR A,(X+d)
 				operr = optools.GetIndX(codeline, src, d);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(src), 0xB6, d);
-					codeline.SetStates(19);
 					return true;
 				}
 				// OR A,n
 				operr = optools.GetNum8(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0xF6, d);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1665,35 +1727,32 @@ namespace Z80 {
 		operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xB0 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
 		// OR undoc
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0xB0 + optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0xB0 + optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// OR (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xB6);
-			codeline.SetStates(7);
 			return true;
 		}
 		// OR (X+d)
 		operr = optools.GetIndX(codeline, src, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(src), 0xB6, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// OR n
 		operr = optools.GetNum8(codeline, d);
 		if (operr == operrOK) {
 			codeline.AddCode(0xF6, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -1703,10 +1762,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionOTDR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionOTDR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xBB);
-		codeline.SetStates(16,21);
 		return true;
 	}
 
@@ -1715,10 +1773,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionOTIR::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionOTIR::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xB3);
-		codeline.SetStates(16,21);
 		return true;
 	}
 
@@ -1729,7 +1786,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionOUT::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionOUT::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src;
 		int n;
@@ -1740,16 +1797,16 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0xED, 0x41 + optools.GetSubCode(src) * 8);
-					codeline.SetStates(12);
 					return true;
 				}
 				// OUT (C),0 (undoc)
-				operr = optools.GetNum8(codeline, n);
-				if (operr == operrOK)  {
-					if (n == 0) {
-						codeline.AddCode(0xED, 0x71);
-						codeline.SetStates(12);
-						return true;
+				if (cpu.undocumented) {
+					operr = optools.GetNum8(codeline, n);
+					if (operr == operrOK)  {
+						if (n == 0) {
+							codeline.AddCode(0xED, 0x71);
+							return true;
+						}
 					}
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1762,7 +1819,6 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src,REGFLAGS::A);
 				if (operr == operrOK) {
 					codeline.AddCode(0xD3, n);
-					codeline.SetStates(11);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -1776,10 +1832,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionOUTD::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionOUTD::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xAB);
-		codeline.SetStates(16);
 		return true;
 	}
 
@@ -1787,10 +1842,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionOUTI::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionOUTI::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0xA3);
-		codeline.SetStates(16);
 		return true;
 	}
 
@@ -1798,16 +1852,14 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionPOP::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionPOP::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest;
 		OperandError operr = optools.GetReg16(codeline, dest,REGFLAGS::AF|REGFLAGS::BC|REGFLAGS::DE|REGFLAGS::HLXY);
 		if (operr == operrOK) {
-			codeline.SetStates(10);
 			if (dest == regIX || dest == regIY) {
 				codeline.AddCode(optools.GetPrefix(dest));
 				dest = regHL;
-				codeline.SetStates(14);
 			}
 			codeline.AddCode(0xC1 + optools.GetSubCode(dest));
 			return true;
@@ -1819,16 +1871,14 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionPUSH::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionPUSH::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest;
 		OperandError operr = optools.GetReg16(codeline, dest,REGFLAGS::AF|REGFLAGS::BC|REGFLAGS::DE|REGFLAGS::HLXY);
 		if (operr == operrOK) {
-			codeline.SetStates(11);
 			if (dest == regIX || dest == regIY) {
 				codeline.AddCode(optools.GetPrefix(dest));
 				dest = regHL;
-				codeline.SetStates(15);
 			}
 			codeline.AddCode(0xC5 + optools.GetSubCode(dest));
 			return true;
@@ -1840,7 +1890,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRES::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionRES::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		int d=0;
 		OperandType src, bit, reg;
@@ -1852,14 +1902,12 @@ namespace Z80 {
 		if (!GetComma(codeline))return msg.Error(errorMissingComma, codeline);
 		operr = optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
-			codeline.SetStates(8);
+			// RES b,r
 		} else if (operrOK == optools.GetIndHL(codeline)) {
-			codeline.SetStates(15);
 			src = indHL;
 		} else if (operrOK == optools.GetIndX(codeline, src, d)) {
-			codeline.SetStates(23);
 			// 3 arguments? (undoc)
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// RES bit,(X+d),reg  (undoc)
 				operr = optools.GetReg8(codeline, reg, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
@@ -1885,17 +1933,15 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRET::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRET::Encode(CodeLine& codeline, ErrorList& )
 	{
 		OperandType cond;
 		OperandError operr = optools.GetCond(codeline, cond);
 		if (operr == operrOK) {
 			codeline.AddCode(0xC0 + optools.GetSubCode(cond));
-			codeline.SetStates(5,11);
 			return true;
 		}
 		codeline.AddCode(0xC9);
-		codeline.SetStates(10);
 		return true;
 	}
 
@@ -1903,10 +1949,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRETI::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRETI::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0x4D);
-		codeline.SetStates(14);
 		return true;
 	}
 
@@ -1914,10 +1959,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRETN::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRETN::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0x45);
-		codeline.SetStates(14);
 		return true;
 	}
 
@@ -1927,36 +1971,32 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRL::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionRL::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src,dest;
 		int d;
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x16);
-			codeline.SetStates(15);
 			return true;
 		}
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// RL (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x10 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x16);
-			codeline.SetStates(23);
 			return true;
 		}
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x10 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -1966,10 +2006,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRLA::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRLA::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x17);
-		codeline.SetStates(4);
 		return true;
 	}
 	/** Assemble instruction at current token, returns false if error
@@ -1978,36 +2017,32 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRLC::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionRLC::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src,dest;
 		int d;
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x06);
-			codeline.SetStates(15);
 			return true;
 		}
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// RLC (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x00 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x06);
-			codeline.SetStates(23);
 			return true;
 		}
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x00 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2017,10 +2052,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRLCA::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRLCA::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x07);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -2028,10 +2062,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRLD::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRLD::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0x6F);
-		codeline.SetStates(18);
 		return true;
 	}
 
@@ -2039,36 +2072,32 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRR::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionRR::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src,dest;
 		int d;
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x1E);
-			codeline.SetStates(15);
 			return true;
 		}
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// RR (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x18 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x1E);
-			codeline.SetStates(23);
 			return true;
 		}
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x18 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2078,10 +2107,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRRA::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRRA::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x1F);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -2089,35 +2117,31 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRRC::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionRRC::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src, dest;
 		int d;
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x0E);
-			codeline.SetStates(15);
 			return true;
 		}
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// RRC (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x08 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x0E);
-			codeline.SetStates(23);
 			return true;
 		}
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x08 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2127,10 +2151,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRRCA::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRRCA::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x0F);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -2138,10 +2161,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRRD::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionRRD::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0xED, 0x67);
-		codeline.SetStates(18);
 		return true;
 	}
 
@@ -2149,14 +2171,13 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionRST::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionRST::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		int addr;
 		OperandError operr = optools.GetNum8(codeline, addr);
 		if (operr == operrOK) {
 			if (addr <= 0x38 && addr % 8 == 0) {
 				codeline.AddCode(0xC7 + addr);
-				codeline.SetStates(11);
 				return true;
 			}
 		}
@@ -2171,7 +2192,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSBC::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionSBC::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType dest, src;
 		int d;
@@ -2183,42 +2204,38 @@ namespace Z80 {
 			if (!GetComma(codeline)) {
 				// SBC A
 				codeline.AddCode(0x98 + optools.GetSubCode(regA));
-				codeline.SetStates(4);
 				return true;
 			}
 			// SBC A,r
 			operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 			if (operr == operrOK) {
 				codeline.AddCode(0x98 + optools.GetSubCode(src));
-				codeline.SetStates(4);
 				return true;
 			}
 			// SBC A,undoc
-			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-			if (operr == operrOK) {
-				codeline.AddCode(optools.GetPrefix(src), 0x98 + optools.GetSubCode(src));
-				codeline.SetStates(8);
-				return true;
+			if (cpu.undocumented) {
+				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+				if (operr == operrOK) {
+					codeline.AddCode(optools.GetPrefix(src), 0x98 + optools.GetSubCode(src));
+					return true;
+				}
 			}
 			// SBC A,(HL)
 			operr = optools.GetIndHL(codeline);
 			if (operr == operrOK) {
 				codeline.AddCode(0x9E);
-				codeline.SetStates(7);
 				return true;
 			}
 			// SBC A,(X+d)
 			operr = optools.GetIndX(codeline, src, d);
 			if (operr == operrOK) {
 				codeline.AddCode(optools.GetPrefix(src), 0x9E, d);
-				codeline.SetStates(19);
 				return true;
 			}
 			// SBC A,n
 			operr = optools.GetNum8(codeline, d);
 			if (operr == operrOK) {
 				codeline.AddCode(0xDE, d);
-				codeline.SetStates(7);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);
@@ -2231,7 +2248,6 @@ namespace Z80 {
 			operr = optools.GetReg16(codeline, src,REGFLAGS::BCDESP | REGFLAGS::HL);
 			if (operr == operrOK) {
 				codeline.AddCode(0xED, 0x42 + optools.GetSubCode(src));
-				codeline.SetStates(15);
 				return true;
 			}
 			return msg.Error(errorWrongOperand2, codeline);
@@ -2242,35 +2258,32 @@ namespace Z80 {
 		operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0x98 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
 		// SBC undoc
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0x98 + optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0x98 + optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// SBC (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0x9E);
-			codeline.SetStates(7);
 			return true;
 		}
 		// SBC (X+d)
 		operr = optools.GetIndX(codeline, src, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(src), 0x9E, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// SBC n
 		operr = optools.GetNum8(codeline, d);
 		if (operr == operrOK) {
 			codeline.AddCode(0xDE, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2280,10 +2293,9 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSCF::Assemble(CodeLine& codeline, ErrorList& )
+	bool InstructionSCF::Encode(CodeLine& codeline, ErrorList& )
 	{
 		codeline.AddCode(0x37);
-		codeline.SetStates(4);
 		return true;
 	}
 
@@ -2294,7 +2306,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSET::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionSET::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		int d=0;
 		OperandType src, bit, reg;
@@ -2305,14 +2317,12 @@ namespace Z80 {
 		}
 		if (!GetComma(codeline))return msg.Error(errorMissingComma, codeline);
 		if (operrOK == optools.GetReg8(codeline, src,REGFLAGS::ABCDEHL)) {
-			codeline.SetStates(8);
+			// SET b,r
 		} else if (operrOK == optools.GetIndHL(codeline)) {
-			codeline.SetStates(15);
 			src = indHL;
 		} else if (operrOK == optools.GetIndX(codeline, src, d)) {
-			codeline.SetStates(23);
 			// 3 arguments? (undoc)
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// SET bit,(X+d),reg  (undoc)
 				operr = optools.GetReg8(codeline, reg, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
@@ -2340,7 +2350,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSLA::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionSLA::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src, dest;
 		int d;
@@ -2348,30 +2358,26 @@ namespace Z80 {
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x26);
-			codeline.SetStates(15);
 			return true;
 		}
 		// SLA (X+d)
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// SLA (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x20 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x26);
-			codeline.SetStates(23);
 			return true;
 		}
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x20 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2383,7 +2389,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSLL::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionSLL::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src, dest;
 		int d;
@@ -2391,30 +2397,26 @@ namespace Z80 {
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x36);
-			codeline.SetStates(15);
 			return true;
 		}
 		// SLL (X+d)
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// SLL (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x30 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x36);
-			codeline.SetStates(23);
 			return true;
 		}
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x30 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2425,36 +2427,32 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSRA::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionSRA::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src,dest;
 		int d;
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x2E);
-			codeline.SetStates(15);
 			return true;
 		}
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// SRA (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x28 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x2E);
-			codeline.SetStates(23);
 			return true;
 		}
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x28 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2466,7 +2464,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSRL::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionSRL::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src,dest;
 		int d;
@@ -2474,31 +2472,27 @@ namespace Z80 {
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x3E);
-			codeline.SetStates(15);
 			return true;
 		}
 		// SRL (X+d)
 		operr = optools.GetIndX(codeline, dest, d);
 		if (operr == operrOK) {
-			if (GetComma(codeline)) {
+			if (cpu.undocumented && GetComma(codeline)) {
 				// SRL (X+d),r (undoc)
 				operr = optools.GetReg8(codeline, src);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x38 + optools.GetSubCode(src));
-					codeline.SetStates(23);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
 			}
 			codeline.AddCode(optools.GetPrefix(dest), 0xCB, d, 0x3E);
-			codeline.SetStates(23);
 			return true;
 		}
 		// SRL r
 		operr = optools.GetReg8(codeline, dest,REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xCB, 0x38 + optools.GetSubCode(dest));
-			codeline.SetStates(8);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2508,7 +2502,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionSUB::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionSUB::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src;
 		int d;
@@ -2516,14 +2510,12 @@ namespace Z80 {
 		OperandError operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0x96);
-			codeline.SetStates(7);
 			return true;
 		}
 		// SUB (X+d)
 		operr = optools.GetIndX(codeline, src, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(src), 0x96, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// save current position
@@ -2536,28 +2528,26 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0x90 + optools.GetSubCode(src));
-					codeline.SetStates(4);
 					return true;
 				}
 				// SUB A,undoc
-				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(src), 0x90 + optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
+				if (cpu.undocumented) {
+					operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(src), 0x90 + optools.GetSubCode(src));
+						return true;
+					}
 				}
 				// SUB A,(HL)
 				operr = optools.GetIndHL(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0x96);
-					codeline.SetStates(7);
 					return true;
 				}
 				// SUB A, (X+d)
 				operr = optools.GetIndX(codeline, src, d);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(src), 0x96, d);
-					codeline.SetStates(19);
 					return true;
 				}
 				// SUB A, n
@@ -2565,7 +2555,6 @@ namespace Z80 {
 				if (operr == operrOK) {
 					if (GetComma(codeline)) return msg.Error(errorWrongComma, codeline);
 					codeline.AddCode(0xD6, d);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -2577,21 +2566,20 @@ namespace Z80 {
 		operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0x90 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
 		// SUB undoc
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0x90 + optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0x90 + optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// SUB n
 		operr = optools.GetNum8(codeline, d);
 		if (operr == operrOK)  {
 			codeline.AddCode(0xD6, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -2602,7 +2590,7 @@ namespace Z80 {
 	 @param codeline the code line in which assembled codes will be stored
 	 @param msg the message list which will receive any warning or error information
 	 */
-	bool InstructionXOR::Assemble(CodeLine& codeline, ErrorList& msg)
+	bool InstructionXOR::Encode(CodeLine& codeline, ErrorList& msg)
 	{
 		OperandType src;
 		int d;
@@ -2615,35 +2603,32 @@ namespace Z80 {
 				operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 				if (operr == operrOK) {
 					codeline.AddCode(0xA8 + optools.GetSubCode(src));
-					codeline.SetStates(4);
 					return true;
 				}
 				// XOR A,undoc
-				operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-				if (operr == operrOK) {
-					codeline.AddCode(optools.GetPrefix(src), 0xA8+ optools.GetSubCode(src));
-					codeline.SetStates(8);
-					return true;
+				if (cpu.undocumented) {
+					operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+					if (operr == operrOK) {
+						codeline.AddCode(optools.GetPrefix(src), 0xA8+ optools.GetSubCode(src));
+						return true;
+					}
 				}
 				// XOR A,(HL)
 				operr = optools.GetIndHL(codeline);
 				if (operr == operrOK) {
 					codeline.AddCode(0xAE);
-					codeline.SetStates(7);
 					return true;
 				}
 				// XOR A,(X+d)
 				operr = optools.GetIndX(codeline, src, d);
 				if (operr == operrOK) {
 					codeline.AddCode(optools.GetPrefix(src), 0xAE, d);
-					codeline.SetStates(19);
 					return true;
 				}
 				// XOR A,n
 				operr = optools.GetNum8(codeline, d);
 				if (operr == operrOK) {
 					codeline.AddCode(0xEE, d);
-					codeline.SetStates(7);
 					return true;
 				}
 				return msg.Error(errorWrongOperand2, codeline);
@@ -2655,35 +2640,32 @@ namespace Z80 {
 		operr = optools.GetReg8(codeline, src, REGFLAGS::ABCDEHL);
 		if (operr == operrOK) {
 			codeline.AddCode(0xA8 + optools.GetSubCode(src));
-			codeline.SetStates(4);
 			return true;
 		}
 		// XOR undoc
-		operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
-		if (operr == operrOK) {
-			codeline.AddCode(optools.GetPrefix(src), 0xA8+ optools.GetSubCode(src));
-			codeline.SetStates(8);
-			return true;
+		if (cpu.undocumented) {
+			operr = optools.GetReg8(codeline, src, REGFLAGS::UNDOC);
+			if (operr == operrOK) {
+				codeline.AddCode(optools.GetPrefix(src), 0xA8+ optools.GetSubCode(src));
+				return true;
+			}
 		}
 		// XOR (HL)
 		operr = optools.GetIndHL(codeline);
 		if (operr == operrOK) {
 			codeline.AddCode(0xAE);
-			codeline.SetStates(7);
 			return true;
 		}
 		// XOR (X+d)
 		operr = optools.GetIndX(codeline, src, d);
 		if (operr == operrOK) {
 			codeline.AddCode(optools.GetPrefix(src), 0xAE, d);
-			codeline.SetStates(19);
 			return true;
 		}
 		// XOR n
 		operr = optools.GetNum8(codeline, d);
 		if (operr == operrOK) {
 			codeline.AddCode(0xEE, d);
-			codeline.SetStates(7);
 			return true;
 		}
 		return msg.Error(errorWrongOperand1, codeline);
@@ -15,622 +15,821 @@
 namespace MUZ {
 namespace Z80 {
 
-	// global instance for operand tools
-	extern OperandTools & optools;
+	// instance for operand tools, one per thread
+	extern thread_local OperandTools & optools;
+
+	/** T-states for an opcode: minimum, and maximum for the conditional and repeating instructions. */
+	struct OpcodeStates {
+		BYTE min;
+		BYTE max;
+	};
+
+	/** Description of a processor running the Z-80 instruction set. The instruction classes encode for any of these
+		processors: the processor tells if the undocumented Z-80 forms are accepted, and gives the T-states of each
+		opcode so the timings are only written once in the processor tables. */
+	struct Processor {
+		/** True if the undocumented Z-80 forms are accepted. */
+		bool undocumented;
+		/** T-states for unprefixed opcodes. */
+		OpcodeStates main[256];
+		/** T-states for CB prefixed opcodes. */
+		OpcodeStates cb[256];
+		/** T-states for ED prefixed opcodes. */
+		OpcodeStates ed[256];
+		/** T-states for DD and FD prefixed opcodes. */
+		OpcodeStates xy[256];
+		/** T-states for DD CB and FD CB prefixed opcodes, indexed by the opcode following the displacement. */
+		OpcodeStates xycb[256];
+
+		/** Sets the T-states of a code line from the opcode assembled in it. */
+		void SetStates(CodeLine& codeline) const;
+	};
+
+	/** The Z-80 processor. */
+	extern const Processor cpuZ80;
+
+	/** Base class for the instructions of the Z-80 family. Derived classes encode the operands, then the T-states
+		are set from the opcode by the processor tables. */
+	class InstructionZ80 : public Instruction {
+	protected:
+		/** Processor for which the instruction is assembled. */
+		const Processor& cpu;
+
+		/** Encodes the instruction at current token, returns false if error.
+		 @param codeline the code line in which assembled codes will be stored
+		 @param msg the message list which will receive any warning or error information
+		 */
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg) = 0;
+
+		/** Encodes a JP or JR jump in the .RELAX mode: the jump is assembled as a JR while it reaches its target, and
+		 as a JP otherwise. Returns false if the .RELAX mode is off and the written form must be encoded.
+		 @param codeline the code line in which assembled codes will be stored
+		 @param shortcode the JR opcode for the jump condition
+		 @param longcode the JP opcode for the jump condition
+		 @param target the target address
+		 @param writtenshort true if the source has a JR, false for a JP
+		 */
+		bool EncodeRelaxed(CodeLine& codeline, BYTE shortcode, BYTE longcode, int target, bool writtenshort);
+
+	public:
+		InstructionZ80(const Processor& processor) : cpu(processor) {}
+
+		/** Assemble instruction at current token, returns false if error
+		 @param codeline the code line in which assembled codes will be stored
+		 @param msg the message list which will receive any warning or error information
+		 */
+		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+	};
 
 	/** Instruction names will lead to singleton instances of theese derived classes. */
 
 	/** Instruction LD. */
-	class InstructionLD : public Instruction {
+	class InstructionLD : public InstructionZ80 {
 	public:
-		/** Assemble LD instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode LD instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionPUSH : public Instruction {
+	class InstructionPUSH : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionPOP : public Instruction {
+	class InstructionPOP : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionEXX : public Instruction {
+	class InstructionEXX : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionEX : public Instruction {
+	class InstructionEX : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionLDI : public Instruction {
+	class InstructionLDI : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionLDIR : public Instruction {
+	class InstructionLDIR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionLDD : public Instruction {
+	class InstructionLDD : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionLDDR : public Instruction {
+	class InstructionLDDR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCPI : public Instruction {
+	class InstructionCPI : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCPIR : public Instruction {
+	class InstructionCPIR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCPD : public Instruction {
+	class InstructionCPD : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCPDR : public Instruction {
+	class InstructionCPDR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionADD : public Instruction {
+	class InstructionADD : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionADC : public Instruction {
+	class InstructionADC : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSUB : public Instruction {
+	class InstructionSUB : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSBC : public Instruction {
+	class InstructionSBC : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionAND : public Instruction {
+	class InstructionAND : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionOR : public Instruction {
+	class InstructionOR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionXOR : public Instruction {
+	class InstructionXOR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCP : public Instruction {
+	class InstructionCP : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionINC : public Instruction {
+	class InstructionINC : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionDEC : public Instruction {
+	class InstructionDEC : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionDAA : public Instruction {
+	class InstructionDAA : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCPL : public Instruction {
+	class InstructionCPL : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionNEG : public Instruction {
+	class InstructionNEG : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCCF : public Instruction {
+	class InstructionCCF : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSCF : public Instruction {
+	class InstructionSCF : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionNOP : public Instruction {
+	class InstructionNOP : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionHALT : public Instruction {
+	class InstructionHALT : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionDI : public Instruction {
+	class InstructionDI : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionEI : public Instruction {
+	class InstructionEI : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionIM : public Instruction {
+	class InstructionIM : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRLCA : public Instruction {
+	class InstructionRLCA : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRLA : public Instruction {
+	class InstructionRLA : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRRCA : public Instruction {
+	class InstructionRRCA : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRRA : public Instruction {
+	class InstructionRRA : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRLC : public Instruction {
+	class InstructionRLC : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRL : public Instruction {
+	class InstructionRL : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRRC : public Instruction {
+	class InstructionRRC : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRR : public Instruction {
+	class InstructionRR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSLA : public Instruction {
+	class InstructionSLA : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSLL : public Instruction {
+	class InstructionSLL : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSRA : public Instruction {
+	class InstructionSRA : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSRL : public Instruction {
+	class InstructionSRL : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRLD : public Instruction {
+	class InstructionRLD : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRRD : public Instruction {
+	class InstructionRRD : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionBIT : public Instruction {
+	class InstructionBIT : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionSET : public Instruction {
+	class InstructionSET : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRES : public Instruction {
+	class InstructionRES : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionJP : public Instruction {
+	class InstructionJP : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionJR : public Instruction {
+	class InstructionJR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionDJNZ : public Instruction {
+	class InstructionDJNZ : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionCALL : public Instruction {
+	class InstructionCALL : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRET : public Instruction {
+	class InstructionRET : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRETI : public Instruction {
+	class InstructionRETI : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRETN : public Instruction {
+	class InstructionRETN : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionRST : public Instruction {
+	class InstructionRST : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionIN : public Instruction {
+	class InstructionIN : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionINI : public Instruction {
+	class InstructionINI : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionINIR : public Instruction {
+	class InstructionINIR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionIND : public Instruction {
+	class InstructionIND : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionINDR : public Instruction {
+	class InstructionINDR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionOUT : public Instruction {
+	class InstructionOUT : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionOUTI : public Instruction {
+	class InstructionOUTI : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionOTIR : public Instruction {
+	class InstructionOTIR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionOUTD : public Instruction {
+	class InstructionOUTD : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
-	class InstructionOTDR : public Instruction {
+	class InstructionOTDR : public InstructionZ80 {
 	public:
-		/** Assemble instruction at current token, returns false if error
+		using InstructionZ80::InstructionZ80;
+	protected:
+		/** Encode instruction at current token, returns false if error
 		 @param codeline the code line in which assembled codes will be stored
 		 @param msg the message list which will receive any warning or error information
 		 */
-		virtual bool Assemble(CodeLine& codeline, ErrorList& msg);
+		virtual bool Encode(CodeLine& codeline, ErrorList& msg);
 	};
 
 
@@ -8,6 +8,7 @@
 #include "pch.h"
 #include "Z80-Operands.h"
 #include "MUZ-Assembler/ParseToken.h"
+#include "MUZ-Assembler/Keywords.h"
 #include "MUZ-Assembler/Expression.h"
 #include "MUZ-Assembler/CodeLine.h"
 #include "MUZ-Assembler/Assembler.h"
@@ -16,124 +17,122 @@
 namespace MUZ {
 namespace Z80 {
 
-	// prorotype to avoid warnings
-	void InitRegisterMap();
+	//MARK: - Tables for register names and sub codes
 
-	//MARK: - Maps for register names and sub codes
-
-	//NB: the & = *new declarations avoid exit-time destructors warnings
-
-	/** list of acceptable 8-bit registers */
-	std::unordered_map<std::string, OperandType>& registers8 = *new std::unordered_map<std::string, OperandType>;
-	/** list of acceptable 16-bit registers */
-	std::unordered_map<std::string, OperandType>& registers16 = *new std::unordered_map<std::string, OperandType>;
-	/** list of acceptable conditions */
-	std::unordered_map<std::string, OperandType>& conditions = *new std::unordered_map<std::string, OperandType>;
-
-	// Maps of sub-encoding for addressing
-	std::map<OperandType, int> & regsubcode = *new std::map<OperandType, int>;
-	std::map<OperandType, int> & regprefix = *new std::map<OperandType, int>;
-
-
-	// Initialize registers map
-	void InitRegisterMap() {
-
-		// offsets for registers in some encodings
-		regsubcode[regB] = 0;
-		regsubcode[regC] = 1;
-		regsubcode[regD] = 2;
-		regsubcode[regE] = 3;
-		regsubcode[regH] = 4;
-		regsubcode[regL] = 5;
-		regsubcode[regF] = 6;
-		regsubcode[indHL] = 6;
-		regsubcode[regA] = 7;
-		//undocumented
-		regsubcode[regIXH] = 4;
-		regsubcode[regIXL] = 5;
-		regsubcode[regIYH] = 4;
-		regsubcode[regIYL] = 5;
-		regprefix[regIXH] = 0xDD;
-		regprefix[regIYH] = 0xFD;
-		regprefix[regIXL] = 0xDD;
-		regprefix[regIYL] = 0xFD;
-
-		regsubcode[regI] = 0x07;
-		regsubcode[regR] = 0x0F;
-
-		regsubcode[regBC] = 0x00;
-		regsubcode[regDE] = 0x10;
-		regsubcode[regHL] = 0x20;
-		regsubcode[regSP] = 0x30;
-		regsubcode[regAF] = 0x30; // push,pop
-
-		regsubcode[regIX] = 0x20;//hl
-		regsubcode[regIY] = 0x20;//hl
-
-		regprefix[regIX] = 0xDD;
-		regprefix[regIY] = 0xFD;
-
-		regsubcode[bit0] = 0x00;
-		regsubcode[bit1] = 0x08;
-		regsubcode[bit2] = 0x10;
-		regsubcode[bit3] = 0x18;
-		regsubcode[bit4] = 0x20;
-		regsubcode[bit5] = 0x28;
-		regsubcode[bit6] = 0x30;
-		regsubcode[bit7] = 0x38;
-
-		regsubcode[condNZ] = 0x00;
-		regsubcode[condZ]  = 0x08;
-		regsubcode[condNC] = 0x10;
-		regsubcode[condC]  = 0x18;
-		regsubcode[condPO] = 0x20;
-		regsubcode[condPE] = 0x28;
-		regsubcode[condP]  = 0x30;
-		regsubcode[condM]  = 0x38;
+	/** Operand types for the keywords naming a register or a condition, -1 for other keywords. The parser has already
+		identified the keyword of each letters token, so classifying an operand is a table lookup. */
+	struct KeywordOperands {
+		signed char reg8[Keywords::COUNT];
+		signed char reg16[Keywords::COUNT];
+		signed char condition[Keywords::COUNT];
+	};
 
+	constexpr KeywordOperands BuildKeywordOperands() {
+		KeywordOperands table = {};
+		for (int i = 0 ; i < Keywords::COUNT ; i++) {
+			table.reg8[i] = table.reg16[i] = table.condition[i] = -1;
+		}
 		// authorized registers
-		registers8["A"] = regA;
-		registers8["B"] = regB;
-		registers8["C"] = regC;
-		registers8["D"] = regD;
-		registers8["E"] = regE;
-		registers8["H"] = regH;
-		registers8["L"] = regL;
-		registers8["I"] = regI;
-		registers8["R"] = regR;
-		registers8["F"] = regF;
+		table.reg8[Keywords::Index("A")] = regA;
+		table.reg8[Keywords::Index("B")] = regB;
+		table.reg8[Keywords::Index("C")] = regC;
+		table.reg8[Keywords::Index("D")] = regD;
+		table.reg8[Keywords::Index("E")] = regE;
+		table.reg8[Keywords::Index("H")] = regH;
+		table.reg8[Keywords::Index("L")] = regL;
+		table.reg8[Keywords::Index("I")] = regI;
+		table.reg8[Keywords::Index("R")] = regR;
+		table.reg8[Keywords::Index("F")] = regF;
 		// undocumented
-		registers8["IXH"] = regIXH;
-		registers8["IXL"] = regIXL;
-		registers8["IYH"] = regIYH;
-		registers8["IYL"] = regIYL;
-
-		registers16["AF"] = regAF;
-		registers16["AF'"] = regAFp;
-		registers16["BC"] = regBC;
-		registers16["DE"] = regDE;
-		registers16["HL"] = regHL;
-		registers16["SP"] = regSP;
-		registers16["IX"] = regIX;
-		registers16["IY"] = regIY;
-
-		conditions["NC"] = condNC;
-		conditions["C"] = condC;
-		conditions["NZ"] = condNZ;
-		conditions["Z"] = condZ;
-		conditions["PE"] = condPE;
-		conditions["PO"] = condPO;
-		conditions["P"] = condP;
-		conditions["M"] = condM;
-
-	}
-
-	// singleton to launch register maps init at run-time
-	struct _auto_init_register_map {
-		_auto_init_register_map() {
-			InitRegisterMap();
-		}
-	} _runtime_auto_init_register_map;
+		table.reg8[Keywords::Index("IXH")] = regIXH;
+		table.reg8[Keywords::Index("IXL")] = regIXL;
+		table.reg8[Keywords::Index("IYH")] = regIYH;
+		table.reg8[Keywords::Index("IYL")] = regIYL;
+
+		table.reg16[Keywords::Index("AF")] = regAF;
+		table.reg16[Keywords::Index("AF'")] = regAFp;
+		table.reg16[Keywords::Index("BC")] = regBC;
+		table.reg16[Keywords::Index("DE")] = regDE;
+		table.reg16[Keywords::Index("HL")] = regHL;
+		table.reg16[Keywords::Index("SP")] = regSP;
+		table.reg16[Keywords::Index("IX")] = regIX;
+		table.reg16[Keywords::Index("IY")] = regIY;
+
+		table.condition[Keywords::Index("NC")] = condNC;
+		table.condition[Keywords::Index("C")] = condC;
+		table.condition[Keywords::Index("NZ")] = condNZ;
+		table.condition[Keywords::Index("Z")] = condZ;
+		table.condition[Keywords::Index("PE")] = condPE;
+		table.condition[Keywords::Index("PO")] = condPO;
+		table.condition[Keywords::Index("P")] = condP;
+		table.condition[Keywords::Index("M")] = condM;
+		return table;
+	}
+	constexpr KeywordOperands keywordoperands = BuildKeywordOperands();
+
+	/** Sub-encoding and prefix for each operand type, 0 when the operand type has none. */
+	struct OperandCodes {
+		int subcode[ind16 + 1];
+		int prefix[ind16 + 1];
+	};
+
+	constexpr OperandCodes BuildOperandCodes() {
+		OperandCodes table = {};
+		// offsets for registers in some encodings
+		table.subcode[regB] = 0;
+		table.subcode[regC] = 1;
+		table.subcode[regD] = 2;
+		table.subcode[regE] = 3;
+		table.subcode[regH] = 4;
+		table.subcode[regL] = 5;
+		table.subcode[regF] = 6;
+		table.subcode[indHL] = 6;
+		table.subcode[regA] = 7;
+		//undocumented
+		table.subcode[regIXH] = 4;
+		table.subcode[regIXL] = 5;
+		table.subcode[regIYH] = 4;
+		table.subcode[regIYL] = 5;
+		table.prefix[regIXH] = 0xDD;
+		table.prefix[regIYH] = 0xFD;
+		table.prefix[regIXL] = 0xDD;
+		table.prefix[regIYL] = 0xFD;
+
+		table.subcode[regI] = 0x07;
+		table.subcode[regR] = 0x0F;
+
+		table.subcode[regBC] = 0x00;
+		table.subcode[regDE] = 0x10;
+		table.subcode[regHL] = 0x20;
+		table.subcode[regSP] = 0x30;
+		table.subcode[regAF] = 0x30; // push,pop
+
+		table.subcode[regIX] = 0x20;//hl
+		table.subcode[regIY] = 0x20;//hl
+
+		table.prefix[regIX] = 0xDD;
+		table.prefix[regIY] = 0xFD;
+
+		table.subcode[bit0] = 0x00;
+		table.subcode[bit1] = 0x08;
+		table.subcode[bit2] = 0x10;
+		table.subcode[bit3] = 0x18;
+		table.subcode[bit4] = 0x20;
+		table.subcode[bit5] = 0x28;
+		table.subcode[bit6] = 0x30;
+		table.subcode[bit7] = 0x38;
+
+		table.subcode[condNZ] = 0x00;
+		table.subcode[condZ]  = 0x08;
+		table.subcode[condNC] = 0x10;
+		table.subcode[condC]  = 0x18;
+		table.subcode[condPO] = 0x20;
+		table.subcode[condPE] = 0x28;
+		table.subcode[condP]  = 0x30;
+		table.subcode[condM]  = 0x38;
+		return table;
+	}
+	constexpr OperandCodes operandcodes = BuildOperandCodes();
 
 	//MARK: - Low level tokens analysis for operand types
 
@@ -142,10 +141,10 @@ namespace Z80 {
 	{
 		size_t ucurtoken = (size_t)curtoken;
 		ParseToken& token =tokens->at(ucurtoken);
-		if (token.type != tokenTypeLETTERS) return false;
-		std::string source = std::to_upper(token.source);
-		if (registers8.count(source)) {
-			reg8 = registers8[source];
+		if (token.type != tokenTypeLETTERS || token.keyword < 0) return false;
+		int reg = keywordoperands.reg8[token.keyword];
+		if (reg >= 0) {
+			reg8 = (OperandType)reg;
 			curtoken += 1;
 			return true;
 		}
@@ -157,10 +156,10 @@ namespace Z80 {
 	{
 		size_t ucurtoken = (size_t)curtoken;
 		ParseToken& token =tokens->at(ucurtoken);
-		if (token.type != tokenTypeLETTERS) return false;
-		std::string source = std::to_upper(token.source);
-		if (registers16.count(source)) {
-			reg16 = registers16[source];
+		if (token.type != tokenTypeLETTERS || token.keyword < 0) return false;
+		int reg = keywordoperands.reg16[token.keyword];
+		if (reg >= 0) {
+			reg16 = (OperandType)reg;
 			curtoken += 1;
 			return true;
 		}
@@ -263,7 +262,7 @@ namespace Z80 {
 			operrUNSOLVED			Unsolved symbol in 'd' expression, value is 0
 			operrOK					value is 'd' expression result
 	 */
-	OperandError OperandTools::indirectX( ExpVector* tokens, int& curtoken, OperandType& regX, int& value )
+	OperandError OperandTools::indirectX( ExpVector* tokens, int& curtoken, OperandType& regX, int& value, ExpressionCache* expressions )
 	{
 		size_t ucurtoken = (size_t)curtoken;
 		if (ucurtoken + 4 >= tokens->size() ) return operrTOKENNUMBER;
@@ -288,7 +287,7 @@ namespace Z80 {
 		}
 		// evaluate the value after "+" and before closing parenthesis
 		indextoken = indextoken - 1;
-		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken + 3, indextoken);
+		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken + 3, indextoken, expressions);
 		// skip closing parenthesis
 		curtoken = indextoken + 1;
 		if (evaluated.unsolved) {
@@ -307,10 +306,10 @@ namespace Z80 {
 		Doesn't update current token if returning:
 			operrNOTBIT				Number is too big for a bit number, or not a number
 	 */
-	OperandError OperandTools::bitnumber( ExpVector* tokens, int& curtoken, OperandType& bit )
+	OperandError OperandTools::bitnumber( ExpVector* tokens, int& curtoken, OperandType& bit, ExpressionCache* expressions )
 	{
 		int lasttoken = -1;
-		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken, lasttoken);
+		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken, lasttoken, expressions);
 		if (evaluated.unsolved) {
 			bit = bit0;
 			curtoken = lasttoken ;
@@ -338,8 +337,9 @@ namespace Z80 {
 	{
 		ParseToken& token =tokens->at((size_t)curtoken);
 		if (token.type != tokenTypeLETTERS) return operrNOTSTRING;
-		if (conditions.count(token.source)) {
-			cond = conditions[token.source];
+		// condition names are only accepted in upper case
+		if (token.keyword >= 0 && keywordoperands.condition[token.keyword] >= 0 && token.source == Keywords::names[token.keyword]) {
+			cond = (OperandType)keywordoperands.condition[token.keyword];
 			curtoken += 1;
 			return operrOK;
 		}
@@ -354,10 +354,10 @@ namespace Z80 {
 		 operrTOOBIG			Number is too big for a 8-bit number
 		 operrNOTNUMBER			Not a number
 	 */
-	OperandError OperandTools::number8( ExpVector* tokens, int& curtoken, int& value )
+	OperandError OperandTools::number8( ExpVector* tokens, int& curtoken, int& value, ExpressionCache* expressions )
 	{
 		int lasttoken = -1;
-		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken, lasttoken);
+		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken, lasttoken, expressions);
 		if (evaluated.unsolved) {
 			value = 0;
 			curtoken = lasttoken + 1;
@@ -373,10 +373,10 @@ namespace Z80 {
 	}
 
 	/** Parses current token and return the value for a 16-bit number. */
-	OperandError OperandTools::number16( ExpVector* tokens, int& curtoken, int& value )
+	OperandError OperandTools::number16( ExpVector* tokens, int& curtoken, int& value, ExpressionCache* expressions )
 	{
 		int lasttoken = -1;
-		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken, lasttoken);
+		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken, lasttoken, expressions);
 		if (evaluated.unsolved) {
 			value = 0;
 			curtoken = lasttoken + 1;
@@ -394,7 +394,7 @@ namespace Z80 {
 	/** Compute a 16-bit value from a numeric expression between parenthesis. If parenthesis or a value cannot be found,
 	 returns an error code. The last used token index is returned even if the expression doesn't compute a number but
 	 have correct parenthesis. */
-	OperandError OperandTools::indirect16( ExpVector* tokens, int curtoken, int& value, int& lasttoken )
+	OperandError OperandTools::indirect16( ExpVector* tokens, int curtoken, int& value, int& lasttoken, ExpressionCache* expressions )
 	{
 		size_t ucurtoken = (size_t)curtoken;
 		if (ucurtoken + 2 >= tokens->size() ) return operrTOKENNUMBER;
@@ -416,7 +416,7 @@ namespace Z80 {
 		if (token->type != tokenTypePARCLOSE) return operrMISSINGPARCLOSE;
 		// evaluate the tokens between parenthesis
 		lasttoken = lasttoken - 1; // back from parenthesis close
-		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken + 1, lasttoken );
+		ParseToken evaluated = evalNumber.Evaluate(*tokens, curtoken + 1, lasttoken, expressions );
 		lasttoken = lasttoken + 1;// skips  closing parenthesis
 		if (evaluated.unsolved) {
 			value = 0;
@@ -454,18 +454,14 @@ namespace Z80 {
 	 */
 	int OperandTools::GetSubCode( OperandType reg )
 	{
-		if (regsubcode.count(reg))
-			return regsubcode[reg];
-		return 0;
+		return (reg >= 0 && reg <= ind16) ? operandcodes.subcode[reg] : 0;
 	}
 	/** Returns the prefix for a register code. Used for instructions accepting IX, IY and undocumented forms.
 	 Returns a 0 for any invalid register or addressing code.
 	 */
 	int OperandTools::GetPrefix( OperandType reg )
 	{
-		if (regprefix.count(reg))
-			return regprefix[reg];
-		return 0;
+		return (reg >= 0 && reg <= ind16) ? operandcodes.prefix[reg] : 0;
 	}
 
 	/** Returns true if current token is recognized as an 8-bit register, and go next token. */
@@ -554,7 +550,7 @@ namespace Z80 {
 	OperandError OperandTools::GetIndX(CodeLine& codeline, OperandType& regX, int& value ) {
 		if (!EnoughTokensLeft(codeline,5)) return operrTOKENNUMBER;
 		int worktoken = (int)codeline.curtoken;
-		OperandError operr = indirectX(&codeline.tokens, worktoken, regX, value);
+		OperandError operr = indirectX(&codeline.tokens, worktoken, regX, value, &codeline.expressions);
 		if (operr == operrOK) {
 			codeline.curtoken = (size_t)worktoken;
 			return operrOK;
@@ -575,7 +571,7 @@ namespace Z80 {
 		if (reg8(&codeline.tokens, worktoken, bit)) return operrWRONGREGISTER;
 		if (reg16(&codeline.tokens, worktoken, bit)) return operrWRONGREGISTER;
 		worktoken = (int)codeline.curtoken;
-		OperandError operr = bitnumber(&codeline.tokens, worktoken, bit);
+		OperandError operr = bitnumber(&codeline.tokens, worktoken, bit, &codeline.expressions);
 		if (operr == operrOK) {
 			codeline.curtoken = (size_t)worktoken;
 			return operrOK;
@@ -615,7 +611,7 @@ namespace Z80 {
 		if (reg16(&codeline.tokens, worktoken, num8)) return operrWRONGREGISTER;
 		// now only numbers or labels
 		worktoken = (int)codeline.curtoken;
-		OperandError operr = number8(&codeline.tokens, worktoken, value);
+		OperandError operr = number8(&codeline.tokens, worktoken, value, &codeline.expressions);
 		if (operr == operrOK) {
 			codeline.curtoken = (size_t)worktoken;
 			return operrOK;
@@ -641,7 +637,7 @@ namespace Z80 {
 		if (reg8(&codeline.tokens, worktoken, num16)) return operrWRONGREGISTER;
 		if (reg16(&codeline.tokens, worktoken, num16)) return operrWRONGREGISTER;
 		worktoken = (int)codeline.curtoken;
-		OperandError operr = number16(&codeline.tokens, worktoken, value);
+		OperandError operr = number16(&codeline.tokens, worktoken, value, &codeline.expressions);
 		if (operr == operrOK) {
 			codeline.curtoken = (size_t)worktoken;
 			return operrOK;
@@ -664,7 +660,7 @@ namespace Z80 {
 		if (!EnoughTokensLeft(codeline,3)) return operrTOKENNUMBER;
 		int lasttoken;
 		int worktoken = (int)codeline.curtoken;
-		OperandError operr = indirect16(&codeline.tokens, worktoken, value, lasttoken);
+		OperandError operr = indirect16(&codeline.tokens, worktoken, value, lasttoken, &codeline.expressions);
 		if (operr==operrOK) {
 			codeline.curtoken = (size_t)lasttoken;
 			return operrOK;
@@ -127,7 +127,8 @@ namespace Z80 {
 	/** Low level interpreting functions for each family of operand type. Each function parses the current token and returns
 		an operand type, and a value when appropriate.
 		The indirect family handle the parenthesis tokens and the "+d" part where appropriate.
-		The functions handling numbers handle exxpressions until next separator. */
+		The functions handling numbers handle exxpressions until next separator, and keep the compiled expressions
+		in the code line cache they receive. */
 	class OperandTools {
 
 		// Specialized Expression evaluators for restricted types
@@ -154,19 +155,19 @@ namespace Z80 {
 		/** Parses current token and return the code for an indirect access via (SP): indSP. */
 		bool indirectSP( ExpVector* tokens, int& curtoken, OperandType& regSP );
 		/** Parses current token and return the code for an indirect access via (IX+d) and (IY+d): indIX, indIY. May issue a warning or error for invalid value or missing closing parenthesis. */
-		OperandError indirectX( ExpVector* tokens, int& curtoken, OperandType& regX, int& value );
+		OperandError indirectX( ExpVector* tokens, int& curtoken, OperandType& regX, int& value, ExpressionCache* expressions );
 		/** Parses current token and return the code for a bit nunmber: bit0 to bit7. May issue an error if out of range. */
-		OperandError bitnumber( ExpVector* tokens, int& curtoken, OperandType& bit );
+		OperandError bitnumber( ExpVector* tokens, int& curtoken, OperandType& bit, ExpressionCache* expressions );
 		/** Parses current token and return the code for a condition name: condNZ to condM. */
 		OperandError condition( ExpVector* tokens, int& curtoken, OperandType& cond );
 		/** Parses current token and return the value for an 8-bit number. Issue a warning if out of range. */
-		OperandError number8( ExpVector* tokens, int& curtoken, int& value );
+		OperandError number8( ExpVector* tokens, int& curtoken, int& value, ExpressionCache* expressions );
 		/** Parses current token and return the value for a 16-bit number. Issue a warning if out of range. */
-		OperandError number16( ExpVector* tokens, int& curtoken, int& value );
+		OperandError number16( ExpVector* tokens, int& curtoken, int& value, ExpressionCache* expressions );
 		/** Computes a 16-bit value from a numeric expression between parenthesis. If parenthesis or a value cannot be found,
 		 returns an error code. The last used token index is returned even if the expression doesn't compute a number but
 		 have correct parenthesis. */
-		OperandError indirect16( ExpVector* tokens, int curtoken, int& value, int& lasttoken);
+		OperandError indirect16( ExpVector* tokens, int curtoken, int& value, int& lasttoken, ExpressionCache* expressions );
 
 
 		/** High level functions for analyzing a CodeLine operands. These functions accepts a combination of flags which tells which registers are accepted. The flags aare in the same order as the register codes in the OperandType enum. A check is done in DEBUG build to ensure
@@ -28,4 +28,11 @@ bool ExistDir(std::string dir)
 	}
 	return false;
 }
-
+long long FileTime(std::string file)
+{
+	struct stat st;
+	if (stat(file.c_str(), &st) != 0) {
+		return 0;
+	}
+	return (long long)st.st_mtime;
+}
@@ -13,5 +13,6 @@
 
 bool ExistFile(std::string file);
 bool ExistDir(std::string dir);
+long long FileTime(std::string file);
 
 #endif /* FileUtils_h */
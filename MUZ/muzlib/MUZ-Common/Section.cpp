@@ -110,6 +110,30 @@ namespace MUZ {
 		m_currange = m_ranges.size() - 1;
 	}
 	
+	/** Enters all the addresses from start to end. The first address goes through SetAddress(), then the current
+	 range is simply extended when no other range is met by the following addresses. */
+	void Section::SetRange(DWORD start, DWORD end) {
+		
+		SetAddress(start);
+		if (end <= start) return;
+		
+		// check if any other range is touched by the rest of addresses
+		AddressRange& range = m_ranges[m_currange];
+		for (size_t i = 0 ; i < m_ranges.size() ; i++) {
+			if (i == m_currange) continue;
+			if ((m_ranges[i].end < range.start) || (m_ranges[i].start > end + 1)) continue;
+			// merges ranges: do it address by address
+			for (DWORD address = start + 1 ; address <= end ; address++) {
+				SetAddress(address);
+			}
+			return;
+		}
+		
+		// expand the current range
+		if (range.end < end) range.end = end;
+		m_curaddress = end;
+	}
+	
 	/** Returns the lowest starting address of all ranges. */
 	DWORD Section::absoluteStart() {
 		if (m_ranges.size()==0) return 0;
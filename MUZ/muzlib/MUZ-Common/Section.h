@@ -45,6 +45,9 @@ namespace MUZ {
 		/** Enters an address into an existing or new address range. Merges two existing ranges when address links them. */
 		void SetAddress(DWORD address);
 		
+		/** Enters all the addresses from start to end, same as calling SetAddress() for each address in order. */
+		void SetRange(DWORD start, DWORD end);
+		
 		/** Returns the lowest starting address of all ranges. */
 		DWORD absoluteStart();
 		
@@ -0,0 +1,112 @@
+//
+//  SourceText.cpp
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+#include "pch.h"
+#include "SourceText.h"
+#include <stdlib.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace MUZ {
+
+	SourceText::~SourceText()
+	{
+		Close();
+	}
+
+	void SourceText::Close()
+	{
+		if (data) {
+#ifndef WIN32
+			if (mapped) munmap((void*)data, size);
+			else
+#endif
+			free((void*)data);
+		}
+		data = nullptr;
+		size = 0;
+		mapped = false;
+		starts.clear();
+		lengths.clear();
+	}
+
+	bool SourceText::Open(const std::string& file)
+	{
+		Close();
+#ifndef WIN32
+		// map the file
+		int fd = open(file.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (map != MAP_FAILED) {
+				data = (const char*)map;
+				size = (size_t)st.st_size;
+				mapped = true;
+			}
+		}
+		close(fd);
+#endif
+		if (!mapped) {
+			// read the file in one block
+			FILE* f = fopen(file.c_str(), "rb");
+			if (!f) return false;
+			char* buffer = nullptr;
+			char block[4096];
+			size_t read;
+			while ((read = fread(block, 1, sizeof(block), f)) > 0) {
+				char* grown = (char*)realloc(buffer, size + read);
+				if (grown == nullptr) {
+					free(buffer);
+					fclose(f);
+					return false;
+				}
+				buffer = grown;
+				memcpy(buffer + size, block, read);
+				size += read;
+			}
+			fclose(f);
+			data = buffer;
+		}
+		Index();
+		return true;
+	}
+
+	/** Splits the content the same way as successive fgetline() calls: the text after the last end of line is a line,
+	 even if empty, except after a single CR ending the file. */
+	void SourceText::Index()
+	{
+		size_t pos = 0;
+		while (true) {
+			size_t start = pos;
+			while (pos < size && data[pos] != 0 && data[pos] != '\n' && data[pos] != '\r') pos++;
+			starts.push_back(start);
+			lengths.push_back(pos - start);
+			if (pos >= size) break;
+			if (data[pos] == '\r') {
+				if (pos + 1 >= size) break;
+				if (data[pos + 1] == '\n') pos += 1;
+			}
+			pos += 1;
+		}
+	}
+
+	uint64_t SourceText::Hash() const
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t pos = 0 ; pos < size ; pos++) {
+			hash ^= (unsigned char)data[pos];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+} // namespace MUZ
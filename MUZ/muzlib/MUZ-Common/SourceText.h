@@ -0,0 +1,75 @@
+//
+//  SourceText.h
+//  MUZ-Workshop
+//
+//  Created by agent on 16/10/2026.
+//
+
+#ifndef SourceText_h
+#define SourceText_h
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace MUZ {
+
+	/** Read-only content of a source file, split into lines once when opened.
+	 The file is memory-mapped when the system allows it, or else read in one block. Lines are then read in place
+	 instead of being read from the file character by character. End of lines are the same as fgetline(): LF, CR,
+	 CR+LF or a null character. */
+	class SourceText
+	{
+		const char*			data = nullptr;		// file content
+		size_t				size = 0;			// file content size
+		bool				mapped = false;		// true if data is a file mapping, false if allocated
+		std::vector<size_t>	starts;				// offset of each line
+		std::vector<size_t>	lengths;			// length of each line, without end of line
+
+		/** Finds the lines in the content. */
+		void Index();
+
+	public:
+		SourceText() {}
+		~SourceText();
+		SourceText(const SourceText&) = delete;
+		SourceText& operator=(const SourceText&) = delete;
+
+		/** Opens a file and indexes its lines, returns false if the file cannot be read. */
+		bool Open(const std::string& file);
+
+		/** Releases the content. */
+		void Close();
+
+		/** Number of lines. */
+		size_t LineCount() const {
+			return starts.size();
+		}
+
+		/** Start of a line, not null terminated. */
+		const char* LineStart(size_t line) const {
+			return data + starts[line];
+		}
+
+		/** Length of a line without its end of line. */
+		size_t LineLength(size_t line) const {
+			return lengths[line];
+		}
+
+		/** Copy of a line. */
+		std::string Line(size_t line) const {
+			return std::string(LineStart(line), LineLength(line));
+		}
+
+		/** Size of the content in bytes. */
+		size_t Size() const {
+			return size;
+		}
+
+		/** FNV-1a hash of the content, identifies a file content for caches. */
+		uint64_t Hash() const;
+	};
+
+} // namespace MUZ
+
+#endif /* SourceText_h */